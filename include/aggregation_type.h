@@ -1,6 +1,8 @@
 #ifndef AGGREGATION_TYPE_H
 #define AGGREGATION_TYPE_H
 
+#include "hash_table.h"
+
 template <class ResultT>
 using aggregation_function_t = uint64_t (*) (
 	const ResultT*,
@@ -8,15 +10,145 @@ using aggregation_function_t = uint64_t (*) (
 	const uint32_t
 );
 
+/** write-side counterpart of aggregation_function_t:
+ * writes into the array and returns a checksum (sum) of the written values.
+ */
+template <class ResultT>
+using scatter_function_t = uint64_t (*) (
+	ResultT*,
+	uint64_t,
+	const uint32_t
+);
+
+/** a benchmarked kernel. either function (reads, aggregates) or
+ * scatter (writes) is set, the other one stays nullptr.
+ * prefetching kernels read prefetch_distance (see gather/prefetch.cpp),
+ * they are measured with every distance of --prefetch-distances.
+ * kernels for any_count handle any number of values (and any start
+ * alignment), they get all values, split over the threads without
+ * leaving anything out (see partition_all_values).
+ * wide kernels return the sum in 64 bit instead of wrapping like ResultT,
+ * it is checked against aggregate_scalar_wide (only 32 bit ones have some).
+ */
 template <class ResultT>
 struct aggregator {
 	aggregation_function_t<ResultT> function;
 	string label;
 	bool strided;
+	scatter_function_t<ResultT> scatter = nullptr;
+	bool prefetching = false;
+	bool any_count = false;
+	bool wide = false;
 };
 template <class ResultT>
 using aggregator_t = struct aggregator<ResultT>;
 
+/** reads the values at number positions in the index array
+ * (IndexT: uint32_t or uint64_t) and returns their sum.
+ */
+template <class ResultT, class IndexT>
+using lookup_function_t = uint64_t (*) (
+	const ResultT*,
+	const IndexT*,
+	uint64_t
+);
+
+/** a benchmarked lookup kernel, for 32 (index32) or 64 bit (index64)
+ * offsets, the other one stays nullptr. prefetching as for aggregators.
+ */
+template <class ResultT>
+struct lookup_kernel {
+	string label;
+	lookup_function_t<ResultT, uint32_t> index32;
+	lookup_function_t<ResultT, uint64_t> index64 = nullptr;
+	bool prefetching = false;
+};
+
+/** adds the number values to buckets[keys[i]] (group-by sum, the keys are
+ * below bucket_count), histograms add 1 per key instead and ignore values.
+ * returns the sum of what was added (wrapping like ResultT).
+ */
+template <class ResultT>
+using groupby_function_t = uint64_t (*) (
+	const ResultT*,
+	const uint32_t*,
+	uint64_t,
+	ResultT*,
+	uint64_t
+);
+
+/** a benchmarked group-by (or histogram) kernel. multi threaded, shared
+ * kernels (atomic updates) all add into one table, the others each into
+ * their own one, merged afterwards.
+ */
+template <class ResultT>
+struct groupby_kernel {
+	string label;
+	groupby_function_t<ResultT> function;
+	bool histogram = false;
+	bool shared = false;
+};
+
+/** looks up the number keys in the hash table, returns the sum of the
+ * values of the keys found (wrapping like ResultT).
+ */
+template <class ResultT>
+using probe_function_t = uint64_t (*) (
+	const hash_table<ResultT>&,
+	const ResultT*,
+	uint64_t
+);
+
+/** a benchmarked hash table probe kernel, bucketised ones only read
+ * tables in the buckets layout.
+ */
+template <class ResultT>
+struct probe_kernel {
+	string label;
+	probe_function_t<ResultT> function;
+	bool bucketised = false;
+};
+
+/** follows the chains of a cycle through next (see build_chase_cycle)
+ * from the positions in starts for a number of hops, returns the sum of the
+ * positions they end at (wrapping like ResultT).
+ */
+template <class ResultT>
+using chase_function_t = uint64_t (*) (
+	const ResultT*,
+	const ResultT*,
+	uint64_t
+);
+
+/** a benchmarked pointer chasing kernel, following lanes chains at once */
+template <class ResultT>
+struct chase_kernel {
+	string label;
+	chase_function_t<ResultT> function;
+	uint64_t lanes;
+};
+
+/** the kernels (aggregators or lookup kernels) whose label is in labels
+ * (all of them if labels is empty), in their original order.
+ */
+template <class KernelT>
+vector<KernelT> select_kernels(
+	const vector<KernelT>& kernels,
+	const vector<string>& labels
+) {
+	if (labels.empty()) return kernels;
+	vector<KernelT> selected;
+	for (const KernelT& kernel : kernels) {
+		for (const string& label : labels) {
+			if (kernel.label == label) {
+				selected.push_back(kernel);
+				break;
+			}
+		}
+	}
+	return selected;
+}
+
 template <class ResultT>
 using benchmark_function = aggregation_function_t<ResultT>;
 
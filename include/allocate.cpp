@@ -2,22 +2,377 @@
 #define ALLOCATE_CPP
 
 #include <numa.h>
+#include <numaif.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <string>
+#include <vector>
 
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+/** where the pages of benchmark data are placed:
+ * bind: on the nodes in the node list (only, e.g. a flat mode HBM node),
+ * interleave: page by page round robin over the nodes in the node list,
+ * local: each worker's part on the node of the cpu the worker is pinned to.
+ */
+enum placement_policy {
+	PLACEMENT_BIND,
+	PLACEMENT_INTERLEAVE,
+	PLACEMENT_LOCAL,
+};
+
+/** the pages backing benchmark data:
+ * 4k: normal pages,
+ * thp: normal pages the kernel may merge into transparent 2 MiB huge pages
+ *   (madvise, needs no reserved pages, but nothing is guaranteed),
+ * 2m, 1g: explicit huge pages from the pool reserved in
+ *   /sys/kernel/mm/hugepages (or with hugepagesz=1G hugepages=N at boot).
+ * if pages of a size cannot be had, the next smaller one is tried.
+ */
+enum page_mode {
+	PAGES_4K,
+	PAGES_THP,
+	PAGES_2M,
+	PAGES_1G,
+};
+
+struct placement {
+	placement_policy policy = PLACEMENT_BIND;
+	std::vector< uint64_t > nodes = { 0 };
+	page_mode pages = PAGES_4K;
+};
+
+std::string placement_policy_name(placement_policy policy) {
+	switch (policy) {
+		case PLACEMENT_BIND:       return "bind";
+		case PLACEMENT_INTERLEAVE: return "interleave";
+		case PLACEMENT_LOCAL:      return "local";
+	}
+	return "unknown";
+}
+
+/** sets policy according to name ("bind", "interleave" or "local"),
+ * returns false (and leaves policy as it is) for an unknown name.
+ */
+bool parse_placement_policy(const std::string& name, placement_policy* policy) {
+	for (placement_policy candidate : { PLACEMENT_BIND, PLACEMENT_INTERLEAVE, PLACEMENT_LOCAL }) {
+		if (name == placement_policy_name(candidate)) {
+			*policy = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+std::string page_mode_name(page_mode pages) {
+	switch (pages) {
+		case PAGES_4K:  return "4k";
+		case PAGES_THP: return "thp";
+		case PAGES_2M:  return "2m";
+		case PAGES_1G:  return "1g";
+	}
+	return "unknown";
+}
+
+/** sets pages according to name ("4k", "thp", "2m" or "1g"),
+ * returns false (and leaves pages as it is) for an unknown name.
+ */
+bool parse_page_mode(const std::string& name, page_mode* pages) {
+	for (page_mode candidate : { PAGES_4K, PAGES_THP, PAGES_2M, PAGES_1G }) {
+		if (name == page_mode_name(candidate)) {
+			*pages = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+/** the size of the huge pages of pages, 0 for PAGES_4K */
+uint64_t huge_page_bytes(page_mode pages) {
+	switch (pages) {
+		case PAGES_THP:
+		case PAGES_2M:  return (uint64_t) 1 << 21;
+		case PAGES_1G:  return (uint64_t) 1 << 30;
+		default:        return 0;
+	}
+}
+
+/** a memory mapping made by allocate, remembered for deallocate (huge page
+ * mappings are larger than asked for) and to bind whole pages.
+ */
+struct mapping {
+	void* address;      // as returned by allocate
+	void* base;         // as returned by mmap
+	uint64_t bytes;     // mapped at base
+	page_mode requested;
+	page_mode pages;    // what was actually used
+};
+
+/** every mapping of allocate not yet freed by deallocate.
+ * only changed by the main thread, while no worker runs.
+ */
+std::vector< mapping >& mappings() {
+	static std::vector< mapping > all;
+	return all;
+}
+
+/** the mapping address lies in, NULL if allocate did not make it */
+const mapping* find_mapping(const void* address) {
+	for (const mapping& mapped : mappings()) {
+		if ((uintptr_t) address >= (uintptr_t) mapped.base && (uintptr_t) address < (uintptr_t) mapped.base + mapped.bytes) {
+			return &mapped;
+		}
+	}
+	return NULL;
+}
+
+/** false if the kernel or machine does not support numa,
+ * placements are ignored then (with a warning).
+ */
+bool numa_usable() {
+	static const bool usable = numa_available() >= 0;
+	return usable;
+}
+
+/** human readable placement, e.g. "interleave:0,1" or "local",
+ * "none" if numa is not usable at all.
+ */
+std::string placement_name(const placement& where) {
+	if (!numa_usable()) return "none";
+	std::string result = placement_policy_name(where.policy);
+	if (where.policy != PLACEMENT_LOCAL) {
+		for (size_t i = 0; i < where.nodes.size(); i++) {
+			result += (i == 0 ? ":" : ",") + std::to_string(where.nodes[i]);
+		}
+	}
+	return result;
+}
+
+/** checks that all nodes of the placement exist and have memory,
+ * prints the offending node and returns false otherwise.
+ * always true if numa is not usable, the placement is ignored anyway.
+ */
+bool valid_placement(const placement& where) {
+	if (!numa_usable()) return true;
+	if (where.policy != PLACEMENT_LOCAL && where.nodes.empty()) {
+		cerr << "placement " << placement_policy_name(where.policy) << " needs at least one node" << endl;
+		return false;
+	}
+	for (uint64_t node : where.nodes) {
+		if (node > (uint64_t) numa_max_node() || !numa_bitmask_isbitset(numa_all_nodes_ptr, node)) {
+			cerr << "numa node " << node << " does not exist (or has no memory), "
+				<< "nodes go up to " << numa_max_node() << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+/** applies mode (MPOL_*) for nodes to the pages containing
+ * [address, address + bytes). flags can be MPOL_MF_MOVE to also migrate
+ * pages that are already there. prints a warning if that does not work.
+ */
+void bind_pages(
+	void* address,
+	uint64_t bytes,
+	int mode,
+	const std::vector< uint64_t >& nodes,
+	unsigned flags = 0
+) {
+	if (!numa_usable() || bytes == 0) return;
+	// explicit huge pages can only be bound as a whole
+	const mapping* mapped = find_mapping(address);
+	const uint64_t page = mapped != NULL && (mapped->pages == PAGES_2M || mapped->pages == PAGES_1G)
+		? huge_page_bytes(mapped->pages)
+		: sysconf(_SC_PAGESIZE);
+	const uintptr_t begin = (uintptr_t) address & ~(page - 1);
+	const uintptr_t end = ((uintptr_t) address + bytes + page - 1) & ~(page - 1);
+
+	struct bitmask* mask = numa_allocate_nodemask();
+	for (uint64_t node : nodes) numa_bitmask_setbit(mask, node);
+	if (mbind((void*) begin, end - begin, mode, mask->maskp, mask->size + 1, flags) != 0) {
+		cerr << "mbind failed: " << strerror(errno) << endl;
+	}
+	numa_free_nodemask(mask);
+}
+
+/** the numa node of the cpu the calling thread runs on, 0 without numa.
+ */
+uint64_t current_node() {
+	if (!numa_usable()) return 0;
+	const int node = numa_node_of_cpu(sched_getcpu());
+	return node < 0 ? 0 : node;
+}
+
+/** moves the pages containing [address, address + bytes) to the node
+ * the calling (pinned) thread runs on. used by every worker on its own part
+ * for PLACEMENT_LOCAL, does nothing for the other placements.
+ */
+void place_locally(const placement& where, const void* address, uint64_t bytes) {
+	if (where.policy != PLACEMENT_LOCAL) return;
+	bind_pages((void*) address, bytes, MPOL_BIND, { current_node() }, MPOL_MF_MOVE);
+}
+
+/** maps bytes (rounded up to whole pages) of pages, placed according to
+ * where (the policy is set before anything is touched, so it decides where
+ * the pages come from). explicit huge pages are touched right away, as the
+ * kernel would only notice that there are not enough of them (on the nodes)
+ * when they are first written, killing the process with SIGBUS.
+ * 4k pages are excluded from transparent huge pages (which the kernel would
+ * otherwise use with transparent_hugepage/enabled=always), if that fails
+ * there is a warning and pages_description tells the share of huge ones.
+ * returns false (with nothing mapped) if there are not enough pages.
+ */
+bool map_pages(uint64_t bytes, page_mode pages, const placement& where, mapping* mapped) {
+	const uint64_t huge = huge_page_bytes(pages);
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+	uint64_t length = bytes;
+	if (pages == PAGES_2M || pages == PAGES_1G) {
+		flags |= MAP_HUGETLB | (pages == PAGES_1G ? MAP_HUGE_1GB : MAP_HUGE_2MB);
+		length = (bytes + huge - 1) & ~(huge - 1);
+	} else if (pages == PAGES_THP) {
+		// transparent huge pages need 2 MiB aligned ranges, mmap only aligns to 4 KiB
+		length = ((bytes + huge - 1) & ~(huge - 1)) + huge;
+	}
+	void* base = mmap(NULL, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+	if (base == MAP_FAILED) return false;
+
+	if (!numa_usable()) {
+		static bool warned = false;
+		if (!warned) cerr << "numa is not available, data placement is ignored" << endl;
+		warned = true;
+	} else if (where.policy == PLACEMENT_BIND) {
+		bind_pages(base, length, MPOL_BIND, where.nodes);
+	} else if (where.policy == PLACEMENT_INTERLEAVE) {
+		bind_pages(base, length, MPOL_INTERLEAVE, where.nodes);
+	}
+
+	void* address = base;
+	if (pages == PAGES_4K) {
+		if (madvise(base, length, MADV_NOHUGEPAGE) != 0) {
+			static bool warned = false;
+			if (!warned) cerr << "WARNING: could not exclude 4k pages from transparent huge pages (" << strerror(errno) << "), see the pages of the results" << endl;
+			warned = true;
+		}
+	} else if (pages == PAGES_THP) {
+		if (madvise(base, length, MADV_HUGEPAGE) != 0) {
+			munmap(base, length);
+			return false;
+		}
+		address = (void*) (((uintptr_t) base + huge - 1) & ~(huge - 1));
+	} else {
+		// explicit huge pages (2m, 1g). EINVAL: the kernel cannot populate (before 5.14), the pages were reserved by mmap then
+		if (madvise(base, length, MADV_POPULATE_WRITE) != 0 && errno != EINVAL) {
+			munmap(base, length);
+			return false;
+		}
+	}
+	*mapped = { address, base, length, pages, pages };
+	return true;
+}
+
+/** allocates memory for number_of_values values of type ResultT,
+ * placed according to where (default: 4 KiB pages bound to node 0).
+ * falls back to smaller pages (with a warning) if there are not enough
+ * of where.pages, see pages_description for what was used.
+ * apart from explicit huge pages nothing is touched yet, so PLACEMENT_LOCAL
+ * memory lands where it is first written. returns NULL if the allocation failed.
+ */
 template <class ResultT>
 ResultT* allocate(
 	uint64_t number_of_values,
-	uint64_t numa_node = 0
+	const placement& where = placement()
 ) {
 	uint64_t number_of_bytes = number_of_values * sizeof(ResultT);
-	ResultT* result = (ResultT*) numa_alloc_onnode(number_of_bytes, numa_node);
-	if (!result) {
-		cerr
-			<< "!!! Failed to allocate !!! "
-			<< " had requested " << number_of_bytes
-			<< " Bytes on node " << numa_node
-		<< endl;
+	for (page_mode pages = where.pages; ; pages = (page_mode) (pages - 1)) {
+		mapping mapped;
+		if (map_pages(number_of_bytes, pages, where, &mapped)) {
+			mapped.requested = where.pages;
+			mappings().push_back(mapped);
+			return (ResultT*) mapped.address;
+		}
+		if (pages == PAGES_4K) break;
+		cerr << "WARNING: could not get " << number_of_bytes << " Bytes of " << page_mode_name(pages)
+			<< " pages (" << strerror(errno) << "), trying " << page_mode_name((page_mode) (pages - 1)) << endl;
 	}
-	return result;
+	cerr
+		<< "!!! Failed to allocate !!! "
+		<< " had requested " << number_of_bytes
+		<< " Bytes with placement " << placement_name(where)
+	<< endl;
+	return NULL;
+}
+
+/** frees an array returned by allocate, number_of_values has to be
+ * the same that was passed to allocate.
+ */
+template <class ResultT>
+void deallocate(
+	ResultT* array,
+	uint64_t number_of_values
+) {
+	for (size_t m = 0; m < mappings().size(); m++) {
+		if (mappings()[m].address == array) {
+			munmap(mappings()[m].base, mappings()[m].bytes);
+			mappings().erase(mappings().begin() + m);
+			return;
+		}
+	}
+	munmap(array, number_of_values * sizeof(ResultT));
+}
+
+/** the share of the resident pages of the mapping containing address that
+ * are transparent huge pages, from /proc/self/smaps. -1 if unknown.
+ */
+double transparent_huge_page_share(const void* address) {
+	std::ifstream smaps("/proc/self/smaps");
+	std::string line;
+	bool inside = false;
+	uint64_t resident = 0, huge = 0;
+	while (std::getline(smaps, line)) {
+		unsigned long begin, end;
+		char space;
+		if (sscanf(line.c_str(), "%lx-%lx%c", &begin, &end, &space) == 3 && space == ' ') {
+			if (inside) break;
+			inside = (uintptr_t) address >= begin && (uintptr_t) address < end;
+		} else if (inside) {
+			sscanf(line.c_str(), "Rss: %lu", &resident);
+			sscanf(line.c_str(), "AnonHugePages: %lu", &huge);
+		}
+	}
+	if (resident == 0) return -1;
+	return (double) huge / resident;
+}
+
+/** the pages the array at address (from allocate) got, e.g. "2m",
+ * "thp (93% huge)" or "2m (1g requested)". 4k pages that nevertheless
+ * became transparent huge pages are reported like "4k (40% huge)".
+ * for thp (and 4k) the share is only known after the array was written.
+ */
+std::string pages_description(const void* address) {
+	const mapping* mapped = find_mapping(address);
+	if (mapped == NULL) return "unknown";
+	std::string notes = "";
+	if (mapped->pages == PAGES_THP) {
+		const double share = transparent_huge_page_share(address);
+		if (share >= 0) notes += ", " + std::to_string((int) (share * 100 + 0.5)) + "% huge";
+	} else if (mapped->pages == PAGES_4K) {
+		const double share = transparent_huge_page_share(address);
+		if (share > 0) notes += ", " + std::to_string((int) (share * 100 + 0.5)) + "% huge";
+	}
+	if (mapped->pages != mapped->requested) notes += ", " + page_mode_name(mapped->requested) + " requested";
+	if (notes.empty()) return page_mode_name(mapped->pages);
+	return page_mode_name(mapped->pages) + " (" + notes.substr(2) + ")";
 }
 
 
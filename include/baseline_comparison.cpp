@@ -0,0 +1,365 @@
+#ifndef BASELINE_COMPARISON_CPP
+#define BASELINE_COMPARISON_CPP
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "measures.h"
+#include "options.cpp"
+#include "statistics.cpp"
+#include "structured_results.cpp"
+
+/** identifies a point across runs: everything of data_point but the
+ * number of lookups (and hops), as in the columns of the structured results,
+ * and the placement of the pointer chases, which run on one node after the other.
+ */
+std::string point_key(const std::string& mode, const std::string& bits, const std::string& isa, const std::string& kernel,
+	const std::string& cores, const std::string& stride, const std::string& distribution, const std::string& buckets,
+	const std::string& layout, const std::string& slots, const std::string& hit_rate,
+	const std::string& working_set, const std::string& placement,
+	const std::string& background, const std::string& background_cores) {
+	return mode + " " + bits + " bit " + isa + " " + kernel + " " + cores + " cores"
+		+ (distribution.empty() ? " stride " + stride : " " + distribution)
+		+ (buckets.empty() ? "" : " " + buckets + " buckets")
+		+ (layout.empty() ? "" : " " + layout + " " + slots + " slots hit rate " + hit_rate)
+		+ (working_set.empty() ? "" : " " + working_set + " bytes on " + placement)
+		+ (background.empty() ? "" : " with " + background_cores + " " + background + " background");
+}
+
+std::string point_key(const data_point& point, const std::string& placement) {
+	const bool lookup = !point.distribution.empty();
+	const bool chase = point.working_set != 0;
+	return point_key(point.multi_threaded ? "multi" : "single", std::to_string(point.bits), point.isa, point.kernel,
+		std::to_string(point.cores), lookup || chase ? "" : std::to_string(point.stride), point.distribution,
+		point.buckets != 0 ? std::to_string(point.buckets) : "", point.layout,
+		point.layout.empty() ? "" : std::to_string(point.slots), point.layout.empty() ? "" : csv_real(point.hit_rate),
+		point.working_set != 0 ? std::to_string(point.working_set) : "", placement,
+		point.background, point.background.empty() ? "" : std::to_string(point.background_cores));
+}
+
+/** splits a line of a csv file into its fields, quoted ones unquoted */
+std::vector< std::string > split_csv_line(const std::string& line) {
+	std::vector< std::string > fields(1);
+	bool quoted = false;
+	for (size_t c = 0; c < line.size(); c++) {
+		if (quoted && line[c] == '"' && c + 1 < line.size() && line[c + 1] == '"') {
+			fields.back() += '"';
+			c++;
+		} else if (line[c] == '"') {
+			quoted = !quoted;
+		} else if (line[c] == ',' && !quoted) {
+			fields.push_back("");
+		} else {
+			fields.back() += line[c];
+		}
+	}
+	return fields;
+}
+
+/** what the comparison needs of a point of the baseline */
+struct baseline_point {
+	double throughput;
+	double duration;
+	double stddev;
+	uint64_t iterations;
+};
+
+/** the relative change of the throughput of a point against the baseline
+ * and whether it is significant: welch's t test on the mean durations
+ * (with their standard deviations and numbers of executions) at 95%.
+ * without variance (a single execution), every change counts as significant.
+ */
+struct point_delta {
+	double change; // (throughput - baseline) / baseline
+	double t;
+	bool significant;
+};
+
+point_delta compare_point(const baseline_point& baseline, const measures& measurement, uint64_t iterations) {
+	point_delta delta;
+	delta.change = (measurement.throughput - baseline.throughput) / baseline.throughput;
+	const double v1 = baseline.stddev * baseline.stddev / baseline.iterations;
+	const double v2 = measurement.statistics.stddev * measurement.statistics.stddev / iterations;
+	if (!(v1 + v2 > 0)) {
+		delta.t = NAN;
+		delta.significant = true;
+		return delta;
+	}
+	delta.t = (measurement.duration - baseline.duration) / std::sqrt(v1 + v2);
+	// welch-satterthwaite degrees of freedom
+	const double denominator =
+		(baseline.iterations > 1 ? v1 * v1 / (baseline.iterations - 1) : 0) +
+		(iterations > 1 ? v2 * v2 / (iterations - 1) : 0);
+	const uint64_t degrees_of_freedom = denominator > 0 ? (uint64_t) std::max(1.0, std::floor((v1 + v2) * (v1 + v2) / denominator)) : 1;
+	delta.significant = std::fabs(delta.t) > student_t95(degrees_of_freedom);
+	return delta;
+}
+
+/** a previous run's structured results (see --baseline), the points of this
+ * run are compared against as they are measured. a point whose throughput
+ * dropped significantly by more than the threshold is a regression.
+ */
+class baseline_comparison {
+	std::map< std::string, baseline_point > points;
+	// "# key: value" lines of the baseline
+	std::map< std::string, std::string > metadata;
+	std::ofstream report;
+	double threshold = 0;
+	uint64_t compared = 0;
+	uint64_t regressions = 0;
+	uint64_t improvements = 0;
+
+public:
+	// the sweep of the baseline, see apply_sweep
+	std::vector< uint64_t > widths, strides, core_counts, bucket_counts, table_slots, working_sets, background_cores;
+	std::vector< std::string > isas, modes, kernels, distributions, layouts, backgrounds;
+	std::vector< double > hit_rates;
+	uint64_t data_size_log2 = 0;
+
+	bool loaded() const { return !points.empty(); }
+
+	/** reads the structured results in filename, returns false (and says why)
+	 * if it cannot be read or has no points.
+	 */
+	bool load(const std::string& filename) {
+		std::ifstream file(filename);
+		if (!file.good()) {
+			std::cerr << "cannot read baseline '" << filename << "'" << std::endl;
+			return false;
+		}
+		std::map< std::string, size_t > column;
+		std::string line;
+		while (std::getline(file, line)) {
+			if (line.empty()) continue;
+			if (line[0] == '#') {
+				const size_t colon = line.find(": ");
+				if (colon != std::string::npos) metadata[line.substr(2, colon - 2)] = line.substr(colon + 2);
+				continue;
+			}
+			const std::vector< std::string > fields = split_csv_line(line);
+			if (column.empty()) {
+				for (size_t f = 0; f < fields.size(); f++) column[fields[f]] = f;
+				for (const char* name : { "mode", "bits", "isa", "kernel", "cores", "stride", "distribution",
+					"placement", "data_size_log2", "iterations", "correct", "throughput", "duration", "stddev" }) {
+					if (column.count(name) == 0) {
+						std::cerr << "baseline '" << filename << "' has no column " << name << std::endl;
+						return false;
+					}
+				}
+				continue;
+			}
+			if (fields.size() < column.size()) continue;
+			// at, so looking up a column never adds one to column
+			auto field = [&fields, &column] (const char* name) { return fields[column.at(name)]; };
+			if (field("correct") != "1") continue;
+			// older results have no buckets or hash tables
+			const std::string buckets = column.count("buckets") != 0 ? field("buckets") : "";
+			const std::string layout = column.count("layout") != 0 ? field("layout") : "";
+			const std::string slots = column.count("slots") != 0 ? field("slots") : "";
+			const std::string hit_rate = column.count("hit_rate") != 0 ? field("hit_rate") : "";
+			const std::string working_set = column.count("working_set") != 0 ? field("working_set") : "";
+			const std::string background = column.count("background") != 0 ? field("background") : "";
+			const std::string background_cores_field = column.count("background_cores") != 0 ? field("background_cores") : "";
+			points[point_key(field("mode"), field("bits"), field("isa"), field("kernel"), field("cores"), field("stride"), field("distribution"), buckets,
+				layout, slots, hit_rate, working_set, field("placement"), background, background_cores_field)] = {
+				strtod(field("throughput").c_str(), NULL),
+				strtod(field("duration").c_str(), NULL),
+				strtod(field("stddev").c_str(), NULL),
+				strtoull(field("iterations").c_str(), NULL, 10),
+			};
+			add_once(&widths, (uint64_t) strtoull(field("bits").c_str(), NULL, 10));
+			add_once(&isas, field("isa"));
+			add_once(&modes, field("mode"));
+			add_once(&kernels, field("kernel"));
+			if (!field("distribution").empty()) add_once(&distributions, field("distribution"));
+			if (!layout.empty()) {
+				add_once(&layouts, layout);
+				add_once(&table_slots, (uint64_t) strtoull(slots.c_str(), NULL, 10));
+				add_once(&hit_rates, strtod(hit_rate.c_str(), NULL));
+			}
+			if (!working_set.empty()) add_once(&working_sets, (uint64_t) strtoull(working_set.c_str(), NULL, 10));
+			if (!background.empty()) {
+				add_once(&backgrounds, background);
+				add_once(&background_cores, (uint64_t) strtoull(background_cores_field.c_str(), NULL, 10));
+			}
+			if (!buckets.empty()) add_once(&bucket_counts, (uint64_t) strtoull(buckets.c_str(), NULL, 10));
+			else if (working_set.empty() && field("stride") != "0") add_once(&strides, (uint64_t) strtoull(field("stride").c_str(), NULL, 10));
+			if (field("mode") == "multi") add_once(&core_counts, (uint64_t) strtoull(field("cores").c_str(), NULL, 10));
+			data_size_log2 = strtoull(field("data_size_log2").c_str(), NULL, 10);
+		}
+		if (points.empty()) {
+			std::cerr << "baseline '" << filename << "' has no (correct) points" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	/** runs the points of the baseline: widths, instruction sets, modes,
+	 * kernels, strides, core counts, distributions, bucket counts, hash tables
+	 * (layouts, sizes and hit rates), working sets and background loads of
+	 * options are the ones in the baseline (the data size too, unless one
+	 * was given). returns false if one of them is invalid (or the baseline
+	 * has several background kernels, which a run cannot).
+	 */
+	bool apply_sweep(run_options* options) const {
+		bool valid = true;
+		if (options->data_size_log2 == 0) options->data_size_log2 = data_size_log2;
+		options->widths = widths;
+		options->isas.clear();
+		for (const std::string& name : isas) {
+			cpu_isa isa;
+			valid = valid && parse_isa(name, &isa);
+			options->isas.push_back(isa);
+		}
+		options->single_threaded = std::find(modes.begin(), modes.end(), "single") != modes.end();
+		options->multi_threaded = std::find(modes.begin(), modes.end(), "multi") != modes.end();
+		options->kernels = kernels;
+		// kernels without a stride still need one to run at
+		if (!strides.empty()) options->strides = strides;
+		else options->strides.resize(1);
+		if (!core_counts.empty()) options->core_counts = core_counts;
+		if (!bucket_counts.empty()) options->buckets_log2.clear();
+		for (uint64_t buckets : bucket_counts) {
+			uint64_t log2 = 0;
+			while (((uint64_t) 2 << log2) <= buckets) log2++;
+			options->buckets_log2.push_back(log2);
+		}
+		if (!table_slots.empty()) options->table_sizes_log2.clear();
+		for (uint64_t slots : table_slots) {
+			uint64_t log2 = 0;
+			while (((uint64_t) 2 << log2) <= slots) log2++;
+			options->table_sizes_log2.push_back(log2);
+		}
+		if (!layouts.empty()) options->layouts.clear();
+		for (const std::string& name : layouts) {
+			table_layout layout;
+			valid = valid && parse_table_layout(name, &layout);
+			options->layouts.push_back(layout);
+		}
+		if (!hit_rates.empty()) options->hit_rates = hit_rates;
+		if (!working_sets.empty()) options->working_sets_log2.clear();
+		for (uint64_t bytes : working_sets) {
+			uint64_t log2 = 0;
+			while (((uint64_t) 2 << log2) <= bytes) log2++;
+			options->working_sets_log2.push_back(log2);
+		}
+		if (backgrounds.size() > 1) {
+			std::cerr << "the baseline has several background kernels, a run only one" << std::endl;
+			valid = false;
+		}
+		if (!backgrounds.empty()) {
+			options->background = backgrounds[0];
+			options->background_cores = background_cores;
+		}
+		if (!distributions.empty()) options->distributions.clear();
+		for (const std::string& name : distributions) {
+			index_distribution distribution;
+			valid = valid && parse_index_distribution(name, &distribution);
+			options->distributions.push_back(distribution);
+		}
+		return valid;
+	}
+
+	/** describes the baseline and warns about options (in the "# key: value"
+	 * lines of header) that differ from it, then starts the report in
+	 * report_filename (a line per compared point) with the threshold in percent.
+	 */
+	bool start(const std::string& header, const std::string& report_filename, double threshold_percent) {
+		threshold = threshold_percent / 100.0;
+		std::cout << "comparing against the baseline of " << metadata["host"] << " from " << metadata["date"]
+			<< " (revision " << metadata["git_revision"] << ", microcode " << metadata["microcode"] << ")" << std::endl;
+		size_t begin = 0;
+		while (begin < header.size()) {
+			const size_t end = header.find('\n', begin);
+			const std::string line = header.substr(begin, end - begin);
+			begin = end == std::string::npos ? header.size() : end + 1;
+			const size_t colon = line.find(": ");
+			if (line.compare(0, 2, "# ") != 0 || colon == std::string::npos) continue;
+			const std::string key = line.substr(2, colon - 2);
+			const std::string value = line.substr(colon + 2);
+			// these always differ
+			if (key == "date" || key == "command") continue;
+			if (metadata.count(key) != 0 && metadata[key] != value) {
+				std::cerr << "WARNING: the baseline was measured with " << key << " " << metadata[key]
+					<< ", this run uses " << value << std::endl;
+			}
+		}
+		report.open(report_filename);
+		if (!report.good()) return false;
+		std::cout << "writing the comparison to '" << report_filename << "'." << std::endl;
+		report << header << "# baseline_host: " << metadata["host"] << "\n"
+			<< "# baseline_date: " << metadata["date"] << "\n"
+			<< "# baseline_git_revision: " << metadata["git_revision"] << "\n"
+			<< "# regression_threshold: " << threshold_percent << "%\n"
+			<< "point,baseline_throughput,throughput,change,t,significant,regression" << std::endl;
+		return true;
+	}
+
+	/** compares a measured point (if the baseline has it) and reports it */
+	void compare(const data_point& point, const std::string& placement, const measures& measurement, uint64_t iterations, bool correct) {
+		if (!loaded()) return;
+		const std::string key = point_key(point, placement);
+		auto found = points.find(key);
+		if (found == points.end()) return;
+		compared++;
+		const point_delta delta = compare_point(found->second, measurement, iterations);
+		const bool regression = !correct || (delta.significant && delta.change < -threshold);
+		if (regression) regressions++;
+		else if (delta.significant && delta.change > threshold) improvements++;
+
+		std::cout << (regression ? "REGRESSION " : "compared ") << key << ": "
+			<< found->second.throughput << " -> " << measurement.throughput << " GB/s ("
+			<< std::showpos << std::fixed << std::setprecision(1) << delta.change * 100 << "%"
+			<< std::noshowpos << std::defaultfloat << std::setprecision(6)
+			<< (correct ? (delta.significant ? ", significant)" : ", not significant)") : ", wrong result)") << std::endl;
+		report << key << "," << found->second.throughput << "," << measurement.throughput << "," << delta.change
+			<< "," << delta.t << "," << (delta.significant ? 1 : 0) << "," << (regression ? 1 : 0) << std::endl;
+	}
+
+	/** prints the summary, returns whether there was no regression */
+	bool finish() {
+		if (!loaded()) return true;
+		std::cout << "compared " << compared << " of " << points.size() << " baseline points: "
+			<< regressions << " regressions, " << improvements << " improvements (threshold "
+			<< threshold * 100 << "%)" << std::endl;
+		if (compared < points.size()) {
+			std::cerr << "WARNING: " << points.size() - compared << " points of the baseline were not measured" << std::endl;
+		}
+		return regressions == 0;
+	}
+
+private:
+	template <class T>
+	static void add_once(std::vector< T >* values, const T& value) {
+		if (std::find(values->begin(), values->end(), value) == values->end()) values->push_back(value);
+	}
+};
+
+/** the baseline of this run, see --baseline, empty without one */
+baseline_comparison& baseline() {
+	static baseline_comparison comparison;
+	return comparison;
+}
+
+/** writes a measured point to the structured results and compares it
+ * against the baseline (if there is one).
+ */
+void record_point(
+	const data_point& point,
+	const run_options& options,
+	const std::string& pages,
+	const measures& measurement,
+	bool correct
+) {
+	structured_output().write(point, options, pages, measurement, correct);
+	baseline().compare(point, placement_name(options.data_placement), measurement, options.iterations, correct);
+}
+
+
+#endif // include guard BASELINE_COMPARISON_CPP
@@ -0,0 +1,412 @@
+#ifndef BENCHMARK_DATA_CPP
+#define BENCHMARK_DATA_CPP
+
+#include <algorithm>
+#include <limits>
+
+#include "error_codes.h"
+#include "allocate.cpp"
+#include "generate_random_values.cpp"
+#include "generate_indices.cpp"
+#include "gather/aggregate_scalar.cpp"
+#include "gather/groupby_scalar.cpp"
+#include "hash_table.h"
+
+/** the values all kernels of one element width run on, generated once and
+ * shared by every instruction set and by the single and multi threaded runs.
+ */
+template <class ResultT>
+struct benchmark_data {
+	uint64_t number_of_values;
+	// random values, read by the aggregating kernels
+	ResultT* array;
+	// sum over array, in 64 bit (see aggregate_scalar_wide)
+	uint64_t correct;
+	// scatter functions write, so they get their own array to not destroy
+	// the values the aggregation functions are checked against.
+	// NULL if no scatter function is run.
+	ResultT* scatter_array;
+	// the pages array got, see pages_description
+	std::string pages;
+};
+
+/** allocates number_of_values values (and as many for scatter_array if
+ * with_scatter) placed according to where and fills them with the random
+ * numbers of seed in 1..max_value (at most the largest ResultT), summing them
+ * up in the same pass, on the workers of the pool.
+ * exits with NO_MEMORY if that fails.
+ */
+template <class ResultT>
+benchmark_data<ResultT> prepare_benchmark_data(
+	uint64_t number_of_values,
+	const placement& where,
+	bool with_scatter,
+	thread_pool& pool,
+	uint64_t seed,
+	uint64_t max_value
+) {
+    // define number of values
+    // 27 --> 134 million integers --> 8GB
+    // 26 --> 67 million integers --> 4GB
+	benchmark_data<ResultT> data;
+	data.number_of_values = number_of_values;
+	cerr << "number_of_values: " << data.number_of_values << endl;
+
+    data.array = allocate<ResultT>(data.number_of_values, where);
+    if (data.array != NULL) {
+        cout << "Memory allocated - " << data.number_of_values << " values" << endl;
+    } else {
+        cout << "Memory not allocated" << endl;
+		exit(NO_MEMORY);
+    }
+    data.correct = generate_random_values(pool, data.array, data.number_of_values, seed,
+        std::min< uint64_t >(max_value, std::numeric_limits< ResultT >::max()));
+    data.pages = pages_description(data.array);
+    cout <<"Generation done, pages: " << data.pages <<endl;
+
+    data.scatter_array = NULL;
+    if (with_scatter) {
+        data.scatter_array = allocate<ResultT>(data.number_of_values, where);
+        if (data.scatter_array == NULL) {
+            cout << "Memory for scatter not allocated" << endl;
+            exit(NO_MEMORY);
+        }
+    }
+	return data;
+}
+
+/** describes the data as "# key: value" lines, like options_header */
+template <class ResultT>
+std::string data_header(const benchmark_data<ResultT>& data) {
+	return "# pages: " + data.pages + "\n";
+}
+
+template <class ResultT>
+void release_benchmark_data(benchmark_data<ResultT>& data) {
+	cerr << "freeing array!" << endl;
+    deallocate(data.array, data.number_of_values);
+    if (data.scatter_array != NULL) deallocate(data.scatter_array, data.number_of_values);
+}
+
+/** the index arrays of the lookup kernels for one distribution: the same
+ * positions as 64 and 32 bit offsets. the 32 bit gathers take signed
+ * offsets, so index32 is NULL if there are more than 2**31 values.
+ */
+struct lookup_indices {
+	index_distribution distribution;
+	uint64_t number;
+	uint64_t* index64;
+	uint32_t* index32;
+};
+
+/** allocates the index arrays for 2**lookups_log2 lookups into
+ * values_count values, placed according to where.
+ * exits with NO_MEMORY if that fails.
+ */
+lookup_indices allocate_lookup_indices(uint64_t lookups_log2, uint64_t values_count, const placement& where) {
+	lookup_indices indices;
+	indices.distribution = INDEX_UNIFORM;
+	indices.number = (uint64_t) 1 << lookups_log2;
+	indices.index64 = allocate<uint64_t>(indices.number, where);
+	indices.index32 = NULL;
+	if (values_count <= ((uint64_t) 1 << 31)) indices.index32 = allocate<uint32_t>(indices.number, where);
+	if (indices.index64 == NULL || (values_count <= ((uint64_t) 1 << 31) && indices.index32 == NULL)) {
+		cout << "Memory for the lookup indices not allocated" << endl;
+		exit(NO_MEMORY);
+	}
+	return indices;
+}
+
+/** fills indices with positions into the values of data,
+ * distributed as distribution, from the random numbers of seed.
+ */
+template <class ResultT>
+void generate_lookup_indices(
+	lookup_indices* indices,
+	const benchmark_data<ResultT>& data,
+	index_distribution distribution,
+	const index_parameters& parameters,
+	uint64_t seed
+) {
+	indices->distribution = distribution;
+	generate_indices(indices->index64, indices->number, data.number_of_values, sizeof(ResultT), distribution, parameters, seed);
+	if (indices->index32 != NULL) {
+		for (uint64_t i = 0; i < indices->number; i++) indices->index32[i] = (uint32_t) indices->index64[i];
+	}
+	cout << index_distribution_name(distribution) << " indices generated." << endl;
+}
+
+void release_lookup_indices(lookup_indices& indices) {
+	deallocate(indices.index64, indices.number);
+	if (indices.index32 != NULL) deallocate(indices.index32, indices.number);
+}
+
+/** the keys of the group-by kernels for one bucket count and distribution,
+ * one per value of the data, and the buckets the group-by sums (sums) and
+ * the histograms (counts) have to end up with.
+ */
+template <class ResultT>
+struct groupby_keys {
+	index_distribution distribution;
+	uint64_t bucket_count;
+	uint64_t number;
+	uint32_t* keys;
+	std::vector< ResultT > sums;
+	std::vector< ResultT > counts;
+};
+
+/** allocates the keys for the values of data, placed according to where.
+ * exits with NO_MEMORY if that fails.
+ */
+template <class ResultT>
+groupby_keys<ResultT> allocate_groupby_keys(const benchmark_data<ResultT>& data, const placement& where) {
+	groupby_keys<ResultT> keys;
+	keys.distribution = INDEX_UNIFORM;
+	keys.bucket_count = 0;
+	keys.number = data.number_of_values;
+	keys.keys = allocate<uint32_t>(keys.number, where);
+	if (keys.keys == NULL) {
+		cout << "Memory for the group-by keys not allocated" << endl;
+		exit(NO_MEMORY);
+	}
+	return keys;
+}
+
+/** fills keys with keys below bucket_count, distributed as distribution,
+ * from the random numbers of seed, and adds up the expected buckets
+ * (with groupby_scalar).
+ */
+template <class ResultT>
+void generate_groupby_keys(
+	groupby_keys<ResultT>* keys,
+	const benchmark_data<ResultT>& data,
+	uint64_t bucket_count,
+	index_distribution distribution,
+	const index_parameters& parameters,
+	uint64_t seed
+) {
+	keys->distribution = distribution;
+	keys->bucket_count = bucket_count;
+	generate_indices(keys->keys, keys->number, bucket_count, sizeof(ResultT), distribution, parameters, seed);
+	keys->sums.assign(bucket_count, 0);
+	keys->counts.assign(bucket_count, 0);
+	groupby_scalar<false>(data.array, keys->keys, keys->number, keys->sums.data(), bucket_count);
+	groupby_scalar<true>(data.array, keys->keys, keys->number, keys->counts.data(), bucket_count);
+	cout << index_distribution_name(distribution) << " keys of " << bucket_count << " buckets generated." << endl;
+}
+
+template <class ResultT>
+void release_groupby_keys(groupby_keys<ResultT>& keys) {
+	deallocate(keys.keys, keys.number);
+}
+
+/** the value (payload) of the i-th entry of the hash tables of seed, in
+ * 1..max_value, from a stream of random numbers of its own.
+ */
+template <class ResultT>
+inline ResultT table_value(uint64_t seed, uint64_t i, uint64_t max_value) {
+	return random_value<ResultT>(seed + 1, i, std::min< uint64_t >(max_value, std::numeric_limits< ResultT >::max()));
+}
+
+/** allocates a hash table of 2**slots_log2 slots in layout (buckets of
+ * TABLE_BUCKET_BYTES), placed according to where, and inserts
+ * load_factor * slots entries (at least one): key table_key(i) with value
+ * table_value(seed, i) for i in 1..entries.
+ * exits with NO_MEMORY if that fails.
+ */
+template <class ResultT>
+hash_table<ResultT> build_hash_table(
+	table_layout layout,
+	uint64_t slots_log2,
+	double load_factor,
+	const placement& where,
+	uint64_t seed,
+	uint64_t max_value
+) {
+	hash_table<ResultT> table;
+	table.layout = layout;
+	table.slots_log2 = slots_log2;
+	table.bucket_log2 = 0;
+	if (layout == LAYOUT_BUCKETS) {
+		while (((uint64_t) sizeof(ResultT) << (table.bucket_log2 + 1)) <= TABLE_BUCKET_BYTES) table.bucket_log2++;
+	}
+	table.entries = std::max< uint64_t >(1, (uint64_t) (load_factor * table.slots()));
+	table.keys = allocate<ResultT>(table.slots(), where);
+	table.values = allocate<ResultT>(table.slots(), where);
+	if (table.keys == NULL || table.values == NULL) {
+		cout << "Memory for the hash table not allocated" << endl;
+		exit(NO_MEMORY);
+	}
+	memset(table.keys, 0, table.slots() * sizeof(ResultT));
+	memset(table.values, 0, table.slots() * sizeof(ResultT));
+
+	const uint64_t slot_mask = table.slots() - 1;
+	for (uint64_t i = 1; i <= table.entries; i++) {
+		const ResultT key = table_key((uint32_t) i);
+		uint64_t slot = probe_start(key, slots_log2, table.bucket_log2);
+		while (table.keys[slot] != 0) slot = (slot + 1) & slot_mask;
+		table.keys[slot] = key;
+		table.values[slot] = table_value<ResultT>(seed, i, max_value);
+	}
+	cout << table_layout_name(layout) << " hash table of " << table.slots() << " slots, " << table.entries << " entries built." << endl;
+	return table;
+}
+
+template <class ResultT>
+void release_hash_table(hash_table<ResultT>& table) {
+	deallocate(table.keys, table.slots());
+	deallocate(table.values, table.slots());
+}
+
+/** the keys the probe kernels look up in a hash table, one per value of the
+ * data: a fraction hit_rate of them is in the table, and expected is the
+ * sum of their values.
+ */
+template <class ResultT>
+struct probe_keys {
+	double hit_rate;
+	uint64_t number;
+	ResultT* keys;
+	uint64_t expected;
+};
+
+/** allocates the probe keys for the values of data, placed according to where.
+ * exits with NO_MEMORY if that fails.
+ */
+template <class ResultT>
+probe_keys<ResultT> allocate_probe_keys(const benchmark_data<ResultT>& data, const placement& where) {
+	probe_keys<ResultT> keys;
+	keys.hit_rate = 0;
+	keys.number = data.number_of_values;
+	keys.expected = 0;
+	keys.keys = allocate<ResultT>(keys.number, where);
+	if (keys.keys == NULL) {
+		cout << "Memory for the probe keys not allocated" << endl;
+		exit(NO_MEMORY);
+	}
+	return keys;
+}
+
+/** fills keys with uniformly random keys of the entries of table, each one
+ * with a probability of hit_rate, and else with keys that are not in it
+ * (table_key(i) for i in entries+1..2*entries), from the random numbers of
+ * seed, and sums up the values of the hits.
+ */
+template <class ResultT>
+void generate_probe_keys(
+	probe_keys<ResultT>* keys,
+	const hash_table<ResultT>& table,
+	double hit_rate,
+	uint64_t seed,
+	uint64_t max_value
+) {
+	keys->hit_rate = hit_rate;
+	keys->expected = 0;
+	const uint64_t hit_below = hit_rate >= 1 ? UINT64_MAX : (uint64_t) (hit_rate * 18446744073709551616.0);
+	for (uint64_t j = 0; j < keys->number; j++) {
+		const bool hit = counter_random(seed + 2, 2 * j) < hit_below;
+		const uint64_t entry = 1 + (uint64_t) (((unsigned __int128) counter_random(seed + 2, 2 * j + 1) * table.entries) >> 64);
+		keys->keys[j] = table_key((uint32_t) (hit ? entry : entry + table.entries));
+		if (hit) keys->expected += table_value<ResultT>(seed, entry, max_value);
+	}
+	cout << keys->number << " probe keys with a hit rate of " << hit_rate << " generated." << endl;
+}
+
+template <class ResultT>
+void release_probe_keys(probe_keys<ResultT>& keys) {
+	deallocate(keys.keys, keys.number);
+}
+
+/** allocates the values the background load (see --background) streams
+ * over, as many as data has, placed according to where, and fills them like
+ * data (with another seed). they are apart from the values of data, so the
+ * background does not bring those into the caches.
+ * exits with NO_MEMORY if that fails.
+ */
+template <class ResultT>
+ResultT* prepare_background_values(uint64_t number_of_values, const placement& where, thread_pool& pool, uint64_t seed, uint64_t max_value) {
+	ResultT* values = allocate<ResultT>(number_of_values, where);
+	if (values == NULL) {
+		cout << "Memory for the background load not allocated" << endl;
+		exit(NO_MEMORY);
+	}
+	generate_random_values(pool, values, number_of_values, seed + 4,
+		std::min< uint64_t >(max_value, std::numeric_limits< ResultT >::max()));
+	return values;
+}
+
+/** a random cycle through the cache lines of a working set of 2**bytes_log2
+ * bytes for the pointer chasing kernels: next[position] is the position of
+ * the next line of the cycle, where positions are the first element of a
+ * line (the others are 0). order holds the positions in the order of the
+ * cycle, to tell where a chase ends.
+ */
+template <class ResultT>
+struct chase_cycle {
+	uint64_t bytes;
+	uint64_t number;
+	ResultT* next;
+	std::vector< ResultT > order;
+	std::string pages;
+};
+
+constexpr uint64_t CHASE_LINE_BYTES = 64;
+
+/** allocates the working set, placed according to where, and links its
+ * lines into one cycle in the order of a random permutation (Fisher-Yates
+ * with the random numbers of seed), so every hop of a chase goes to another
+ * line, which the hardware prefetchers cannot predict.
+ * exits with NO_MEMORY if that fails.
+ */
+template <class ResultT>
+chase_cycle<ResultT> build_chase_cycle(uint64_t bytes_log2, const placement& where, uint64_t seed) {
+	chase_cycle<ResultT> cycle;
+	cycle.bytes = (uint64_t) 1 << bytes_log2;
+	cycle.number = cycle.bytes / sizeof(ResultT);
+	cycle.next = allocate<ResultT>(cycle.number, where);
+	if (cycle.next == NULL) {
+		cout << "Memory for the pointer chase not allocated" << endl;
+		exit(NO_MEMORY);
+	}
+	memset(cycle.next, 0, cycle.bytes);
+
+	const uint64_t line = CHASE_LINE_BYTES / sizeof(ResultT);
+	const uint64_t lines = cycle.number / line;
+	cycle.order.resize(lines);
+	for (uint64_t l = 0; l < lines; l++) cycle.order[l] = (ResultT) (l * line);
+	for (uint64_t l = lines - 1; l > 0; l--) {
+		const uint64_t other = ((unsigned __int128) counter_random(seed + 3, l) * (l + 1)) >> 64;
+		std::swap(cycle.order[l], cycle.order[other]);
+	}
+	for (uint64_t l = 0; l < lines; l++) cycle.next[cycle.order[l]] = cycle.order[l + 1 == lines ? 0 : l + 1];
+	cycle.pages = pages_description(cycle.next);
+	cout << "cycle through " << lines << " lines (" << cycle.bytes << " bytes, " << placement_name(where) << ") built." << endl;
+	return cycle;
+}
+
+/** the positions count chains start at, evenly spread over the cycle */
+template <class ResultT>
+std::vector< ResultT > chase_starts(const chase_cycle<ResultT>& cycle, uint64_t count) {
+	std::vector< ResultT > starts(count);
+	for (uint64_t c = 0; c < count; c++) starts[c] = cycle.order[c * cycle.order.size() / count];
+	return starts;
+}
+
+/** the sum of the positions the chains first..first+lanes-1 of chase_starts
+ * (of count) end at after hops, like the chase kernels return it.
+ */
+template <class ResultT>
+uint64_t chase_expected(const chase_cycle<ResultT>& cycle, uint64_t first, uint64_t lanes, uint64_t count, uint64_t hops) {
+	const uint64_t lines = cycle.order.size();
+	uint64_t sum = 0;
+	for (uint64_t c = first; c < first + lanes; c++) sum += cycle.order[(c * lines / count + hops) % lines];
+	return sum;
+}
+
+template <class ResultT>
+void release_chase_cycle(chase_cycle<ResultT>& cycle) {
+	deallocate(cycle.next, cycle.number);
+}
+
+
+#endif // include guard BENCHMARK_DATA_CPP
@@ -1,48 +1,242 @@
 #ifndef BENCHMARK_SINGLE_THREADED_CPP
 #define BENCHMARK_SINGLE_THREADED_CPP
 
+#include <cstring>
+#include <vector>
+
 #include "measures.h"
 #include "parameters.h"
+#include "gather/aggregate_scalar.cpp"
+#include "gather/lookup_scalar.cpp"
+#include "aggregation_type.h"
+#include "cache_control.cpp"
+#include "options.cpp"
+#include "partition.cpp"
+
+/** calls call() options.warmup times without recording anything, then
+ * options.iterations times and stores duration, throughput (of bytes per
+ * execution), result, mis (of n values), the hardware counters (averaged
+ * over the executions) and the duration of every execution with their
+ * statistics in the struct measures.
+ * before every execution, prepare() brings the caches into the state
+ * chosen in options.
+ */
+template <class Prepare, class Call>
+void measure_calls(
+	const run_options& options,
+	measures* res,
+	uint64_t n,
+	uint64_t bytes,
+	const Prepare& prepare,
+	const Call& call
+) {
+    const uint64_t iterations = options.iterations;
+    const double GB = (((double)bytes/(double)1024)/(double)1024)/(double)1024;
+
+    for (uint64_t i=0; i<options.warmup; i++) {
+        prepare();
+        (*res).result = call();
+    }
+
+    perf_counters& counters = thread_perf_counters();
+    perf_counts counts;
+    uint64_t duration = 0;
+    (*res).samples.clear();
+    for (uint64_t i=0; i<iterations; i++) {
+        // flush (or warm) caches and TLB, clean start setting
+        prepare();
+        counters.start();
+        auto begin = chrono::high_resolution_clock::now();
+        (*res).result = call();
+        auto end = std::chrono::high_resolution_clock::now();
+        counters.stop(&counts);
+        const uint64_t execution = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+        duration += execution;
+        (*res).samples.push_back(execution);
+    }
+    counts /= iterations;
+    (*res).counters = counts;
+    (*res).statistics = summarize((*res).samples);
+    (*res).duration = (double)duration/(double)iterations;
+    (*res).throughput = GB/((double)(*res).duration*1e-9);
+    (*res).mis = ((double)n/1000000)/((double)duration/(double)(iterations*(uint64_t)1000000000));
+}
+
+/** runs the passed function over the given values, see measure_calls.
+ * ArrayT is const for aggregating (reading) functions and non-const for
+ * scattering (writing) ones.
+ */
+template <class ArrayT>
+void measure(
+	const run_options& options,
+	measures* res,
+	ArrayT* values,
+	uint64_t n,
+	const uint32_t stride,
+	uint64_t (*func)(ArrayT*, uint64_t, const uint32_t)
+) {
+    measure_calls(options, res, n, n * sizeof(*values),
+        [&options, values, n] () { prepare_caches(options.cache, values, n * sizeof(*values)); },
+        [values, n, stride, func] () { return func(values, n, stride); });
+}
 
 /** runs a benchmark on the passed function over the given values
  * and stores duration, throughput, result and mis in the struct measures.
  * mis is million values per second.
- * you pass the number of gigabytes that values contains for some reason.
+ * n has to fit the stride, see partition_values() in partition.cpp.
  * some functions take a stride argument, if yours doesn’t, a 0 should work fine.
- * flushes caches and TLB between every function execution, of which there are
- * ITERATIONS many. #defined in parameters.h
- * returns true if the result of the function matches the passed correct result,
- * else false.
+ * flushes caches and TLB (depending on options.cache) before every function
+ * execution, of which there are options.warmup + options.iterations many.
+ * returns true if the result of the function matches the passed correct result
+ * (compared as ResultT, i.e. wrapping like ResultT does, or in 64 bit for
+ * wide functions), else false.
  */
 template <class ResultT>
 bool benchmark(
+	const run_options& options,
 	measures* res,
 	uint64_t correct_result,
 	const ResultT* values,
 	uint64_t n,
 	const uint32_t stride,
-	double GB,
-	uint64_t (*func)(const ResultT*, uint64_t, const uint32_t)
+	uint64_t (*func)(const ResultT*, uint64_t, const uint32_t),
+	bool wide = false
 ) {
-
-    uint64_t duration = 0;
-    for (int i=0; i<ITERATIONS; i++) {
-        // flush all caches and TLB
-        // clean start setting
-        void flush_cache_all(void);
-        void flush_tlb_all(void);
-        auto begin = chrono::high_resolution_clock::now();
-        (*res).result =  func(values, n, stride);
-        auto end = std::chrono::high_resolution_clock::now();
-        duration += std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
-    }
-    (*res).duration = (double)duration/(double)ITERATIONS;
-    (*res).throughput = GB/((double)(*res).duration*1e-9);
-    (*res).mis = (n/1000000)/((double)duration/(double)((uint64_t)ITERATIONS*(uint64_t)1000000000));
-    if ((*res).result == correct_result) return true;
+    measure(options, res, values, n, stride, func);
+    if (wide) return (*res).result == correct_result;
+    if ((ResultT) (*res).result == (ResultT) correct_result) return true;
     else return false;
 }
 
+/** like benchmark, but for scatter functions, which write into values.
+ * values is overwritten with a poison pattern first, afterwards the sum over
+ * values has to match the checksum returned by func, which only happens if
+ * func actually wrote every position.
+ * both checksums are compared as ResultT, i.e. wrapping like ResultT does.
+ * returns true if they match, else false.
+ */
+template <class ResultT>
+bool benchmark_scatter(
+	const run_options& options,
+	measures* res,
+	ResultT* values,
+	uint64_t n,
+	const uint32_t stride,
+	scatter_function_t<ResultT> func
+) {
+    memset(values, 0xff, n * sizeof(ResultT));
+    measure(options, res, values, n, stride, func);
+    return (ResultT) (*res).result == (ResultT) aggregate_scalar(values, n);
+}
+
+/** like benchmark, but for lookup functions, which read the values at the
+ * number positions in index. mis is million lookups per second, throughput
+ * counts the looked up values (not the index).
+ * before every execution, values and index are brought into the cache state
+ * chosen in options.
+ * returns true if the result matches the one of lookup_scalar, else false.
+ */
+template <class ResultT, class IndexT>
+bool benchmark_lookup(
+	const run_options& options,
+	measures* res,
+	const ResultT* values,
+	uint64_t values_count,
+	const IndexT* index,
+	uint64_t number,
+	lookup_function_t<ResultT, IndexT> func
+) {
+    measure_calls(options, res, number, number * sizeof(ResultT),
+        [&options, values, values_count, index, number] () {
+            prepare_caches(options.cache, values, values_count * sizeof(ResultT), index, number * sizeof(IndexT));
+        },
+        [values, index, number, func] () { return func(values, index, number); });
+    return (ResultT) (*res).result == (ResultT) lookup_scalar(values, index, number);
+}
+
+/** like benchmark, but for group-by functions, which add the values (or
+ * count the keys, for histograms) into the buckets of keys. mis is million
+ * rows per second, throughput counts the values and keys read.
+ * before every execution, the buckets are zeroed, then they, values and
+ * keys are brought into the cache state chosen in options.
+ * returns true if the buckets end up like expected (and the result is the
+ * sum of the added values), else false.
+ */
+template <class ResultT>
+bool benchmark_groupby(
+	const run_options& options,
+	measures* res,
+	const ResultT* values,
+	const uint32_t* keys,
+	uint64_t number,
+	ResultT* buckets,
+	uint64_t bucket_count,
+	const std::vector< ResultT >& expected,
+	uint64_t expected_sum,
+	bool histogram,
+	groupby_function_t<ResultT> func
+) {
+    const uint64_t value_bytes = histogram ? 0 : number * sizeof(ResultT);
+    measure_calls(options, res, number, value_bytes + number * sizeof(uint32_t),
+        [&options, values, keys, number, buckets, bucket_count, value_bytes] () {
+            memset(buckets, 0, bucket_count * sizeof(ResultT));
+            prepare_caches(options.cache, buckets, bucket_count * sizeof(ResultT));
+            prepare_caches(options.cache, values, value_bytes, keys, number * sizeof(uint32_t));
+        },
+        [values, keys, number, buckets, bucket_count, func] () { return func(values, keys, number, buckets, bucket_count); });
+    return (ResultT) (*res).result == (ResultT) expected_sum
+        && memcmp(buckets, expected.data(), bucket_count * sizeof(ResultT)) == 0;
+}
+
+/** like benchmark, but for hash table probes, which look up the number
+ * keys in table. mis is million probes per second, throughput counts the
+ * keys read. before every execution, keys and table are brought into the
+ * cache state chosen in options.
+ * returns true if the result is the expected sum of the values found, else false.
+ */
+template <class ResultT>
+bool benchmark_probe(
+	const run_options& options,
+	measures* res,
+	const hash_table<ResultT>& table,
+	const ResultT* keys,
+	uint64_t number,
+	uint64_t expected,
+	probe_function_t<ResultT> func
+) {
+    const uint64_t table_bytes = table.slots() * sizeof(ResultT);
+    measure_calls(options, res, number, number * sizeof(ResultT),
+        [&options, &table, keys, number, table_bytes] () {
+            prepare_caches(options.cache, table.keys, table_bytes, table.values, table_bytes);
+            prepare_caches(options.cache, keys, number * sizeof(ResultT));
+        },
+        [&table, keys, number, func] () { return func(table, keys, number); });
+    return (ResultT) (*res).result == (ResultT) expected;
+}
+/** like benchmark, but for pointer chases, which follow lanes chains of the
+ * cycle from starts for hops dependent loads each. mis is million loads
+ * per second (of all chains), throughput counts the positions read.
+ * before every execution, the working set is brought into the caches (as
+ * far as it fits, whatever options.cache says): its size decides which
+ * level the chases measure the latency of.
+ * returns true if the chains end where expected, else false.
+ */
+template <class ResultT>
+bool benchmark_chase(
+	const run_options& options,
+	measures* res,
+	const chase_cycle<ResultT>& cycle,
+	const ResultT* starts,
+	uint64_t lanes,
+	uint64_t expected,
+	chase_function_t<ResultT> func
+) {
+    const uint64_t hops = options.hops;
+    measure_calls(options, res, hops * lanes, hops * lanes * sizeof(ResultT),
+        [&cycle] () { prepare_caches(CACHE_WARM, cycle.next, cycle.bytes); },
+        [&cycle, starts, hops, func] () { return func(cycle.next, starts, hops); });
+    return (ResultT) (*res).result == (ResultT) expected;
+}
 
 
 #endif // include guard BENCHMARK_SINGLE_THREADED_CPP
@@ -0,0 +1,168 @@
+#ifndef CACHE_CONTROL_CPP
+#define CACHE_CONTROL_CPP
+
+#include <cpuid.h>
+#include <immintrin.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <iostream>
+#include <string>
+
+#include "error_codes.h"
+
+/** the cache and TLB state every measured function execution starts in:
+ * cold: the data is flushed from all caches (clflushopt over the data)
+ *       and the TLB is thrashed by a walk over unrelated pages,
+ * warm: the data is touched right before, so it is cached as far as it fits,
+ * as_is: nothing happens in between, whatever the last execution left behind.
+ */
+enum cache_mode {
+	CACHE_COLD,
+	CACHE_WARM,
+	CACHE_AS_IS,
+};
+
+std::string cache_mode_name(cache_mode mode) {
+	switch (mode) {
+		case CACHE_COLD:  return "cold";
+		case CACHE_WARM:  return "warm";
+		case CACHE_AS_IS: return "as-is";
+	}
+	return "unknown";
+}
+
+/** sets mode according to name ("cold", "warm" or "as-is"),
+ * returns false (and leaves mode as it is) for an unknown name.
+ */
+bool parse_cache_mode(const std::string& name, cache_mode* mode) {
+	for (cache_mode candidate : { CACHE_COLD, CACHE_WARM, CACHE_AS_IS }) {
+		if (name == cache_mode_name(candidate)) {
+			*mode = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+constexpr uint64_t CACHE_LINE_BYTES = 64;
+constexpr uint64_t PAGE_BYTES = 4096;
+/** pages walked to evict the TLB, several times the number of
+ * second level TLB entries of current x86 cores (2048 on sapphire rapids).
+ */
+constexpr uint64_t TLB_THRASH_PAGES = 8192;
+
+bool cpu_has_clflushopt() {
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return false;
+	return ebx & bit_CLFLUSHOPT;
+}
+
+__attribute__((target("clflushopt")))
+void flush_lines_clflushopt(const char* begin, const char* end) {
+	for (const char* line = begin; line < end; line += CACHE_LINE_BYTES) {
+		_mm_clflushopt((void*) line);
+	}
+}
+
+void flush_lines_clflush(const char* begin, const char* end) {
+	for (const char* line = begin; line < end; line += CACHE_LINE_BYTES) {
+		_mm_clflush((void*) line);
+	}
+}
+
+/** writes back and evicts every cache line of [data, data + bytes)
+ * from all cache levels, with clflushopt if the cpu has it.
+ */
+void flush_range(const void* data, uint64_t bytes) {
+	static const bool clflushopt = cpu_has_clflushopt();
+	const char* begin = (const char*) ((uintptr_t) data & ~(CACHE_LINE_BYTES - 1));
+	const char* end = (const char*) data + bytes;
+	if (clflushopt) flush_lines_clflushopt(begin, end);
+	else flush_lines_clflush(begin, end);
+	_mm_mfence();
+}
+
+/** reads one cache line of each of TLB_THRASH_PAGES pages, which pushes
+ * the translations of the benchmark data out of the (calling core's) TLB.
+ * the pages are allocated once and shared by all threads. they are mapped
+ * on their own and excluded from transparent huge pages, which would cover
+ * them with a few translations and leave the TLB as it is.
+ * exits with NO_MEMORY if they cannot be mapped.
+ */
+void thrash_tlb() {
+	static volatile char* const pages = [] () {
+		void* mapped = mmap(NULL, TLB_THRASH_PAGES * PAGE_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mapped == MAP_FAILED) {
+			std::cerr << "could not map the pages of the TLB walk: " << strerror(errno) << std::endl;
+			exit(NO_MEMORY);
+		}
+		if (madvise(mapped, TLB_THRASH_PAGES * PAGE_BYTES, MADV_NOHUGEPAGE) != 0) {
+			std::cerr << "WARNING: the pages of the TLB walk may be transparent huge pages (" << strerror(errno)
+				<< "), --cache=cold may leave the TLB warm" << std::endl;
+		}
+		char* buffer = (char*) mapped;
+		for (uint64_t page = 0; page < TLB_THRASH_PAGES; page++) buffer[page * PAGE_BYTES] = 1;
+		return buffer;
+	}();
+	char sink = 0;
+	for (uint64_t page = 0; page < TLB_THRASH_PAGES; page++) {
+		// different line in every page, so the walk does not only hit one cache set
+		sink += pages[page * PAGE_BYTES + (page % (PAGE_BYTES / CACHE_LINE_BYTES)) * CACHE_LINE_BYTES];
+	}
+	(void) sink;
+}
+
+/** reads one value of every cache line of [data, data + bytes),
+ * so it is cached (and its pages are in the TLB) as far as it fits.
+ */
+void pretouch(const void* data, uint64_t bytes) {
+	const volatile char* begin = (const volatile char*) data;
+	char sink = 0;
+	for (uint64_t offset = 0; offset < bytes; offset += CACHE_LINE_BYTES) {
+		sink += begin[offset];
+	}
+	(void) sink;
+}
+
+/** brings caches and TLB of the calling core into the state mode describes
+ * for the bytes at data, which are what the next measurement accesses.
+ * flushing happens before the TLB walk, as clflushopt itself needs
+ * the translations of the flushed pages.
+ */
+void prepare_caches(cache_mode mode, const void* data, uint64_t bytes) {
+	switch (mode) {
+		case CACHE_COLD:
+			flush_range(data, bytes);
+			thrash_tlb();
+			break;
+		case CACHE_WARM:
+			pretouch(data, bytes);
+			break;
+		case CACHE_AS_IS:
+			break;
+	}
+}
+
+/** like prepare_caches, for measurements that access two ranges
+ * (e.g. the values and the index of lookups).
+ */
+void prepare_caches(cache_mode mode, const void* data, uint64_t bytes, const void* more_data, uint64_t more_bytes) {
+	switch (mode) {
+		case CACHE_COLD:
+			flush_range(data, bytes);
+			flush_range(more_data, more_bytes);
+			thrash_tlb();
+			break;
+		case CACHE_WARM:
+			pretouch(data, bytes);
+			pretouch(more_data, more_bytes);
+			break;
+		case CACHE_AS_IS:
+			break;
+	}
+}
+
+
+#endif // include guard CACHE_CONTROL_CPP
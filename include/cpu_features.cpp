@@ -0,0 +1,106 @@
+#ifndef CPU_FEATURES_CPP
+#define CPU_FEATURES_CPP
+
+#include <cpuid.h>
+#include <cstdint>
+#include <string>
+
+/** instruction set a kernel is compiled for (see kernel_registry.cpp),
+ * kernels only run if the cpu supports it.
+ * avx: AVX2 (256 bit vectors, gather, no scatter),
+ * avx512: AVX-512F, CD and VL.
+ */
+enum cpu_isa {
+	ISA_AVX,
+	ISA_AVX512,
+	NUMBER_OF_ISAS,
+};
+
+/** "avx" or "avx512", as in the names of result files and in --isas */
+std::string isa_name(cpu_isa isa) {
+	switch (isa) {
+		case ISA_AVX:    return "avx";
+		case ISA_AVX512: return "avx512";
+		default:         return "unknown";
+	}
+}
+
+/** sets isa according to name ("avx" or "avx512"),
+ * returns false (and leaves isa as it is) for an unknown name.
+ */
+bool parse_isa(const std::string& name, cpu_isa* isa) {
+	for (cpu_isa candidate : { ISA_AVX, ISA_AVX512 }) {
+		if (name == isa_name(candidate)) {
+			*isa = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+struct cpu_features {
+	bool avx2 = false;
+	bool avx512f = false;
+	bool avx512cd = false;
+	bool avx512vl = false;
+};
+
+/** XCR0, the register states the operating system saves on context switches */
+uint64_t read_xcr0() {
+	uint32_t eax, edx;
+	__asm__ volatile ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+	return ((uint64_t) edx << 32) | eax;
+}
+
+/** asks cpuid what the cpu can do and xgetbv whether the operating system
+ * saves the ymm (and opmask and zmm) registers, without which the
+ * instructions cannot be used either.
+ */
+cpu_features detect_cpu_features() {
+	cpu_features features;
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return features;
+	const bool osxsave = ecx & bit_OSXSAVE;
+	const bool avx = ecx & bit_AVX;
+	if (!osxsave || !avx) return features;
+
+	const uint64_t xcr0 = read_xcr0();
+	const bool ymm_saved = (xcr0 & 0x6) == 0x6;    // sse and avx state
+	const bool zmm_saved = (xcr0 & 0xe6) == 0xe6;  // plus opmask, upper zmm0-15 and zmm16-31
+	if (!ymm_saved || !__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return features;
+
+	features.avx2 = ebx & bit_AVX2;
+	features.avx512f = zmm_saved && (ebx & bit_AVX512F);
+	features.avx512cd = zmm_saved && (ebx & bit_AVX512CD);
+	features.avx512vl = zmm_saved && (ebx & bit_AVX512VL);
+	return features;
+}
+
+/** the features of this cpu, detected on first use */
+const cpu_features& host_cpu_features() {
+	static const cpu_features features = detect_cpu_features();
+	return features;
+}
+
+bool isa_supported(cpu_isa isa) {
+	const cpu_features& features = host_cpu_features();
+	switch (isa) {
+		case ISA_AVX:    return features.avx2;
+		case ISA_AVX512: return features.avx512f && features.avx512cd && features.avx512vl;
+		default:         return false;
+	}
+}
+
+/** e.g. "avx2 avx512f avx512cd avx512vl", for the log */
+std::string cpu_features_description() {
+	const cpu_features& features = host_cpu_features();
+	std::string result = "";
+	if (features.avx2)     result += " avx2";
+	if (features.avx512f)  result += " avx512f";
+	if (features.avx512cd) result += " avx512cd";
+	if (features.avx512vl) result += " avx512vl";
+	return result.empty() ? "none" : result.substr(1);
+}
+
+
+#endif // include guard CPU_FEATURES_CPP
@@ -0,0 +1,158 @@
+#ifndef CPU_TOPOLOGY_CPP
+#define CPU_TOPOLOGY_CPP
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/** which cpus the workers of the multi threaded benchmark are pinned to,
+ * worker after worker, among the cpus the process may run on (see
+ * available_cpus), after their place in /sys/devices/system/cpu:
+ * compact: one socket after the other, on each the first hardware thread
+ *   of every physical core before any of their smt siblings,
+ * scatter: round robin over the sockets, the first hardware thread of
+ *   every physical core before any of their smt siblings,
+ * cores: only the first hardware thread of every physical core, socket
+ *   after socket, so there are at most as many workers as cores,
+ * smt-pairs: all hardware threads of a physical core next to each other,
+ *   core after core, socket after socket,
+ * list: the cpus given (--pinning=<list>), in their order.
+ * the background workers (see --background) get the cpus after the
+ * measured ones.
+ */
+enum pinning_policy {
+	PINNING_COMPACT,
+	PINNING_SCATTER,
+	PINNING_CORES,
+	PINNING_SMT_PAIRS,
+	PINNING_LIST,
+};
+
+std::string pinning_policy_name(pinning_policy policy) {
+	switch (policy) {
+		case PINNING_COMPACT:   return "compact";
+		case PINNING_SCATTER:   return "scatter";
+		case PINNING_CORES:     return "cores";
+		case PINNING_SMT_PAIRS: return "smt-pairs";
+		case PINNING_LIST:      return "list";
+	}
+	return "unknown";
+}
+
+/** sets policy according to name ("compact", "scatter", "cores" or
+ * "smt-pairs", a list is no name), returns false (and leaves policy as it
+ * is) for an unknown name.
+ */
+bool parse_pinning_policy(const std::string& name, pinning_policy* policy) {
+	for (pinning_policy candidate : { PINNING_COMPACT, PINNING_SCATTER, PINNING_CORES, PINNING_SMT_PAIRS }) {
+		if (name == pinning_policy_name(candidate)) {
+			*policy = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+/** where a cpu is: its socket (physical package), its physical core (ids
+ * as in /sys, core is only unique within the package) and which of the
+ * core's hardware threads it is (0 for the first one).
+ */
+struct cpu_location {
+	uint64_t cpu;
+	uint64_t package;
+	uint64_t core;
+	uint64_t thread;
+};
+
+/** the number in /sys/devices/system/cpu/cpu<cpu>/topology/<name>,
+ * fallback if there is none.
+ */
+uint64_t topology_value(uint64_t cpu, const std::string& name, uint64_t fallback) {
+	std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + name);
+	int64_t value;
+	if (!(file >> value) || value < 0) return fallback;
+	return (uint64_t) value;
+}
+
+/** the locations of cpus, in the order of cpus. the hardware threads of a
+ * core are numbered in the order of their cpu numbers. without topology in
+ * /sys, every cpu is a core of its own on socket 0.
+ */
+std::vector< cpu_location > cpu_locations(const std::vector< uint64_t >& cpus) {
+	std::vector< cpu_location > locations;
+	for (uint64_t cpu : cpus) {
+		locations.push_back({ cpu, topology_value(cpu, "physical_package_id", 0), topology_value(cpu, "core_id", cpu), 0 });
+	}
+	for (cpu_location& location : locations) {
+		for (const cpu_location& other : locations) {
+			if (other.package == location.package && other.core == location.core && other.cpu < location.cpu) location.thread++;
+		}
+	}
+	return locations;
+}
+
+/** the cpus of locations in the order policy (not PINNING_LIST) gives
+ * them to the workers, see pinning_policy.
+ */
+std::vector< uint64_t > pinning_order(pinning_policy policy, std::vector< cpu_location > locations) {
+	if (policy == PINNING_CORES) {
+		locations.erase(std::remove_if(locations.begin(), locations.end(),
+			[] (const cpu_location& location) { return location.thread != 0; }), locations.end());
+	}
+	std::sort(locations.begin(), locations.end(), [policy] (const cpu_location& a, const cpu_location& b) {
+		if (policy == PINNING_SMT_PAIRS) return std::tie(a.package, a.core, a.thread) < std::tie(b.package, b.core, b.thread);
+		return std::tie(a.package, a.thread, a.core, a.cpu) < std::tie(b.package, b.thread, b.core, b.cpu);
+	});
+
+	std::vector< uint64_t > order;
+	if (policy != PINNING_SCATTER) {
+		for (const cpu_location& location : locations) order.push_back(location.cpu);
+		return order;
+	}
+	// the sockets' cpus in compact order, then one of each socket in turn
+	std::vector< std::vector< uint64_t > > sockets;
+	for (size_t l = 0; l < locations.size(); l++) {
+		if (l == 0 || locations[l].package != locations[l - 1].package) sockets.emplace_back();
+		sockets.back().push_back(locations[l].cpu);
+	}
+	for (size_t round = 0; order.size() < locations.size(); round++) {
+		for (const std::vector< uint64_t >& socket : sockets) {
+			if (round < socket.size()) order.push_back(socket[round]);
+		}
+	}
+	return order;
+}
+
+/** the cpus the first number workers are pinned to: the ones of list for
+ * PINNING_LIST, else the available ones (where the process may run) in the
+ * order of policy. empty if there are fewer than number.
+ */
+std::vector< uint64_t > worker_cpus(
+	pinning_policy policy,
+	const std::vector< uint64_t >& list,
+	const std::vector< uint64_t >& available,
+	uint64_t number
+) {
+	std::vector< uint64_t > cpus = policy == PINNING_LIST ? list : pinning_order(policy, cpu_locations(available));
+	if (cpus.size() < number) return {};
+	cpus.resize(number);
+	return cpus;
+}
+
+/** cpus as a list like "0-3,8,10-11" (as --pinning takes it) */
+std::string cpu_list_name(const std::vector< uint64_t >& cpus) {
+	std::string name = "";
+	for (size_t c = 0; c < cpus.size(); c++) {
+		size_t last = c;
+		while (last + 1 < cpus.size() && cpus[last + 1] == cpus[last] + 1) last++;
+		name += (c == 0 ? "" : ",") + std::to_string(cpus[c]);
+		if (last > c) name += (last == c + 1 ? "," : "-") + std::to_string(cpus[last]);
+		c = last;
+	}
+	return name;
+}
+
+
+#endif // include guard CPU_TOPOLOGY_CPP
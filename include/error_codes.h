@@ -9,6 +9,10 @@ enum gather_error_codes {
 	DATA_SIZE_TOO_LOW = 2,
 	RESULT_FILE_NOT_OPENED = 3,
 	NO_MEMORY = 4,
+	PINNING_FAILED = 5,
+	NOT_ENOUGH_THREADS = 6,
+	INVALID_OPTION = 7,
+	REGRESSION_DETECTED = 8,
 };
 
 #endif // include guard GATHER_ERROR_CODES_H
@@ -19,4 +19,16 @@ uint64_t aggregate_scalar(const uint32_t* array, uint64_t number, const uint32_t
 	return res;
 }
 
+/** the sum in 64 bit, for 32 bit values without wrapping like
+ * aggregate_scalar, the reference of the wide kernels (aggregator.wide).
+ */
+template <class ResultT>
+inline
+uint64_t aggregate_scalar_wide(const ResultT* array, uint64_t number, const uint32_t stride=0) {
+	uint64_t res = 0;
+	for (uint64_t i = 0; i < number; i++)
+		res += array[i];
+	return res;
+}
+
 #endif // include guard AGGREGATE_SCALAR_CPP
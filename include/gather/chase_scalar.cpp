@@ -0,0 +1,18 @@
+#ifndef CHASE_SCALAR_CPP
+#define CHASE_SCALAR_CPP
+
+#include <cstdint>
+
+/** scalar pointer chase: hops dependent loads along next, from starts[0]
+ * on (next holds a cycle, see build_chase_cycle). returns the position it
+ * ends at, so the loads cannot be left out.
+ */
+template <class ResultT>
+uint64_t chase_scalar(const ResultT* next, const ResultT* starts, uint64_t hops) {
+	ResultT position = starts[0];
+	for (uint64_t h = 0; h < hops; h++) position = next[position];
+	return position;
+}
+
+
+#endif // include guard CHASE_SCALAR_CPP
@@ -0,0 +1,67 @@
+#ifndef GROUPBY_SCALAR_CPP
+#define GROUPBY_SCALAR_CPP
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/** scalar group-by sum, one bucket update at a time (Histogram: counts
+ * the keys, values are not read). returns the sum of the added values.
+ */
+template <bool Histogram, class ResultT>
+uint64_t groupby_scalar(const ResultT* values, const uint32_t* keys, uint64_t number, ResultT* buckets, uint64_t bucket_count) {
+	ResultT sum = 0;
+	for (uint64_t i = 0; i < number; i++) {
+		const ResultT value = Histogram ? 1 : values[i];
+		buckets[keys[i]] += value;
+		sum += value;
+	}
+	return sum;
+}
+
+/** like groupby_scalar, but the updates are atomic, so all threads can
+ * add into one table (see groupby_kernel.shared).
+ */
+template <bool Histogram, class ResultT>
+uint64_t groupby_atomic(const ResultT* values, const uint32_t* keys, uint64_t number, ResultT* buckets, uint64_t bucket_count) {
+	ResultT sum = 0;
+	for (uint64_t i = 0; i < number; i++) {
+		const ResultT value = Histogram ? 1 : values[i];
+		__atomic_fetch_add(&buckets[keys[i]], value, __ATOMIC_RELAXED);
+		sum += value;
+	}
+	return sum;
+}
+
+/** sort based group-by: copies the (key, value) pairs (only the keys for
+ * histograms), sorts them by key and adds every run of equal keys with
+ * one bucket update. the copy (and its allocation) is part of the cost.
+ */
+template <bool Histogram, class ResultT>
+uint64_t groupby_sort(const ResultT* values, const uint32_t* keys, uint64_t number, ResultT* buckets, uint64_t bucket_count) {
+	ResultT sum = 0;
+	if (Histogram) {
+		std::vector< uint32_t > sorted(keys, keys + number);
+		std::sort(sorted.begin(), sorted.end());
+		for (uint64_t i = 0, end; i < number; i = end) {
+			for (end = i + 1; end < number && sorted[end] == sorted[i]; end++) {}
+			buckets[sorted[i]] += (ResultT) (end - i);
+			sum += (ResultT) (end - i);
+		}
+		return sum;
+	}
+	std::vector< std::pair< uint32_t, ResultT > > sorted(number);
+	for (uint64_t i = 0; i < number; i++) sorted[i] = { keys[i], values[i] };
+	std::sort(sorted.begin(), sorted.end(),
+		[] (const std::pair< uint32_t, ResultT >& a, const std::pair< uint32_t, ResultT >& b) { return a.first < b.first; });
+	for (uint64_t i = 0, end; i < number; i = end) {
+		ResultT run = sorted[i].second;
+		for (end = i + 1; end < number && sorted[end].first == sorted[i].first; end++) run += sorted[end].second;
+		buckets[sorted[i].first] += run;
+		sum += run;
+	}
+	return sum;
+}
+
+#endif // include guard GROUPBY_SCALAR_CPP
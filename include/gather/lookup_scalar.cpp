@@ -0,0 +1,19 @@
+#ifndef LOOKUP_SCALAR_CPP
+#define LOOKUP_SCALAR_CPP
+
+#include <cstdint>
+
+/** scalar lookup variant, sums up the values at the positions in index
+ * (e.g. foreign key lookups or late materialization), one load at a time.
+ * IndexT is uint32_t or uint64_t. the sum wraps like ResultT.
+ */
+template <class ResultT, class IndexT>
+uint64_t lookup_scalar(const ResultT* array, const IndexT* index, uint64_t number) {
+	ResultT res = 0;
+	for (uint64_t i = 0; i < number; i++) {
+		res += array[index[i]];
+	}
+	return res;
+}
+
+#endif // include guard LOOKUP_SCALAR_CPP
@@ -0,0 +1,64 @@
+#ifndef PREFETCH_CPP
+#define PREFETCH_CPP
+
+#include <immintrin.h>
+#include <cstdint>
+
+constexpr uint64_t DEFAULT_PREFETCH_DISTANCE = 8;
+
+/** how many gathers ahead the prefetching kernels prefetch, set by the
+ * harness before each measurement (see --prefetch-distances).
+ */
+uint64_t prefetch_distance = DEFAULT_PREFETCH_DISTANCE;
+
+/** position of a gather in the loops of the strided kernels (blocks of
+ * lanes * stride values, stride gathers per block), run ahead of the
+ * current gather to know what to prefetch. positions past the end of the
+ * array are prefetched too, prefetches do not fault.
+ */
+template <class ResultT>
+struct strided_cursor {
+	uint64_t block;        // first value of the block
+	uint64_t offset;       // gather within the block, < stride
+	uint64_t stride;
+	uint64_t block_values;
+
+	strided_cursor(uint32_t stride, uint64_t lanes, uint64_t gathers_ahead) :
+		block(gathers_ahead / stride * lanes * stride),
+		offset(gathers_ahead % stride),
+		stride(stride),
+		block_values(lanes * stride)
+	{}
+
+	void next() {
+		if (++offset == stride) {
+			offset = 0;
+			block += block_values;
+		}
+	}
+
+	/** whether the lanes of this gather start new cache lines,
+	 * each line of a lane is prefetched once then.
+	 */
+	bool new_lines() const {
+		return offset % (64 / sizeof(ResultT)) == 0;
+	}
+
+	template <_mm_hint Hint>
+	void prefetch(const ResultT* array, uint64_t lanes) const {
+		for (uint64_t lane = 0; lane < lanes; lane++) {
+			_mm_prefetch(reinterpret_cast<const char *> (&array[block + offset + lane * stride]), Hint);
+		}
+	}
+};
+
+/** prefetches the values at the lanes positions in index with Hint */
+template <_mm_hint Hint, class ResultT, class IndexT>
+inline void prefetch_positions(const ResultT* array, const IndexT* index, uint64_t lanes) {
+	for (uint64_t lane = 0; lane < lanes; lane++) {
+		_mm_prefetch(reinterpret_cast<const char *> (&array[index[lane]]), Hint);
+	}
+}
+
+
+#endif // include guard PREFETCH_CPP
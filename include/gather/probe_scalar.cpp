@@ -0,0 +1,34 @@
+#ifndef PROBE_SCALAR_CPP
+#define PROBE_SCALAR_CPP
+
+#include <cstdint>
+
+#include "hash_table.h"
+
+/** searches key in table from slot on, returns its value, 0 if it is not
+ * in the table. the vector kernels finish the probes of their lanes with it.
+ */
+template <class ResultT>
+inline ResultT probe_from(const hash_table<ResultT>& table, ResultT key, uint64_t slot) {
+	const uint64_t slot_mask = table.slots() - 1;
+	for (;; slot = (slot + 1) & slot_mask) {
+		const ResultT found = table.keys[slot];
+		if (found == key) return table.values[slot];
+		if (found == 0) return 0;
+	}
+}
+
+/** scalar hash table probe, one key after the other.
+ * returns the sum of the values of the keys found (wrapping like ResultT).
+ */
+template <class ResultT>
+uint64_t probe_scalar(const hash_table<ResultT>& table, const ResultT* keys, uint64_t number) {
+	ResultT sum = 0;
+	for (uint64_t i = 0; i < number; i++) {
+		sum += probe_from(table, keys[i], probe_start(keys[i], table.slots_log2, table.bucket_log2));
+	}
+	return sum;
+}
+
+
+#endif // include guard PROBE_SCALAR_CPP
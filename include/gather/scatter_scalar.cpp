@@ -0,0 +1,27 @@
+#ifndef SCATTER_SCALAR_CPP
+#define SCATTER_SCALAR_CPP
+
+#include <cstdint>
+
+/** scalar strided store variant, writes in the same order as the
+ * vector scatter variants with the given number of lanes,
+ * but one value per store instruction.
+ * every position gets its own index (relative to array) written into it,
+ * the sum of these is returned for checksumming.
+ */
+template <uint32_t lanes, class ResultT>
+uint64_t scatter_strided_scalar(ResultT* array, uint64_t number, const uint32_t stride) {
+	uint64_t res = 0;
+	for (uint64_t j = 0; j < number; j += lanes * stride) {
+		for (uint64_t i = 0; i < stride; i++) {
+			for (uint64_t l = 0; l < lanes; l++) {
+				const uint64_t position = j + i + l * stride;
+				array[position] = (ResultT) position;
+				res += (ResultT) position;
+			}
+		}
+	}
+	return res;
+}
+
+#endif // include guard SCATTER_SCALAR_CPP
@@ -6,6 +6,13 @@
 #include <cstdint>
 
 #include "gather/aggregate_scalar.cpp"
+#include "gather/scatter_scalar.cpp"
+#include "gather/lookup_scalar.cpp"
+#include "gather/probe_scalar.cpp"
+#include "gather/chase_scalar.cpp"
+#include "gather/prefetch.cpp"
+#include "gather/unroll.cpp"
+#include "gather/static_strides.cpp"
 
 /**
  * @brief linear load avx512 variant
@@ -20,7 +27,7 @@ uint64_t aggregate_stream_linear_avx256(const uint32_t* array, uint64_t number,
   uint64_t r = 0;
 
   tmp = _mm256_setzero_si256();
-  for (int i = 0; i < number - 8 + 1; i += 8) {
+  for (uint64_t i = 0; i + 8 <= number; i += 8) {
     data = _mm256_stream_load_si256(reinterpret_cast<const __m256i *> (&array[i]));
 
     tmp = _mm256_add_epi32(data, tmp);
@@ -46,7 +53,7 @@ uint64_t aggregate_linear_avx256(const uint32_t* array, uint64_t number, const u
   uint64_t r = 0;
 
   tmp = _mm256_setzero_si256();
-  for (int i = 0; i < number - 8 + 1; i += 8) {
+  for (uint64_t i = 0; i + 8 <= number; i += 8) {
     data = _mm256_load_si256(reinterpret_cast<const __m256i *> (&array[i]));
     tmp = _mm256_add_epi32(data, tmp);
   }
@@ -76,8 +83,8 @@ uint64_t aggregate_strided_gather_avx256(const uint32_t* array, uint64_t number,
 
   const __m256i gatherindex = _mm256_set_epi32(7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
 
-  for (int j = 0; j < number; j += 8 * stride) {
-    for (int i = 0; i < stride; i++) {
+  for (uint64_t j = 0; j < number; j += 8 * stride) {
+    for (uint32_t i = 0; i < stride; i++) {
       data = _mm256_i32gather_epi32(reinterpret_cast<int const *> (&array[j + i]), gatherindex, 4);
       tmp = _mm256_add_epi32(data, tmp);
     }
@@ -103,8 +110,8 @@ uint64_t aggregate_strided_set_avx256(const uint32_t* array, uint64_t number, co
 
   tmp = _mm256_setzero_si256();
 
-  for (int j = 0; j < number; j += 8 * stride) {
-    for (int i = 0; i < stride; i++) {
+  for (uint64_t j = 0; j < number; j += 8 * stride) {
+    for (uint32_t i = 0; i < stride; i++) {
 			data = _mm256_set_epi32(array[j+i+7*stride],array[j+i+6*stride],array[j+i+5*stride],array[j+i+4*stride],array[j+i+3*stride],array[j+i+2*stride],array[j+i+stride],array[j+i]);
       tmp = _mm256_add_epi32(data, tmp);
     }
@@ -118,4 +125,750 @@ uint64_t aggregate_strided_set_avx256(const uint32_t* array, uint64_t number, co
 }
 
 
+
+/**
+ * @brief avx256 linear load variant that sums up in 64 bit
+ *
+ * the 8 values of every load are widened (cvtepu32_epi64) into two
+ * accumulators of 4 64 bit lanes, so the sum does not wrap at 2^32.
+ *
+ * @param array
+ * @param number
+ * @return uint64_t
+ */
+uint64_t aggregate_linear_wide_avx256(const uint32_t* array, uint64_t number, const uint32_t stride=0) {
+  __m256i low, high, data;
+
+  low = _mm256_setzero_si256();
+  high = _mm256_setzero_si256();
+  for (uint64_t i = 0; i + 8 <= number; i += 8) {
+    data = _mm256_load_si256(reinterpret_cast<const __m256i *> (&array[i]));
+    low = _mm256_add_epi64(_mm256_cvtepu32_epi64(_mm256_castsi256_si128(data)), low);
+    high = _mm256_add_epi64(_mm256_cvtepu32_epi64(_mm256_extracti128_si256(data, 1)), high);
+  }
+
+  low = _mm256_add_epi64(low, high);
+  uint64_t res = 0;
+  for (int i = 0; i < 4; i++)
+    res += _mm256_extract_epi64(low, i);
+
+  return res;
+}
+
+/**
+ * @brief avx256 strided access variant using gather instruction that sums up in 64 bit
+ *
+ * gathers like aggregate_strided_gather_avx256 and widens the values like
+ * aggregate_linear_wide_avx256.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+uint64_t aggregate_strided_gather_wide_avx256(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  __m256i low, high, data;
+
+  low = _mm256_setzero_si256();
+  high = _mm256_setzero_si256();
+
+  const __m256i gatherindex = _mm256_set_epi32(7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
+
+  for (uint64_t j = 0; j < number; j += 8 * stride) {
+    for (uint32_t i = 0; i < stride; i++) {
+      data = _mm256_i32gather_epi32(reinterpret_cast<int const *> (&array[j + i]), gatherindex, 4);
+      low = _mm256_add_epi64(_mm256_cvtepu32_epi64(_mm256_castsi256_si128(data)), low);
+      high = _mm256_add_epi64(_mm256_cvtepu32_epi64(_mm256_extracti128_si256(data, 1)), high);
+    }
+  }
+
+  low = _mm256_add_epi64(low, high);
+  uint64_t res = 0;
+  for (int i = 0; i < 4; i++)
+    res += _mm256_extract_epi64(low, i);
+
+  return res;
+}
+
+/**
+ * @brief avx256 strided access variant using gather instruction with 64 bit offsets
+ *
+ * like aggregate_strided_gather_avx256, but with 64 bit lane offsets (i64gather),
+ * to compare what the wider index costs: two gathers of 4 lanes per 8 values
+ * (an index vector holds 4 offsets).
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+uint64_t aggregate_strided_gather_i64_avx256(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  __m128i tmp, low, high;
+
+  tmp = _mm_setzero_si128();
+
+  const uint64_t s = stride;
+  const __m256i lowindex = _mm256_set_epi64x(3 * s, 2 * s, s, 0);
+  const __m256i highindex = _mm256_set_epi64x(7 * s, 6 * s, 5 * s, 4 * s);
+
+  for (uint64_t j = 0; j < number; j += 8 * s) {
+    for (uint32_t i = 0; i < stride; i++) {
+      low = _mm256_i64gather_epi32(reinterpret_cast<int const *> (&array[j + i]), lowindex, 4);
+      high = _mm256_i64gather_epi32(reinterpret_cast<int const *> (&array[j + i]), highindex, 4);
+      tmp = _mm_add_epi32(_mm_add_epi32(low, high), tmp);
+    }
+  }
+
+  uint64_t res = 0;
+  for (int i = 0; i < 4; i++)
+    res += (uint32_t) _mm_extract_epi32(tmp, i);
+
+  return (uint32_t) res;
+}
+
+/**
+ * @brief avx256 linear load variant for any number of values
+ *
+ * unaligned loads, the last (partial) vector is loaded with a mask,
+ * so no value is left out.
+ *
+ * @param array
+ * @param number
+ * @return uint64_t
+ */
+uint64_t aggregate_linear_masked_avx256(const uint32_t* array, uint64_t number, const uint32_t stride=0) {
+  __m256i tmp, data;
+
+  tmp = _mm256_setzero_si256();
+  uint64_t i = 0;
+  for (; i + 8 <= number; i += 8) {
+    data = _mm256_loadu_si256(reinterpret_cast<const __m256i *> (&array[i]));
+    tmp = _mm256_add_epi32(data, tmp);
+  }
+  if (i < number) {
+    const __m256i valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(number - i), _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    data = _mm256_maskload_epi32(reinterpret_cast<int const *> (&array[i]), valid);
+    tmp = _mm256_add_epi32(data, tmp);
+  }
+
+  uint64_t res = 0;
+  for (int i= 0; i<8; i++)
+    res += _mm256_extract_epi32(tmp,i);
+
+  return res;
+}
+
+/**
+ * @brief avx256 strided access variant using gather instruction, for any number of values
+ *
+ * like the variant without mask for the whole blocks of lanes * stride
+ * values, the last (partial) block is gathered with masks that leave out
+ * the lanes at or past number, so no value is left out (or read past the end).
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+uint64_t aggregate_strided_gather_masked_avx256(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  __m256i tmp, data;
+
+  tmp = _mm256_setzero_si256();
+
+  const __m256i gatherindex = _mm256_set_epi32(7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
+  const uint64_t block = 8 * (uint64_t) stride;
+  const uint64_t whole = number / block * block;
+
+  for (uint64_t j = 0; j < whole; j += block) {
+    for (uint32_t i = 0; i < stride; i++) {
+      data = _mm256_i32gather_epi32(reinterpret_cast<int const *> (&array[j + i]), gatherindex, 4);
+      tmp = _mm256_add_epi32(data, tmp);
+    }
+  }
+
+  // lane k of gather i reads whole + i + k * stride, if that is below number
+  const uint64_t rest = number - whole;
+  for (uint32_t i = 0; i < stride && i < rest; i++) {
+    const __m256i valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(rest - i), gatherindex);
+    data = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), reinterpret_cast<int const *> (&array[whole + i]), gatherindex, valid, 4);
+    tmp = _mm256_add_epi32(data, tmp);
+  }
+
+  uint64_t res = 0;
+  for (int i= 0; i<8; i++)
+    res += _mm256_extract_epi32(tmp,i);
+
+  return res;
+}
+
+/**
+ * @brief avx256 strided access variant using gather instruction, for a fixed stride
+ *
+ * like the variant with a run time stride, but the stride is a template
+ * argument, so the index vector is a constant and the compiler knows the
+ * trip count of the inner loop (and may unroll it).
+ *
+ * @param array
+ * @param number
+ * @param stride (ignored, Stride is used)
+ * @return uint64_t
+ */
+template <uint32_t Stride>
+uint64_t aggregate_strided_gather_static_avx256(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  __m256i tmp, data;
+
+  tmp = _mm256_setzero_si256();
+
+  const __m256i gatherindex = _mm256_set_epi32(7 * Stride, 6 * Stride, 5 * Stride, 4 * Stride, 3 * Stride, 2 * Stride, Stride, 0);
+
+  for (uint64_t j = 0; j < number; j += 8 * Stride) {
+    for (uint32_t i = 0; i < Stride; i++) {
+      data = _mm256_i32gather_epi32(reinterpret_cast<int const *> (&array[j + i]), gatherindex, 4);
+      tmp = _mm256_add_epi32(data, tmp);
+    }
+  }
+
+  uint64_t res = 0;
+  for (int i= 0; i<8; i++)
+    res += _mm256_extract_epi32(tmp,i);
+
+  return res;
+}
+
+/**
+ * @brief avx256 strided access variant using gather instruction, dispatched to a fixed stride
+ *
+ * calls the instantiation for stride (see static_strides.cpp) through a
+ * jump table, the variant with a run time stride if there is none.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+template <uint32_t... Strides>
+uint64_t aggregate_strided_gather_static_avx256(const uint32_t* array, uint64_t number, const uint32_t stride, std::integer_sequence<uint32_t, Strides...>) {
+  static uint64_t (* const table[])(const uint32_t*, uint64_t, const uint32_t) = { aggregate_strided_gather_static_avx256<Strides>... };
+
+  const int slot = static_stride_slot(stride);
+  if (slot < 0) return aggregate_strided_gather_avx256(array, number, stride);
+  return table[slot](array, number, stride);
+}
+
+uint64_t aggregate_strided_gather_static_avx256(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  return aggregate_strided_gather_static_avx256(array, number, stride, static_strides());
+}
+
+/**
+ * @brief avx/avx2 strided access variant using set instruction, for a fixed stride
+ *
+ * like the variant with a run time stride, but the stride is a template
+ * argument, so the index vector is a constant and the compiler knows the
+ * trip count of the inner loop (and may unroll it).
+ *
+ * @param array
+ * @param number
+ * @param stride (ignored, Stride is used)
+ * @return uint64_t
+ */
+template <uint32_t Stride>
+uint64_t aggregate_strided_set_static_avx256(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  __m256i tmp, data;
+
+  tmp = _mm256_setzero_si256();
+
+  for (uint64_t j = 0; j < number; j += 8 * Stride) {
+    for (uint32_t i = 0; i < Stride; i++) {
+			data = _mm256_set_epi32(array[j+i+7*Stride],array[j+i+6*Stride],array[j+i+5*Stride],array[j+i+4*Stride],array[j+i+3*Stride],array[j+i+2*Stride],array[j+i+Stride],array[j+i]);
+      tmp = _mm256_add_epi32(data, tmp);
+    }
+  }
+
+  uint64_t res = 0;
+  for (int i= 0; i<8; i++)
+    res += _mm256_extract_epi32(tmp,i);
+
+  return res;
+}
+
+/**
+ * @brief avx/avx2 strided access variant using set instruction, dispatched to a fixed stride
+ *
+ * calls the instantiation for stride (see static_strides.cpp) through a
+ * jump table, the variant with a run time stride if there is none.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+template <uint32_t... Strides>
+uint64_t aggregate_strided_set_static_avx256(const uint32_t* array, uint64_t number, const uint32_t stride, std::integer_sequence<uint32_t, Strides...>) {
+  static uint64_t (* const table[])(const uint32_t*, uint64_t, const uint32_t) = { aggregate_strided_set_static_avx256<Strides>... };
+
+  const int slot = static_stride_slot(stride);
+  if (slot < 0) return aggregate_strided_set_avx256(array, number, stride);
+  return table[slot](array, number, stride);
+}
+
+uint64_t aggregate_strided_set_static_avx256(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  return aggregate_strided_set_static_avx256(array, number, stride, static_strides());
+}
+
+/**
+ * @brief avx256 strided access variant using gather instruction, unrolled
+ *
+ * like the variant without unrolling, but issues Unroll gathers per loop
+ * iteration and adds them into Accumulators independent registers
+ * (round robin, Unroll has to be a multiple), so the adds do not form a
+ * single dependency chain. strides that are no multiple of Unroll get
+ * their remaining gathers one by one.
+ * flatten: see unrolled in unroll.cpp.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+template <unsigned Unroll, unsigned Accumulators>
+__attribute__((flatten))
+uint64_t aggregate_strided_gather_unrolled_avx256(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  static_assert(Unroll % Accumulators == 0, "Unroll has to be a multiple of Accumulators");
+  __m256i tmp[Accumulators] = {};
+
+  const __m256i gatherindex = _mm256_set_epi32(7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
+
+  for (uint64_t j = 0; j < number; j += 8 * stride) {
+    uint64_t i = 0;
+    for (; i + Unroll <= stride; i += Unroll) {
+      unrolled<Unroll>([&] (auto u) {
+        constexpr unsigned a = decltype(u)::value % Accumulators;
+        tmp[a] = _mm256_add_epi32(_mm256_i32gather_epi32(reinterpret_cast<int const *> (&array[j + i + decltype(u)::value]), gatherindex, 4), tmp[a]);
+      });
+    }
+    for (; i < stride; i++) {
+      tmp[0] = _mm256_add_epi32(_mm256_i32gather_epi32(reinterpret_cast<int const *> (&array[j + i]), gatherindex, 4), tmp[0]);
+    }
+  }
+
+  unrolled<Accumulators - 1>([&] (auto a) { tmp[0] = _mm256_add_epi32(tmp[decltype(a)::value + 1], tmp[0]); });
+
+  uint64_t res = 0;
+  for (int i= 0; i<8; i++)
+    res += _mm256_extract_epi32(tmp[0],i);
+
+  return res;
+}
+
+/**
+ * @brief avx256 strided access variant using gather instruction and software prefetching
+ *
+ * like the variant without prefetching, but prefetches the lanes of the gather
+ * prefetch_distance gathers ahead (once per cache line) with Hint:
+ * _MM_HINT_T0, _MM_HINT_T1 or _MM_HINT_NTA.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+template <_mm_hint Hint>
+uint64_t aggregate_strided_gather_prefetch_avx256(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  __m256i tmp, data;
+
+  tmp = _mm256_setzero_si256();
+
+  const __m256i gatherindex = _mm256_set_epi32(7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
+  strided_cursor<uint32_t> ahead(stride, 8, prefetch_distance);
+
+  for (uint64_t j = 0; j < number; j += 8 * stride) {
+    for (uint64_t i = 0; i < stride; i++) {
+      if (ahead.new_lines()) ahead.prefetch<Hint>(array, 8);
+      ahead.next();
+      data = _mm256_i32gather_epi32(reinterpret_cast<int const *> (&array[j + i]), gatherindex, 4);
+      tmp = _mm256_add_epi32(data, tmp);
+    }
+  }
+
+  uint64_t res = 0;
+  for (int i= 0; i<8; i++)
+    res += _mm256_extract_epi32(tmp,i);
+
+  return res;
+}
+
+/**
+ * @brief avx/avx2 strided access variant using set instruction and software prefetching
+ *
+ * like the variant without prefetching, but prefetches the lanes of the gather
+ * prefetch_distance gathers ahead (once per cache line) with Hint:
+ * _MM_HINT_T0, _MM_HINT_T1 or _MM_HINT_NTA.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+template <_mm_hint Hint>
+uint64_t aggregate_strided_set_prefetch_avx256(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  __m256i tmp, data;
+
+  tmp = _mm256_setzero_si256();
+  strided_cursor<uint32_t> ahead(stride, 8, prefetch_distance);
+
+  for (uint64_t j = 0; j < number; j += 8 * stride) {
+    for (uint64_t i = 0; i < stride; i++) {
+      if (ahead.new_lines()) ahead.prefetch<Hint>(array, 8);
+      ahead.next();
+			data = _mm256_set_epi32(array[j+i+7*stride],array[j+i+6*stride],array[j+i+5*stride],array[j+i+4*stride],array[j+i+3*stride],array[j+i+2*stride],array[j+i+stride],array[j+i]);
+      tmp = _mm256_add_epi32(data, tmp);
+    }
+  }
+
+  uint64_t res = 0;
+  for (int i= 0; i<8; i++)
+    res += _mm256_extract_epi32(tmp,i);
+
+  return res;
+}
+
+/**
+ * @brief avx256 linear store variant, baseline for the scatter variants
+ *
+ * writes every position's index into it,
+ * returns the sum of all written values for checksumming.
+ *
+ * @param array
+ * @param number
+ * @return uint64_t
+ */
+
+uint64_t scatter_linear_avx256(uint32_t* array, uint64_t number, const uint32_t stride=0) {
+  __m256i tmp, data;
+
+  const __m256i step = _mm256_set1_epi32(8);
+  tmp  = _mm256_setzero_si256();
+  data = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+  for (uint64_t i = 0; i + 8 <= number; i += 8) {
+    _mm256_store_si256(reinterpret_cast<__m256i *> (&array[i]), data);
+    tmp  = _mm256_add_epi32(data, tmp);
+    data = _mm256_add_epi32(data, step);
+  }
+
+  uint64_t res = 0;
+  for (int i= 0; i<8; i++)
+    res += (uint32_t) _mm256_extract_epi32(tmp,i);
+
+  return res;
+}
+
+/**
+ * @brief avx/avx2 strided store variant, emulates a scatter instruction
+ * (which avx2 does not have) by extracting and storing every lane
+ *
+ * writes every position's index into it,
+ * returns the sum of all written values for checksumming.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+uint64_t scatter_strided_emulated_avx256(uint32_t* array, uint64_t number, const uint32_t stride) {
+  __m256i tmp, data;
+
+  const __m256i lane_positions = _mm256_set_epi32(7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
+  const __m256i one = _mm256_set1_epi32(1);
+  tmp = _mm256_setzero_si256();
+
+  for (uint64_t j = 0; j < number; j += 8 * stride) {
+    data = _mm256_add_epi32(lane_positions, _mm256_set1_epi32(j));
+    for (uint64_t i = 0; i < stride; i++) {
+      array[j+i]          = _mm256_extract_epi32(data, 0);
+      array[j+i+stride]   = _mm256_extract_epi32(data, 1);
+      array[j+i+2*stride] = _mm256_extract_epi32(data, 2);
+      array[j+i+3*stride] = _mm256_extract_epi32(data, 3);
+      array[j+i+4*stride] = _mm256_extract_epi32(data, 4);
+      array[j+i+5*stride] = _mm256_extract_epi32(data, 5);
+      array[j+i+6*stride] = _mm256_extract_epi32(data, 6);
+      array[j+i+7*stride] = _mm256_extract_epi32(data, 7);
+      tmp  = _mm256_add_epi32(data, tmp);
+      data = _mm256_add_epi32(data, one);
+    }
+  }
+
+  uint64_t res = 0;
+  for (int i= 0; i<8; i++)
+    res += (uint32_t) _mm256_extract_epi32(tmp,i);
+
+  return res;
+}
+
+/**
+ * @brief avx256 lookup variant using gather instruction
+ *
+ * sums up the values at the positions in index (32 bit offsets, below 2**31),
+ * e.g. foreign key lookups or late materialization.
+ *
+ * @param array
+ * @param index
+ * @param number of positions in index
+ * @return uint64_t
+ */
+uint64_t lookup_gather_avx256(const uint32_t* array, const uint32_t* index, uint64_t number) {
+  __m256i tmp, positions, data;
+
+  tmp = _mm256_setzero_si256();
+  for (uint64_t i = 0; i + 8 <= number; i += 8) {
+    positions = _mm256_loadu_si256(reinterpret_cast<const __m256i *> (&index[i]));
+    data = _mm256_i32gather_epi32(reinterpret_cast<int const *> (array), positions, 4);
+    tmp  = _mm256_add_epi32(data, tmp);
+  }
+
+  uint32_t res = 0;
+  for (int i = 0; i < 8; i++)
+    res += _mm256_extract_epi32(tmp, i);
+
+  return res;
+}
+
+/**
+ * @brief avx256 lookup variant using gather instruction
+ *
+ * sums up the values at the positions in index (64 bit offsets),
+ * e.g. foreign key lookups or late materialization.
+ *
+ * @param array
+ * @param index
+ * @param number of positions in index
+ * @return uint64_t
+ */
+uint64_t lookup_gather_avx256(const uint32_t* array, const uint64_t* index, uint64_t number) {
+  __m256i positions;
+  __m128i tmp, data;
+
+  tmp = _mm_setzero_si128();
+  for (uint64_t i = 0; i + 4 <= number; i += 4) {
+    positions = _mm256_loadu_si256(reinterpret_cast<const __m256i *> (&index[i]));
+    data = _mm256_i64gather_epi32(reinterpret_cast<int const *> (array), positions, 4);
+    tmp  = _mm_add_epi32(data, tmp);
+  }
+
+  uint32_t res = 0;
+  for (int i = 0; i < 4; i++)
+    res += _mm_extract_epi32(tmp, i);
+
+  return res;
+}
+
+/**
+ * @brief avx256 lookup variant using gather instruction and software prefetching
+ *
+ * like the variant without prefetching (32 bit offsets), but prefetches the
+ * values prefetch_distance gathers ahead into L1, once the index is that far.
+ *
+ * @param array
+ * @param index
+ * @param number of positions in index
+ * @return uint64_t
+ */
+uint64_t lookup_gather_prefetch_avx256(const uint32_t* array, const uint32_t* index, uint64_t number) {
+  __m256i tmp, positions, data;
+
+  const uint64_t ahead = prefetch_distance * 8;
+  tmp = _mm256_setzero_si256();
+  for (uint64_t i = 0; i + 8 <= number; i += 8) {
+    if (i + ahead + 8 <= number) prefetch_positions<_MM_HINT_T0>(array, &index[i + ahead], 8);
+    positions = _mm256_loadu_si256(reinterpret_cast<const __m256i *> (&index[i]));
+    data = _mm256_i32gather_epi32(reinterpret_cast<int const *> (array), positions, 4);
+    tmp  = _mm256_add_epi32(data, tmp);
+  }
+
+  uint32_t res = 0;
+  for (int i = 0; i < 8; i++)
+    res += _mm256_extract_epi32(tmp, i);
+
+  return res;
+}
+
+/**
+ * @brief avx256 lookup variant using gather instruction and software prefetching
+ *
+ * like the variant without prefetching (64 bit offsets), but prefetches the
+ * values prefetch_distance gathers ahead into L1, once the index is that far.
+ *
+ * @param array
+ * @param index
+ * @param number of positions in index
+ * @return uint64_t
+ */
+uint64_t lookup_gather_prefetch_avx256(const uint32_t* array, const uint64_t* index, uint64_t number) {
+  __m256i positions;
+  __m128i tmp, data;
+
+  const uint64_t ahead = prefetch_distance * 4;
+  tmp = _mm_setzero_si128();
+  for (uint64_t i = 0; i + 4 <= number; i += 4) {
+    if (i + ahead + 4 <= number) prefetch_positions<_MM_HINT_T0>(array, &index[i + ahead], 4);
+    positions = _mm256_loadu_si256(reinterpret_cast<const __m256i *> (&index[i]));
+    data = _mm256_i64gather_epi32(reinterpret_cast<int const *> (array), positions, 4);
+    tmp  = _mm_add_epi32(data, tmp);
+  }
+
+  uint32_t res = 0;
+  for (int i = 0; i < 4; i++)
+    res += _mm_extract_epi32(tmp, i);
+
+  return res;
+}
+
+/**
+ * @brief avx256 lookup variant using set instruction
+ *
+ * sums up the values at the positions in index (32 or 64 bit offsets),
+ * e.g. foreign key lookups or late materialization.
+ *
+ * @param array
+ * @param index
+ * @param number of positions in index
+ * @return uint64_t
+ */
+template <class IndexT>
+uint64_t lookup_set_avx256(const uint32_t* array, const IndexT* index, uint64_t number) {
+  __m256i tmp, data;
+
+  tmp = _mm256_setzero_si256();
+  for (uint64_t i = 0; i + 8 <= number; i += 8) {
+    data = _mm256_set_epi32(array[index[i+7]], array[index[i+6]], array[index[i+5]], array[index[i+4]], array[index[i+3]], array[index[i+2]], array[index[i+1]], array[index[i]]);
+    tmp  = _mm256_add_epi32(data, tmp);
+  }
+
+  uint32_t res = 0;
+  for (int i = 0; i < 8; i++)
+    res += _mm256_extract_epi32(tmp, i);
+
+  return res;
+}
+
+/**
+ * @brief avx256 hash table probe, vertical: 8 keys at a time
+ *
+ * every lane probes its own key, from its probe_start slot on, until it
+ * finds the key or an empty slot; lanes that are done stay masked off until
+ * all 8 are (AVX2 has no expand load to refill them with the next keys).
+ * Gather loads the slots with a masked gather, otherwise with scalar loads
+ * into set_epi32. the last number % 8 keys are probed scalar.
+ *
+ * @param table
+ * @param keys to look up
+ * @param number of keys
+ * @return uint64_t sum of the values of the keys found
+ */
+template <bool Gather>
+uint64_t probe_vertical_avx256(const hash_table<uint32_t>& table, const uint32_t* keys, uint64_t number) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i slot_mask = _mm256_set1_epi32((uint32_t) (table.slots() - 1));
+  const __m256i multiplier = _mm256_set1_epi32(PROBE_HASH_MULTIPLIER);
+  const __m128i hash_shift = _mm_cvtsi64_si128(32 - table.slots_log2 + table.bucket_log2);
+  const __m128i bucket_shift = _mm_cvtsi64_si128(table.bucket_log2);
+  alignas(32) uint32_t lane_slots[8];
+  __m256i tmp, probe, slot, active, found, hit, empty, data;
+
+  tmp = zero;
+  uint64_t i = 0;
+  for (; i + 8 <= number; i += 8) {
+    probe = _mm256_loadu_si256(reinterpret_cast<const __m256i *> (&keys[i]));
+    slot = _mm256_sll_epi32(_mm256_srl_epi32(_mm256_mullo_epi32(probe, multiplier), hash_shift), bucket_shift);
+    active = _mm256_cmpeq_epi32(zero, zero);
+    while (!_mm256_testz_si256(active, active)) {
+      if (Gather) {
+        found = _mm256_mask_i32gather_epi32(zero, reinterpret_cast<int const *> (table.keys), slot, active, 4);
+      } else {
+        _mm256_store_si256(reinterpret_cast<__m256i *> (lane_slots), slot);
+        found = _mm256_set_epi32(table.keys[lane_slots[7]], table.keys[lane_slots[6]], table.keys[lane_slots[5]], table.keys[lane_slots[4]], table.keys[lane_slots[3]], table.keys[lane_slots[2]], table.keys[lane_slots[1]], table.keys[lane_slots[0]]);
+      }
+      hit = _mm256_and_si256(active, _mm256_cmpeq_epi32(found, probe));
+      empty = _mm256_and_si256(active, _mm256_cmpeq_epi32(found, zero));
+      if (Gather) {
+        data = _mm256_mask_i32gather_epi32(zero, reinterpret_cast<int const *> (table.values), slot, hit, 4);
+      } else {
+        data = _mm256_and_si256(hit, _mm256_set_epi32(table.values[lane_slots[7]], table.values[lane_slots[6]], table.values[lane_slots[5]], table.values[lane_slots[4]], table.values[lane_slots[3]], table.values[lane_slots[2]], table.values[lane_slots[1]], table.values[lane_slots[0]]));
+      }
+      tmp = _mm256_add_epi32(data, tmp);
+      active = _mm256_andnot_si256(_mm256_or_si256(hit, empty), active);
+      slot = _mm256_and_si256(_mm256_add_epi32(slot, one), slot_mask);
+    }
+  }
+
+  uint32_t res = 0;
+  for (int lane = 0; lane < 8; lane++)
+    res += _mm256_extract_epi32(tmp, lane);
+
+  return res + (uint32_t) probe_scalar(table, keys + i, number - i);
+}
+
+/**
+ * @brief avx256 hash table probe, horizontal: one key at a time
+ *
+ * for the buckets layout: compares the key with the 16 slots of its bucket
+ * (one cache line, two vectors) at once, then with the next bucket until
+ * the key or an empty slot is among them.
+ *
+ * @param table in the buckets layout
+ * @param keys to look up
+ * @param number of keys
+ * @return uint64_t sum of the values of the keys found
+ */
+uint64_t probe_bucket_avx256(const hash_table<uint32_t>& table, const uint32_t* keys, uint64_t number) {
+  const __m256i zero = _mm256_setzero_si256();
+  const uint64_t slot_mask = table.slots() - 1;
+  __m256i probe, low, high;
+
+  uint32_t res = 0;
+  for (uint64_t i = 0; i < number; i++) {
+    probe = _mm256_set1_epi32(keys[i]);
+    for (uint64_t slot = probe_start(keys[i], table.slots_log2, table.bucket_log2); ; slot = (slot + 16) & slot_mask) {
+      low = _mm256_loadu_si256(reinterpret_cast<const __m256i *> (&table.keys[slot]));
+      high = _mm256_loadu_si256(reinterpret_cast<const __m256i *> (&table.keys[slot + 8]));
+      const uint32_t hit = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(low, probe)))
+        | _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(high, probe))) << 8;
+      if (hit != 0) {
+        res += table.values[slot + __builtin_ctz(hit)];
+        break;
+      }
+      if (!_mm256_testz_si256(_mm256_or_si256(_mm256_cmpeq_epi32(low, zero), _mm256_cmpeq_epi32(high, zero)), _mm256_cmpeq_epi32(zero, zero))) break;
+    }
+  }
+
+  return res;
+}
+
+/**
+ * @brief avx256 pointer chase, 8 chains at once
+ *
+ * every lane follows its own chain through next, from starts[lane] on: the
+ * positions of one gather are the values of the previous one, so the hops
+ * are dependent loads, 8 of them in flight.
+ *
+ * @param next the cycle
+ * @param starts 8 positions
+ * @param hops gathers per lane
+ * @return uint64_t sum of the positions the lanes end at
+ */
+uint64_t chase_gather_avx256(const uint32_t* next, const uint32_t* starts, uint64_t hops) {
+  __m256i positions;
+
+  positions = _mm256_loadu_si256(reinterpret_cast<const __m256i *> (starts));
+  for (uint64_t h = 0; h < hops; h++) {
+    positions = _mm256_i32gather_epi32(reinterpret_cast<int const *> (next), positions, 4);
+  }
+
+  uint32_t res = 0;
+  for (int i = 0; i < 8; i++)
+    res += _mm256_extract_epi32(positions, i);
+
+  return res;
+}
+
 #endif /* AGG_AVX_32BITVARIANTS_H */
@@ -6,6 +6,14 @@
 #include <cstdint>
 
 #include "gather/aggregate_scalar.cpp"
+#include "gather/scatter_scalar.cpp"
+#include "gather/lookup_scalar.cpp"
+#include "gather/groupby_scalar.cpp"
+#include "gather/probe_scalar.cpp"
+#include "gather/chase_scalar.cpp"
+#include "gather/prefetch.cpp"
+#include "gather/unroll.cpp"
+#include "gather/static_strides.cpp"
 
 /**
  * @brief linear load avx512 variant
@@ -20,7 +28,7 @@ uint64_t aggregate_linear_avx512(const uint32_t* array, uint64_t number, const u
   uint64_t r = 0;
 
   tmp = _mm512_setzero_si512();
-  for (int i = 0; i < number - 16 + 1; i += 16) {
+  for (uint64_t i = 0; i + 16 <= number; i += 16) {
     data = _mm512_load_epi32(reinterpret_cast<const __m512i *> (&array[i]));
     tmp = _mm512_add_epi32(data, tmp);
   }
@@ -48,7 +56,7 @@ uint64_t aggregate_strided_gather_avx512_512(const uint32_t* array, uint64_t num
     //const __m512i gatherindex = _mm512_set_epi32(3585, 3584, 3073, 3072, 2561 , 2560, 2049, 2048, 1537, 1536 , 1025, 1024, 513, 512, 1, 0);
 
 
-  for (int j = 0; j < number; j += 8 * 512) {
+  for (uint64_t j = 0; j < number; j += 8 * 512) {
     for (int i = 0; i < 256; i++) {
        // std::cout<<j+i<<std::endl;
       data = _mm512_i32gather_epi32(gatherindex, reinterpret_cast<void const *> (&array[j + i]), 4);
@@ -77,8 +85,8 @@ uint64_t aggregate_strided_gather_avx512(const uint32_t* array, uint64_t number,
 
   const __m512i gatherindex = _mm512_set_epi32(15 * stride, 14 * stride, 13 * stride, 12 * stride, 11 * stride, 10 * stride, 9 * stride, 8 * stride, 7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
 
-  for (int j = 0; j < number; j += 16 * stride) {
-    for (int i = 0; i < stride; i++) {
+  for (uint64_t j = 0; j < number; j += 16 * stride) {
+    for (uint32_t i = 0; i < stride; i++) {
       data = _mm512_i32gather_epi32(gatherindex, reinterpret_cast<void const *> (&array[j + i]), 4);
       tmp = _mm512_add_epi32(data, tmp);
     }
@@ -101,17 +109,743 @@ uint64_t aggregate_strided_set_avx512(const uint32_t* array, uint64_t number, co
 
   tmp = _mm512_setzero_si512();
 
-  for (int j = 0; j < number; j += 16 * stride) {
-    for (int i = 0; i < stride; i++) {
+  for (uint64_t j = 0; j < number; j += 16 * stride) {
+    for (uint32_t i = 0; i < stride; i++) {
 			data = _mm512_set_epi32(array[j+i+15*stride],array[j+i+14*stride],array[j+i+13*stride],array[j+i+12*stride],array[j+i+11*stride],array[j+i+10*stride],array[j+i+9*stride],array[j+i+8*stride],array[j+i+7*stride],array[j+i+6*stride],array[j+i+5*stride],array[j+i+4*stride],array[j+i+3*stride],array[j+i+2*stride],array[j+i+stride],array[j+i]);
-      tmp = _mm512_add_epi64(data, tmp);
+      tmp = _mm512_add_epi32(data, tmp);
+    }
+  }
+
+  return _mm512_reduce_add_epi32 (tmp);
+}
+
+
+
+
+
+/**
+ * @brief avx512 linear load variant that sums up in 64 bit
+ *
+ * the 16 values of every load are widened (cvtepu32_epi64) into two
+ * accumulators of 8 64 bit lanes, so the sum does not wrap at 2^32.
+ *
+ * @param array
+ * @param number
+ * @return uint64_t
+ */
+uint64_t aggregate_linear_wide_avx512(const uint32_t* array, uint64_t number, const uint32_t stride=0) {
+  __m512i low, high, data;
+
+  low = _mm512_setzero_si512();
+  high = _mm512_setzero_si512();
+  for (uint64_t i = 0; i + 16 <= number; i += 16) {
+    data = _mm512_load_epi32(reinterpret_cast<const __m512i *> (&array[i]));
+    low = _mm512_add_epi64(_mm512_cvtepu32_epi64(_mm512_castsi512_si256(data)), low);
+    high = _mm512_add_epi64(_mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(data, 1)), high);
+  }
+
+  return _mm512_reduce_add_epi64(_mm512_add_epi64(low, high));
+}
+
+/**
+ * @brief avx512 strided access variant using gather instruction that sums up in 64 bit
+ *
+ * gathers like aggregate_strided_gather_avx512 and widens the values like
+ * aggregate_linear_wide_avx512.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+uint64_t aggregate_strided_gather_wide_avx512(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  __m512i low, high, data;
+
+  low = _mm512_setzero_si512();
+  high = _mm512_setzero_si512();
+
+  const __m512i gatherindex = _mm512_set_epi32(15 * stride, 14 * stride, 13 * stride, 12 * stride, 11 * stride, 10 * stride, 9 * stride, 8 * stride, 7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
+
+  for (uint64_t j = 0; j < number; j += 16 * stride) {
+    for (uint32_t i = 0; i < stride; i++) {
+      data = _mm512_i32gather_epi32(gatherindex, reinterpret_cast<void const *> (&array[j + i]), 4);
+      low = _mm512_add_epi64(_mm512_cvtepu32_epi64(_mm512_castsi512_si256(data)), low);
+      high = _mm512_add_epi64(_mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(data, 1)), high);
+    }
+  }
+
+  return _mm512_reduce_add_epi64(_mm512_add_epi64(low, high));
+}
+
+/**
+ * @brief avx512 strided access variant using gather instruction with 64 bit offsets
+ *
+ * like aggregate_strided_gather_avx512, but with 64 bit lane offsets (i64gather),
+ * to compare what the wider index costs: two gathers of 8 lanes per 16 values
+ * (an index vector holds 8 offsets).
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+uint64_t aggregate_strided_gather_i64_avx512(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  __m256i tmp, low, high;
+
+  tmp = _mm256_setzero_si256();
+
+  const uint64_t s = stride;
+  const __m512i lowindex = _mm512_set_epi64(7 * s, 6 * s, 5 * s, 4 * s, 3 * s, 2 * s, s, 0);
+  const __m512i highindex = _mm512_set_epi64(15 * s, 14 * s, 13 * s, 12 * s, 11 * s, 10 * s, 9 * s, 8 * s);
+
+  for (uint64_t j = 0; j < number; j += 16 * s) {
+    for (uint32_t i = 0; i < stride; i++) {
+      low = _mm512_i64gather_epi32(lowindex, reinterpret_cast<void const *> (&array[j + i]), 4);
+      high = _mm512_i64gather_epi32(highindex, reinterpret_cast<void const *> (&array[j + i]), 4);
+      tmp = _mm256_add_epi32(_mm256_add_epi32(low, high), tmp);
+    }
+  }
+  return (uint32_t) _mm512_reduce_add_epi64(_mm512_cvtepu32_epi64(tmp));
+}
+
+/**
+ * @brief avx512 linear load variant for any number of values
+ *
+ * unaligned loads, the last (partial) vector is loaded with a mask,
+ * so no value is left out.
+ *
+ * @param array
+ * @param number
+ * @return uint64_t
+ */
+uint64_t aggregate_linear_masked_avx512(const uint32_t* array, uint64_t number, const uint32_t stride=0) {
+  __m512i tmp, data;
+
+  tmp = _mm512_setzero_si512();
+  uint64_t i = 0;
+  for (; i + 16 <= number; i += 16) {
+    data = _mm512_loadu_si512(reinterpret_cast<const void *> (&array[i]));
+    tmp = _mm512_add_epi32(data, tmp);
+  }
+  if (i < number) {
+    const __mmask16 valid = (__mmask16) ((1u << (number - i)) - 1);
+    data = _mm512_maskz_loadu_epi32(valid, reinterpret_cast<const void *> (&array[i]));
+    tmp = _mm512_add_epi32(data, tmp);
+  }
+
+  return _mm512_reduce_add_epi32(tmp);
+}
+
+/**
+ * @brief avx512 strided access variant using gather instruction, for any number of values
+ *
+ * like the variant without mask for the whole blocks of lanes * stride
+ * values, the last (partial) block is gathered with masks that leave out
+ * the lanes at or past number, so no value is left out (or read past the end).
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+uint64_t aggregate_strided_gather_masked_avx512(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  __m512i tmp, data;
+
+  tmp = _mm512_setzero_si512();
+
+  const __m512i gatherindex = _mm512_set_epi32(15 * stride, 14 * stride, 13 * stride, 12 * stride, 11 * stride, 10 * stride, 9 * stride, 8 * stride, 7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
+  const uint64_t block = 16 * (uint64_t) stride;
+  const uint64_t whole = number / block * block;
+
+  for (uint64_t j = 0; j < whole; j += block) {
+    for (uint32_t i = 0; i < stride; i++) {
+      data = _mm512_i32gather_epi32(gatherindex, reinterpret_cast<void const *> (&array[j + i]), 4);
+      tmp = _mm512_add_epi32(data, tmp);
+    }
+  }
+
+  // lane k of gather i reads whole + i + k * stride, if that is below number
+  const uint64_t rest = number - whole;
+  for (uint32_t i = 0; i < stride && i < rest; i++) {
+    const __mmask16 valid = _mm512_cmplt_epu32_mask(gatherindex, _mm512_set1_epi32(rest - i));
+    data = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), valid, gatherindex, reinterpret_cast<void const *> (&array[whole + i]), 4);
+    tmp = _mm512_add_epi32(data, tmp);
+  }
+
+  return _mm512_reduce_add_epi32 (tmp);
+}
+
+/**
+ * @brief avx512 strided access variant using gather instruction, for a fixed stride
+ *
+ * like the variant with a run time stride, but the stride is a template
+ * argument, so the index vector is a constant and the compiler knows the
+ * trip count of the inner loop (and may unroll it).
+ *
+ * @param array
+ * @param number
+ * @param stride (ignored, Stride is used)
+ * @return uint64_t
+ */
+template <uint32_t Stride>
+uint64_t aggregate_strided_gather_static_avx512(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  __m512i tmp, data;
+
+  tmp = _mm512_setzero_si512();
+
+  const __m512i gatherindex = _mm512_set_epi32(15 * Stride, 14 * Stride, 13 * Stride, 12 * Stride, 11 * Stride, 10 * Stride, 9 * Stride, 8 * Stride, 7 * Stride, 6 * Stride, 5 * Stride, 4 * Stride, 3 * Stride, 2 * Stride, Stride, 0);
+
+  for (uint64_t j = 0; j < number; j += 16 * Stride) {
+    for (uint32_t i = 0; i < Stride; i++) {
+      data = _mm512_i32gather_epi32(gatherindex, reinterpret_cast<void const *> (&array[j + i]), 4);
+      tmp = _mm512_add_epi32(data, tmp);
+    }
+  }
+
+  return _mm512_reduce_add_epi32 (tmp);
+}
+
+/**
+ * @brief avx512 strided access variant using gather instruction, dispatched to a fixed stride
+ *
+ * calls the instantiation for stride (see static_strides.cpp) through a
+ * jump table, the variant with a run time stride if there is none.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+template <uint32_t... Strides>
+uint64_t aggregate_strided_gather_static_avx512(const uint32_t* array, uint64_t number, const uint32_t stride, std::integer_sequence<uint32_t, Strides...>) {
+  static uint64_t (* const table[])(const uint32_t*, uint64_t, const uint32_t) = { aggregate_strided_gather_static_avx512<Strides>... };
+
+  const int slot = static_stride_slot(stride);
+  if (slot < 0) return aggregate_strided_gather_avx512(array, number, stride);
+  return table[slot](array, number, stride);
+}
+
+uint64_t aggregate_strided_gather_static_avx512(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  return aggregate_strided_gather_static_avx512(array, number, stride, static_strides());
+}
+
+/**
+ * @brief avx512 strided access variant using set instruction, for a fixed stride
+ *
+ * like the variant with a run time stride, but the stride is a template
+ * argument, so the index vector is a constant and the compiler knows the
+ * trip count of the inner loop (and may unroll it).
+ *
+ * @param array
+ * @param number
+ * @param stride (ignored, Stride is used)
+ * @return uint64_t
+ */
+template <uint32_t Stride>
+uint64_t aggregate_strided_set_static_avx512(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  __m512i tmp, data;
+
+  tmp = _mm512_setzero_si512();
+
+  for (uint64_t j = 0; j < number; j += 16 * Stride) {
+    for (uint32_t i = 0; i < Stride; i++) {
+			data = _mm512_set_epi32(array[j+i+15*Stride],array[j+i+14*Stride],array[j+i+13*Stride],array[j+i+12*Stride],array[j+i+11*Stride],array[j+i+10*Stride],array[j+i+9*Stride],array[j+i+8*Stride],array[j+i+7*Stride],array[j+i+6*Stride],array[j+i+5*Stride],array[j+i+4*Stride],array[j+i+3*Stride],array[j+i+2*Stride],array[j+i+Stride],array[j+i]);
+      tmp = _mm512_add_epi32(data, tmp);
+    }
+  }
+
+  return _mm512_reduce_add_epi32 (tmp);
+}
+
+/**
+ * @brief avx512 strided access variant using set instruction, dispatched to a fixed stride
+ *
+ * calls the instantiation for stride (see static_strides.cpp) through a
+ * jump table, the variant with a run time stride if there is none.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+template <uint32_t... Strides>
+uint64_t aggregate_strided_set_static_avx512(const uint32_t* array, uint64_t number, const uint32_t stride, std::integer_sequence<uint32_t, Strides...>) {
+  static uint64_t (* const table[])(const uint32_t*, uint64_t, const uint32_t) = { aggregate_strided_set_static_avx512<Strides>... };
+
+  const int slot = static_stride_slot(stride);
+  if (slot < 0) return aggregate_strided_set_avx512(array, number, stride);
+  return table[slot](array, number, stride);
+}
+
+uint64_t aggregate_strided_set_static_avx512(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  return aggregate_strided_set_static_avx512(array, number, stride, static_strides());
+}
+
+/**
+ * @brief avx512 strided access variant using gather instruction, unrolled
+ *
+ * like the variant without unrolling, but issues Unroll gathers per loop
+ * iteration and adds them into Accumulators independent registers
+ * (round robin, Unroll has to be a multiple), so the adds do not form a
+ * single dependency chain. strides that are no multiple of Unroll get
+ * their remaining gathers one by one.
+ * flatten: see unrolled in unroll.cpp.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+template <unsigned Unroll, unsigned Accumulators>
+__attribute__((flatten))
+uint64_t aggregate_strided_gather_unrolled_avx512(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  static_assert(Unroll % Accumulators == 0, "Unroll has to be a multiple of Accumulators");
+  __m512i tmp[Accumulators] = {};
+
+  const __m512i gatherindex = _mm512_set_epi32(15 * stride, 14 * stride, 13 * stride, 12 * stride, 11 * stride, 10 * stride, 9 * stride, 8 * stride, 7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
+
+  for (uint64_t j = 0; j < number; j += 16 * stride) {
+    uint64_t i = 0;
+    for (; i + Unroll <= stride; i += Unroll) {
+      unrolled<Unroll>([&] (auto u) {
+        constexpr unsigned a = decltype(u)::value % Accumulators;
+        tmp[a] = _mm512_add_epi32(_mm512_i32gather_epi32(gatherindex, reinterpret_cast<void const *> (&array[j + i + decltype(u)::value]), 4), tmp[a]);
+      });
+    }
+    for (; i < stride; i++) {
+      tmp[0] = _mm512_add_epi32(_mm512_i32gather_epi32(gatherindex, reinterpret_cast<void const *> (&array[j + i]), 4), tmp[0]);
+    }
+  }
+
+  unrolled<Accumulators - 1>([&] (auto a) { tmp[0] = _mm512_add_epi32(tmp[decltype(a)::value + 1], tmp[0]); });
+
+  return _mm512_reduce_add_epi32 (tmp[0]);
+}
+
+/**
+ * @brief avx512 strided access variant using gather instruction and software prefetching
+ *
+ * like the variant without prefetching, but prefetches the lanes of the gather
+ * prefetch_distance gathers ahead (once per cache line) with Hint:
+ * _MM_HINT_T0, _MM_HINT_T1 or _MM_HINT_NTA.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+template <_mm_hint Hint>
+uint64_t aggregate_strided_gather_prefetch_avx512(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  __m512i tmp, data;
+
+  tmp = _mm512_setzero_si512();
+
+  const __m512i gatherindex = _mm512_set_epi32(15 * stride, 14 * stride, 13 * stride, 12 * stride, 11 * stride, 10 * stride, 9 * stride, 8 * stride, 7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
+  strided_cursor<uint32_t> ahead(stride, 16, prefetch_distance);
+
+  for (uint64_t j = 0; j < number; j += 16 * stride) {
+    for (uint64_t i = 0; i < stride; i++) {
+      if (ahead.new_lines()) ahead.prefetch<Hint>(array, 16);
+      ahead.next();
+      data = _mm512_i32gather_epi32(gatherindex, reinterpret_cast<void const *> (&array[j + i]), 4);
+      tmp = _mm512_add_epi32(data, tmp);
     }
   }
 
   return _mm512_reduce_add_epi32 (tmp);
 }
 
+/**
+ * @brief avx512 strided access variant using set instruction and software prefetching
+ *
+ * like the variant without prefetching, but prefetches the lanes of the gather
+ * prefetch_distance gathers ahead (once per cache line) with Hint:
+ * _MM_HINT_T0, _MM_HINT_T1 or _MM_HINT_NTA.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+template <_mm_hint Hint>
+uint64_t aggregate_strided_set_prefetch_avx512(const uint32_t* array, uint64_t number, const uint32_t stride) {
+  __m512i tmp, data;
+
+  tmp = _mm512_setzero_si512();
+  strided_cursor<uint32_t> ahead(stride, 16, prefetch_distance);
+
+  for (uint64_t j = 0; j < number; j += 16 * stride) {
+    for (uint64_t i = 0; i < stride; i++) {
+      if (ahead.new_lines()) ahead.prefetch<Hint>(array, 16);
+      ahead.next();
+			data = _mm512_set_epi32(array[j+i+15*stride],array[j+i+14*stride],array[j+i+13*stride],array[j+i+12*stride],array[j+i+11*stride],array[j+i+10*stride],array[j+i+9*stride],array[j+i+8*stride],array[j+i+7*stride],array[j+i+6*stride],array[j+i+5*stride],array[j+i+4*stride],array[j+i+3*stride],array[j+i+2*stride],array[j+i+stride],array[j+i]);
+      tmp = _mm512_add_epi32(data, tmp);
+    }
+  }
+
+  return _mm512_reduce_add_epi32 (tmp);
+}
+
+/**
+ * @brief avx512 linear store variant, baseline for the scatter variants
+ *
+ * writes every position's index into it,
+ * returns the sum of all written values for checksumming.
+ *
+ * @param array
+ * @param number
+ * @return uint64_t
+ */
+
+uint64_t scatter_linear_avx512(uint32_t* array, uint64_t number, const uint32_t stride=0) {
+  __m512i tmp, data;
+
+  const __m512i step = _mm512_set1_epi32(16);
+  tmp  = _mm512_setzero_si512();
+  data = _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  for (uint64_t i = 0; i + 16 <= number; i += 16) {
+    _mm512_store_epi32(reinterpret_cast<__m512i *> (&array[i]), data);
+    tmp  = _mm512_add_epi32(data, tmp);
+    data = _mm512_add_epi32(data, step);
+  }
+
+  return (uint32_t) _mm512_reduce_add_epi32(tmp);
+}
+
+/**
+ * @brief avx512 strided store variant using scatter instruction
+ *
+ * writes every position's index into it,
+ * returns the sum of all written values for checksumming.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+uint64_t scatter_strided_avx512(uint32_t* array, uint64_t number, const uint32_t stride) {
+  __m512i tmp, data;
+
+  const __m512i scatterindex = _mm512_set_epi32(15 * stride, 14 * stride, 13 * stride, 12 * stride, 11 * stride, 10 * stride, 9 * stride, 8 * stride, 7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
+  const __m512i one = _mm512_set1_epi32(1);
+  tmp = _mm512_setzero_si512();
+
+  for (uint64_t j = 0; j < number; j += 16 * stride) {
+    // the scatter index doubles as the lanes' positions relative to j
+    data = _mm512_add_epi32(scatterindex, _mm512_set1_epi32(j));
+    for (uint64_t i = 0; i < stride; i++) {
+      _mm512_i32scatter_epi32(reinterpret_cast<void *> (&array[j + i]), scatterindex, data, 4);
+      tmp  = _mm512_add_epi32(data, tmp);
+      data = _mm512_add_epi32(data, one);
+    }
+  }
+
+  return (uint32_t) _mm512_reduce_add_epi32(tmp);
+}
+
+/**
+ * @brief avx512 lookup variant using gather instruction
+ *
+ * sums up the values at the positions in index (32 bit offsets, below 2**31),
+ * e.g. foreign key lookups or late materialization.
+ *
+ * @param array
+ * @param index
+ * @param number of positions in index
+ * @return uint64_t
+ */
+uint64_t lookup_gather_avx512(const uint32_t* array, const uint32_t* index, uint64_t number) {
+  __m512i tmp, positions, data;
+
+  tmp = _mm512_setzero_si512();
+  for (uint64_t i = 0; i + 16 <= number; i += 16) {
+    positions = _mm512_loadu_si512(reinterpret_cast<void const *> (&index[i]));
+    data = _mm512_i32gather_epi32(positions, reinterpret_cast<void const *> (array), 4);
+    tmp  = _mm512_add_epi32(data, tmp);
+  }
 
+  return (uint32_t) _mm512_reduce_add_epi32(tmp);
+}
 
+/**
+ * @brief avx512 lookup variant using gather instruction
+ *
+ * sums up the values at the positions in index (64 bit offsets),
+ * e.g. foreign key lookups or late materialization.
+ *
+ * @param array
+ * @param index
+ * @param number of positions in index
+ * @return uint64_t
+ */
+uint64_t lookup_gather_avx512(const uint32_t* array, const uint64_t* index, uint64_t number) {
+  __m512i positions;
+  __m256i tmp, data;
+
+  tmp = _mm256_setzero_si256();
+  for (uint64_t i = 0; i + 8 <= number; i += 8) {
+    positions = _mm512_loadu_si512(reinterpret_cast<void const *> (&index[i]));
+    data = _mm512_i64gather_epi32(positions, reinterpret_cast<void const *> (array), 4);
+    tmp  = _mm256_add_epi32(data, tmp);
+  }
+
+  // zero extended to 64 bit lanes, the sum is cut back to 32 bit
+  return (uint32_t) _mm512_reduce_add_epi64(_mm512_cvtepu32_epi64(tmp));
+}
+
+/**
+ * @brief avx512 lookup variant using gather instruction and software prefetching
+ *
+ * like the variant without prefetching (32 bit offsets), but prefetches the
+ * values prefetch_distance gathers ahead into L1, once the index is that far.
+ *
+ * @param array
+ * @param index
+ * @param number of positions in index
+ * @return uint64_t
+ */
+uint64_t lookup_gather_prefetch_avx512(const uint32_t* array, const uint32_t* index, uint64_t number) {
+  __m512i tmp, positions, data;
+
+  const uint64_t ahead = prefetch_distance * 16;
+  tmp = _mm512_setzero_si512();
+  for (uint64_t i = 0; i + 16 <= number; i += 16) {
+    if (i + ahead + 16 <= number) prefetch_positions<_MM_HINT_T0>(array, &index[i + ahead], 16);
+    positions = _mm512_loadu_si512(reinterpret_cast<void const *> (&index[i]));
+    data = _mm512_i32gather_epi32(positions, reinterpret_cast<void const *> (array), 4);
+    tmp  = _mm512_add_epi32(data, tmp);
+  }
+
+  return (uint32_t) _mm512_reduce_add_epi32(tmp);
+}
+
+/**
+ * @brief avx512 lookup variant using gather instruction and software prefetching
+ *
+ * like the variant without prefetching (64 bit offsets), but prefetches the
+ * values prefetch_distance gathers ahead into L1, once the index is that far.
+ *
+ * @param array
+ * @param index
+ * @param number of positions in index
+ * @return uint64_t
+ */
+uint64_t lookup_gather_prefetch_avx512(const uint32_t* array, const uint64_t* index, uint64_t number) {
+  __m512i positions;
+  __m256i tmp, data;
+
+  const uint64_t ahead = prefetch_distance * 8;
+  tmp = _mm256_setzero_si256();
+  for (uint64_t i = 0; i + 8 <= number; i += 8) {
+    if (i + ahead + 8 <= number) prefetch_positions<_MM_HINT_T0>(array, &index[i + ahead], 8);
+    positions = _mm512_loadu_si512(reinterpret_cast<void const *> (&index[i]));
+    data = _mm512_i64gather_epi32(positions, reinterpret_cast<void const *> (array), 4);
+    tmp  = _mm256_add_epi32(data, tmp);
+  }
+
+  // zero extended to 64 bit lanes, the sum is cut back to 32 bit
+  return (uint32_t) _mm512_reduce_add_epi64(_mm512_cvtepu32_epi64(tmp));
+}
+
+/**
+ * @brief avx512 lookup variant using set instruction
+ *
+ * sums up the values at the positions in index (32 or 64 bit offsets),
+ * e.g. foreign key lookups or late materialization.
+ *
+ * @param array
+ * @param index
+ * @param number of positions in index
+ * @return uint64_t
+ */
+template <class IndexT>
+uint64_t lookup_set_avx512(const uint32_t* array, const IndexT* index, uint64_t number) {
+  __m512i tmp, data;
+
+  tmp = _mm512_setzero_si512();
+  for (uint64_t i = 0; i + 16 <= number; i += 16) {
+    data = _mm512_set_epi32(array[index[i+15]], array[index[i+14]], array[index[i+13]], array[index[i+12]], array[index[i+11]], array[index[i+10]], array[index[i+9]], array[index[i+8]], array[index[i+7]], array[index[i+6]], array[index[i+5]], array[index[i+4]], array[index[i+3]], array[index[i+2]], array[index[i+1]], array[index[i]]);
+    tmp  = _mm512_add_epi32(data, tmp);
+  }
+
+  return (uint32_t) _mm512_reduce_add_epi32(tmp);
+}
+
+/**
+ * @brief avx512 group-by sum using conflict detection
+ *
+ * gathers the buckets of 16 keys, adds the values and scatters them back.
+ * lanes with the same key would overwrite each other's update, so first
+ * every lane adds up the values of the earlier lanes with its key
+ * (conflict_epi32 finds them, each step doubles how far back along the
+ * lanes of a key it reaches, at most 4 steps). the scatter writes the lanes
+ * in order, so the last lane of a key, which holds the sum of all of them,
+ * is the one that stays. Histogram counts the keys instead, the rest of
+ * the keys is added by groupby_scalar.
+ *
+ * @param values
+ * @param keys below bucket_count
+ * @param number of keys
+ * @param buckets
+ * @param bucket_count
+ * @return uint64_t
+ */
+template <bool Histogram>
+uint64_t groupby_conflict_avx512(const uint32_t* values, const uint32_t* keys, uint64_t number, uint32_t* buckets, uint64_t bucket_count) {
+  __m512i sum, add;
+  const __m512i one = _mm512_set1_epi32(1);
+  const __m512i last = _mm512_set1_epi32(31);
+
+  sum = _mm512_setzero_si512();
+  uint64_t i = 0;
+  for (; i + 16 <= number; i += 16) {
+    const __m512i key = _mm512_loadu_si512(reinterpret_cast<const void *> (&keys[i]));
+    add = Histogram ? one : _mm512_loadu_si512(reinterpret_cast<const void *> (&values[i]));
+    sum = _mm512_add_epi32(add, sum);
+
+    const __m512i conflicts = _mm512_conflict_epi32(key);
+    __mmask16 pending = _mm512_test_epi32_mask(conflicts, conflicts);
+    // the nearest earlier lane with the same key, -1 if there is none
+    __m512i previous = _mm512_sub_epi32(last, _mm512_lzcnt_epi32(conflicts));
+    while (pending) {
+      // the lanes whose previous lane still has an earlier one with its key
+      const __mmask16 next = _mm512_mask_test_epi32_mask(pending, _mm512_sllv_epi32(one, previous), _mm512_set1_epi32(pending));
+      add = _mm512_mask_add_epi32(add, pending, add, _mm512_permutexvar_epi32(previous, add));
+      previous = _mm512_mask_permutexvar_epi32(previous, pending, previous, previous);
+      pending = next;
+    }
+
+    const __m512i bucket = _mm512_i32gather_epi32(key, reinterpret_cast<void const *> (buckets), 4);
+    _mm512_i32scatter_epi32(reinterpret_cast<void *> (buckets), key, _mm512_add_epi32(bucket, add), 4);
+  }
+
+  return (uint32_t) (_mm512_reduce_add_epi32(sum) + groupby_scalar<Histogram>(values + i, keys + i, number - i, buckets, bucket_count));
+}
+
+/**
+ * @brief avx512 hash table probe, vertical: 16 keys at a time
+ *
+ * every lane probes its own key, from its probe_start slot on: lanes that
+ * found their key or an empty slot get the next keys of the input (expand
+ * load), the others go on with their next slot, so no lane idles while
+ * others resolve collisions. Gather loads the slots with a gather,
+ * otherwise with scalar loads into set_epi32. the keys still in the lanes
+ * once the input runs short, and the rest of the input, are probed scalar.
+ *
+ * @param table
+ * @param keys to look up
+ * @param number of keys
+ * @return uint64_t sum of the values of the keys found
+ */
+template <bool Gather>
+uint64_t probe_vertical_avx512(const hash_table<uint32_t>& table, const uint32_t* keys, uint64_t number) {
+  const __m512i zero = _mm512_setzero_si512();
+  const __m512i one = _mm512_set1_epi32(1);
+  const __m512i slot_mask = _mm512_set1_epi32((uint32_t) (table.slots() - 1));
+  const __m512i multiplier = _mm512_set1_epi32(PROBE_HASH_MULTIPLIER);
+  const __m128i hash_shift = _mm_cvtsi64_si128(32 - table.slots_log2 + table.bucket_log2);
+  const __m128i bucket_shift = _mm_cvtsi64_si128(table.bucket_log2);
+  alignas(64) uint32_t lane_slots[16];
+  alignas(64) uint32_t lane_keys[16];
+  __m512i tmp, probe, slot, found, data;
+  __mmask16 active, refill, hit, empty;
+
+  tmp = probe = slot = zero;
+  active = 0;
+  uint64_t i = 0;
+  for (;;) {
+    refill = (__mmask16) ~active;
+    const uint64_t fill = __builtin_popcount(refill);
+    if (i + fill > number) break;
+    probe = _mm512_mask_expandloadu_epi32(probe, refill, &keys[i]);
+    i += fill;
+    slot = _mm512_mask_mov_epi32(slot, refill,
+      _mm512_sll_epi32(_mm512_srl_epi32(_mm512_mullo_epi32(probe, multiplier), hash_shift), bucket_shift));
+    if (Gather) {
+      found = _mm512_i32gather_epi32(slot, reinterpret_cast<void const *> (table.keys), 4);
+    } else {
+      _mm512_store_si512(lane_slots, slot);
+      found = _mm512_set_epi32(table.keys[lane_slots[15]], table.keys[lane_slots[14]], table.keys[lane_slots[13]], table.keys[lane_slots[12]], table.keys[lane_slots[11]], table.keys[lane_slots[10]], table.keys[lane_slots[9]], table.keys[lane_slots[8]], table.keys[lane_slots[7]], table.keys[lane_slots[6]], table.keys[lane_slots[5]], table.keys[lane_slots[4]], table.keys[lane_slots[3]], table.keys[lane_slots[2]], table.keys[lane_slots[1]], table.keys[lane_slots[0]]);
+    }
+    hit = _mm512_cmpeq_epi32_mask(found, probe);
+    empty = _mm512_cmpeq_epi32_mask(found, zero);
+    if (hit != 0) {
+      if (Gather) {
+        data = _mm512_mask_i32gather_epi32(zero, hit, slot, reinterpret_cast<void const *> (table.values), 4);
+      } else {
+        data = _mm512_maskz_mov_epi32(hit, _mm512_set_epi32(table.values[lane_slots[15]], table.values[lane_slots[14]], table.values[lane_slots[13]], table.values[lane_slots[12]], table.values[lane_slots[11]], table.values[lane_slots[10]], table.values[lane_slots[9]], table.values[lane_slots[8]], table.values[lane_slots[7]], table.values[lane_slots[6]], table.values[lane_slots[5]], table.values[lane_slots[4]], table.values[lane_slots[3]], table.values[lane_slots[2]], table.values[lane_slots[1]], table.values[lane_slots[0]]));
+      }
+      tmp = _mm512_add_epi32(data, tmp);
+    }
+    active = (__mmask16) ~(hit | empty);
+    slot = _mm512_and_si512(_mm512_add_epi32(slot, one), slot_mask);
+  }
+
+  uint32_t res = _mm512_reduce_add_epi32(tmp);
+  _mm512_store_si512(lane_keys, probe);
+  _mm512_store_si512(lane_slots, slot);
+  for (uint32_t lane = 0; lane < 16; lane++) {
+    if (active >> lane & 1) res += probe_from(table, lane_keys[lane], lane_slots[lane]);
+  }
+
+  return res + (uint32_t) probe_scalar(table, keys + i, number - i);
+}
+
+/**
+ * @brief avx512 hash table probe, horizontal: one key at a time
+ *
+ * for the buckets layout: compares the key with the 16 slots of its bucket
+ * (one cache line) at once, then with the next bucket until the key or an
+ * empty slot is among them.
+ *
+ * @param table in the buckets layout
+ * @param keys to look up
+ * @param number of keys
+ * @return uint64_t sum of the values of the keys found
+ */
+uint64_t probe_bucket_avx512(const hash_table<uint32_t>& table, const uint32_t* keys, uint64_t number) {
+  const __m512i zero = _mm512_setzero_si512();
+  const uint64_t slot_mask = table.slots() - 1;
+  __m512i probe, bucket;
+
+  uint32_t res = 0;
+  for (uint64_t i = 0; i < number; i++) {
+    probe = _mm512_set1_epi32(keys[i]);
+    for (uint64_t slot = probe_start(keys[i], table.slots_log2, table.bucket_log2); ; slot = (slot + 16) & slot_mask) {
+      bucket = _mm512_loadu_si512(reinterpret_cast<void const *> (&table.keys[slot]));
+      const __mmask16 hit = _mm512_cmpeq_epi32_mask(bucket, probe);
+      if (hit != 0) {
+        res += table.values[slot + __builtin_ctz(hit)];
+        break;
+      }
+      if (_mm512_cmpeq_epi32_mask(bucket, zero) != 0) break;
+    }
+  }
+
+  return res;
+}
+
+/**
+ * @brief avx512 pointer chase, 16 chains at once
+ *
+ * every lane follows its own chain through next, from starts[lane] on: the
+ * positions of one gather are the values of the previous one, so the hops
+ * are dependent loads, 16 of them in flight.
+ *
+ * @param next the cycle
+ * @param starts 16 positions
+ * @param hops gathers per lane
+ * @return uint64_t sum of the positions the lanes end at
+ */
+uint64_t chase_gather_avx512(const uint32_t* next, const uint32_t* starts, uint64_t hops) {
+  __m512i positions;
+
+  positions = _mm512_loadu_si512(reinterpret_cast<void const *> (starts));
+  for (uint64_t h = 0; h < hops; h++) {
+    positions = _mm512_i32gather_epi32(positions, reinterpret_cast<void const *> (next), 4);
+  }
+
+  return (uint32_t) _mm512_reduce_add_epi32(positions);
+}
 
 #endif /* AGG_AVX512_32BITVARIANTS_H */
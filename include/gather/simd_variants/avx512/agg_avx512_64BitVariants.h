@@ -7,6 +7,14 @@
 #include <math.h>
 
 #include "gather/aggregate_scalar.cpp"
+#include "gather/scatter_scalar.cpp"
+#include "gather/lookup_scalar.cpp"
+#include "gather/groupby_scalar.cpp"
+#include "gather/probe_scalar.cpp"
+#include "gather/chase_scalar.cpp"
+#include "gather/prefetch.cpp"
+#include "gather/unroll.cpp"
+#include "gather/static_strides.cpp"
 
 /**
  * @brief linear load avx512 variant
@@ -21,7 +29,7 @@ uint64_t aggregate_linear_avx512(const uint64_t* array, uint64_t number, const u
   uint64_t r = 0;
 
   tmp = _mm512_setzero_si512();
-  for (int i = 0; i < number - 8 + 1; i += 8) {
+  for (uint64_t i = 0; i + 8 <= number; i += 8) {
     data = _mm512_load_epi64(reinterpret_cast<const __m512i *> (&array[i]));
     tmp = _mm512_add_epi64(data, tmp);
   }
@@ -46,8 +54,8 @@ uint64_t aggregate_strided_gather_avx512(const uint64_t* array, uint64_t number,
 
   const __m256i gatherindex = _mm256_set_epi32(7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
 
-  for (int j = 0; j < number; j += 8 * stride) {
-    for (int i = 0; i < stride; i++) {
+  for (uint64_t j = 0; j < number; j += 8 * stride) {
+    for (uint32_t i = 0; i < stride; i++) {
       data = _mm512_i32gather_epi64(gatherindex, reinterpret_cast<void const *> (&array[j + i]), 8);
       tmp = _mm512_add_epi64(data, tmp);
     }
@@ -68,10 +76,10 @@ uint64_t aggregate_indexed_gather_avx512_64(const uint64_t* array, uint64_t numb
   const __m256i gatherindex = _mm256_set_epi32(7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
 
 
-  for (int j = 0; j < number; j += 8 * stride) {
+  for (uint64_t j = 0; j < number; j += 8 * stride) {
     __m256i positions = _mm256_set_epi32(11, 13, 17, 19, 23, 29, 31, 37);
 
-    for (int i = 0; i < stride; i++) {
+    for (uint32_t i = 0; i < stride; i++) {
       __m256i gatherpos = _mm256_and_si256(positions, _mm256_set_epi32(63, 63, 63, 63, 63, 63, 63, 63));
       /*for (int x=0; x<8; x++) {
         std::cout <<_mm256_extract_epi32(gatherpos,0)<<" ";
@@ -105,10 +113,10 @@ uint64_t aggregate_indexed_gather_avx512(const uint64_t* array, uint64_t number,
   const __m256i fixed2 = _mm256_set_epi32(f+1, f+3, f+5, f+9, f+11, f+13, f+15, f+17);
 
 
-  for (int j = 0; j < number; j += 8 * stride_size) {
+  for (uint64_t j = 0; j < number; j += 8 * stride_size) {
     __m256i positions = _mm256_set_epi32(f+1, f+3, f+5, f+9, f+11, f+13, f+15, f+17);
 
-    for (int i = 0; i < stride_size; i++) {
+    for (uint64_t i = 0; i < stride_size; i++) {
       __m256i gatherpos = _mm256_and_si256(positions, fixed1);
       gatherpos = _mm256_add_epi32(gatherpos, gatherindex);
       data = _mm512_i32gather_epi64(gatherpos, reinterpret_cast<void const *> (&array[j]), 8);
@@ -132,8 +140,8 @@ uint64_t aggregate_strided_set_avx512(const uint64_t* array, uint64_t number, co
 
   tmp = _mm512_setzero_si512();
 
-  for (int j = 0; j < number; j += 8 * stride) {
-    for (int i = 0; i < stride; i++) {
+  for (uint64_t j = 0; j < number; j += 8 * stride) {
+    for (uint32_t i = 0; i < stride; i++) {
 			data = _mm512_set_epi64(array[j+i+7*stride],array[j+i+6*stride],array[j+i+5*stride],array[j+i+4*stride],array[j+i+3*stride],array[j+i+2*stride],array[j+i+stride],array[j+i]);
       tmp = _mm512_add_epi64(data, tmp);
     }
@@ -142,4 +150,666 @@ uint64_t aggregate_strided_set_avx512(const uint64_t* array, uint64_t number, co
   return _mm512_reduce_add_epi64 (tmp);
 }
 
+
+/**
+ * @brief avx512 strided access variant using gather instruction with 64 bit offsets
+ *
+ * like aggregate_strided_gather_avx512, but with 64 bit lane offsets (i64gather),
+ * to compare what the wider index costs: an index vector as wide as the
+ * data (no difference in lanes for 64 bit values).
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+uint64_t aggregate_strided_gather_i64_avx512(const uint64_t* array, uint64_t number, const uint32_t stride) {
+  __m512i tmp, data;
+
+  tmp = _mm512_setzero_si512();
+
+  const uint64_t s = stride;
+  const __m512i gatherindex = _mm512_set_epi64(7 * s, 6 * s, 5 * s, 4 * s, 3 * s, 2 * s, s, 0);
+
+  for (uint64_t j = 0; j < number; j += 8 * s) {
+    for (uint32_t i = 0; i < stride; i++) {
+      data = _mm512_i64gather_epi64(gatherindex, reinterpret_cast<void const *> (&array[j + i]), 8);
+      tmp = _mm512_add_epi64(data, tmp);
+    }
+  }
+  return _mm512_reduce_add_epi64(tmp);
+}
+
+/**
+ * @brief avx512 linear load variant for any number of values
+ *
+ * unaligned loads, the last (partial) vector is loaded with a mask,
+ * so no value is left out.
+ *
+ * @param array
+ * @param number
+ * @return uint64_t
+ */
+uint64_t aggregate_linear_masked_avx512(const uint64_t* array, uint64_t number, const uint32_t stride=0) {
+  __m512i tmp, data;
+
+  tmp = _mm512_setzero_si512();
+  uint64_t i = 0;
+  for (; i + 8 <= number; i += 8) {
+    data = _mm512_loadu_si512(reinterpret_cast<const void *> (&array[i]));
+    tmp = _mm512_add_epi64(data, tmp);
+  }
+  if (i < number) {
+    const __mmask8 valid = (__mmask8) ((1u << (number - i)) - 1);
+    data = _mm512_maskz_loadu_epi64(valid, reinterpret_cast<const void *> (&array[i]));
+    tmp = _mm512_add_epi64(data, tmp);
+  }
+
+  return _mm512_reduce_add_epi64(tmp);
+}
+
+/**
+ * @brief avx512 strided access variant using gather instruction, for any number of values
+ *
+ * like the variant without mask for the whole blocks of lanes * stride
+ * values, the last (partial) block is gathered with masks that leave out
+ * the lanes at or past number, so no value is left out (or read past the end).
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+uint64_t aggregate_strided_gather_masked_avx512(const uint64_t* array, uint64_t number, const uint32_t stride) {
+  __m512i tmp, data;
+
+  tmp = _mm512_setzero_si512();
+
+  const __m256i gatherindex = _mm256_set_epi32(7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
+  const uint64_t block = 8 * (uint64_t) stride;
+  const uint64_t whole = number / block * block;
+
+  for (uint64_t j = 0; j < whole; j += block) {
+    for (uint32_t i = 0; i < stride; i++) {
+      data = _mm512_i32gather_epi64(gatherindex, reinterpret_cast<void const *> (&array[j + i]), 8);
+      tmp = _mm512_add_epi64(data, tmp);
+    }
+  }
+
+  // lane k of gather i reads whole + i + k * stride, if that is below number
+  const uint64_t rest = number - whole;
+  for (uint32_t i = 0; i < stride && i < rest; i++) {
+    const __mmask8 valid = _mm256_cmplt_epu32_mask(gatherindex, _mm256_set1_epi32(rest - i));
+    data = _mm512_mask_i32gather_epi64(_mm512_setzero_si512(), valid, gatherindex, reinterpret_cast<void const *> (&array[whole + i]), 8);
+    tmp = _mm512_add_epi64(data, tmp);
+  }
+  return _mm512_reduce_add_epi64 (tmp);
+}
+
+/**
+ * @brief avx512 strided access variant using gather instruction, for a fixed stride
+ *
+ * like the variant with a run time stride, but the stride is a template
+ * argument, so the index vector is a constant and the compiler knows the
+ * trip count of the inner loop (and may unroll it).
+ *
+ * @param array
+ * @param number
+ * @param stride (ignored, Stride is used)
+ * @return uint64_t
+ */
+template <uint32_t Stride>
+uint64_t aggregate_strided_gather_static_avx512(const uint64_t* array, uint64_t number, const uint32_t stride) {
+  __m512i tmp, data;
+
+  tmp = _mm512_setzero_si512();
+
+  const __m256i gatherindex = _mm256_set_epi32(7 * Stride, 6 * Stride, 5 * Stride, 4 * Stride, 3 * Stride, 2 * Stride, Stride, 0);
+
+  for (uint64_t j = 0; j < number; j += 8 * Stride) {
+    for (uint32_t i = 0; i < Stride; i++) {
+      data = _mm512_i32gather_epi64(gatherindex, reinterpret_cast<void const *> (&array[j + i]), 8);
+      tmp = _mm512_add_epi64(data, tmp);
+    }
+  }
+  return _mm512_reduce_add_epi64 (tmp);
+}
+
+/**
+ * @brief avx512 strided access variant using gather instruction, dispatched to a fixed stride
+ *
+ * calls the instantiation for stride (see static_strides.cpp) through a
+ * jump table, the variant with a run time stride if there is none.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+template <uint32_t... Strides>
+uint64_t aggregate_strided_gather_static_avx512(const uint64_t* array, uint64_t number, const uint32_t stride, std::integer_sequence<uint32_t, Strides...>) {
+  static uint64_t (* const table[])(const uint64_t*, uint64_t, const uint32_t) = { aggregate_strided_gather_static_avx512<Strides>... };
+
+  const int slot = static_stride_slot(stride);
+  if (slot < 0) return aggregate_strided_gather_avx512(array, number, stride);
+  return table[slot](array, number, stride);
+}
+
+uint64_t aggregate_strided_gather_static_avx512(const uint64_t* array, uint64_t number, const uint32_t stride) {
+  return aggregate_strided_gather_static_avx512(array, number, stride, static_strides());
+}
+
+/**
+ * @brief avx512 strided access variant using set instruction, for a fixed stride
+ *
+ * like the variant with a run time stride, but the stride is a template
+ * argument, so the index vector is a constant and the compiler knows the
+ * trip count of the inner loop (and may unroll it).
+ *
+ * @param array
+ * @param number
+ * @param stride (ignored, Stride is used)
+ * @return uint64_t
+ */
+template <uint32_t Stride>
+uint64_t aggregate_strided_set_static_avx512(const uint64_t* array, uint64_t number, const uint32_t stride) {
+  __m512i tmp, data;
+
+  tmp = _mm512_setzero_si512();
+
+  for (uint64_t j = 0; j < number; j += 8 * Stride) {
+    for (uint32_t i = 0; i < Stride; i++) {
+			data = _mm512_set_epi64(array[j+i+7*Stride],array[j+i+6*Stride],array[j+i+5*Stride],array[j+i+4*Stride],array[j+i+3*Stride],array[j+i+2*Stride],array[j+i+Stride],array[j+i]);
+      tmp = _mm512_add_epi64(data, tmp);
+    }
+  }
+
+  return _mm512_reduce_add_epi64 (tmp);
+}
+
+/**
+ * @brief avx512 strided access variant using set instruction, dispatched to a fixed stride
+ *
+ * calls the instantiation for stride (see static_strides.cpp) through a
+ * jump table, the variant with a run time stride if there is none.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+template <uint32_t... Strides>
+uint64_t aggregate_strided_set_static_avx512(const uint64_t* array, uint64_t number, const uint32_t stride, std::integer_sequence<uint32_t, Strides...>) {
+  static uint64_t (* const table[])(const uint64_t*, uint64_t, const uint32_t) = { aggregate_strided_set_static_avx512<Strides>... };
+
+  const int slot = static_stride_slot(stride);
+  if (slot < 0) return aggregate_strided_set_avx512(array, number, stride);
+  return table[slot](array, number, stride);
+}
+
+uint64_t aggregate_strided_set_static_avx512(const uint64_t* array, uint64_t number, const uint32_t stride) {
+  return aggregate_strided_set_static_avx512(array, number, stride, static_strides());
+}
+
+/**
+ * @brief avx512 strided access variant using gather instruction, unrolled
+ *
+ * like the variant without unrolling, but issues Unroll gathers per loop
+ * iteration and adds them into Accumulators independent registers
+ * (round robin, Unroll has to be a multiple), so the adds do not form a
+ * single dependency chain. strides that are no multiple of Unroll get
+ * their remaining gathers one by one.
+ * flatten: see unrolled in unroll.cpp.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+template <unsigned Unroll, unsigned Accumulators>
+__attribute__((flatten))
+uint64_t aggregate_strided_gather_unrolled_avx512(const uint64_t* array, uint64_t number, const uint32_t stride) {
+  static_assert(Unroll % Accumulators == 0, "Unroll has to be a multiple of Accumulators");
+  __m512i tmp[Accumulators] = {};
+
+  const __m256i gatherindex = _mm256_set_epi32(7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
+
+  for (uint64_t j = 0; j < number; j += 8 * stride) {
+    uint64_t i = 0;
+    for (; i + Unroll <= stride; i += Unroll) {
+      unrolled<Unroll>([&] (auto u) {
+        constexpr unsigned a = decltype(u)::value % Accumulators;
+        tmp[a] = _mm512_add_epi64(_mm512_i32gather_epi64(gatherindex, reinterpret_cast<void const *> (&array[j + i + decltype(u)::value]), 8), tmp[a]);
+      });
+    }
+    for (; i < stride; i++) {
+      tmp[0] = _mm512_add_epi64(_mm512_i32gather_epi64(gatherindex, reinterpret_cast<void const *> (&array[j + i]), 8), tmp[0]);
+    }
+  }
+
+  unrolled<Accumulators - 1>([&] (auto a) { tmp[0] = _mm512_add_epi64(tmp[decltype(a)::value + 1], tmp[0]); });
+
+  return _mm512_reduce_add_epi64 (tmp[0]);
+}
+
+/**
+ * @brief avx512 strided access variant using gather instruction and software prefetching
+ *
+ * like the variant without prefetching, but prefetches the lanes of the gather
+ * prefetch_distance gathers ahead (once per cache line) with Hint:
+ * _MM_HINT_T0, _MM_HINT_T1 or _MM_HINT_NTA.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+template <_mm_hint Hint>
+uint64_t aggregate_strided_gather_prefetch_avx512(const uint64_t* array, uint64_t number, const uint32_t stride) {
+  __m512i tmp, data;
+
+  tmp = _mm512_setzero_si512();
+
+  const __m256i gatherindex = _mm256_set_epi32(7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
+  strided_cursor<uint64_t> ahead(stride, 8, prefetch_distance);
+
+  for (uint64_t j = 0; j < number; j += 8 * stride) {
+    for (uint64_t i = 0; i < stride; i++) {
+      if (ahead.new_lines()) ahead.prefetch<Hint>(array, 8);
+      ahead.next();
+      data = _mm512_i32gather_epi64(gatherindex, reinterpret_cast<void const *> (&array[j + i]), 8);
+      tmp = _mm512_add_epi64(data, tmp);
+    }
+  }
+  return _mm512_reduce_add_epi64 (tmp);
+}
+
+/**
+ * @brief avx512 strided access variant using set instruction and software prefetching
+ *
+ * like the variant without prefetching, but prefetches the lanes of the gather
+ * prefetch_distance gathers ahead (once per cache line) with Hint:
+ * _MM_HINT_T0, _MM_HINT_T1 or _MM_HINT_NTA.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+template <_mm_hint Hint>
+uint64_t aggregate_strided_set_prefetch_avx512(const uint64_t* array, uint64_t number, const uint32_t stride) {
+  __m512i tmp, data;
+
+  tmp = _mm512_setzero_si512();
+  strided_cursor<uint64_t> ahead(stride, 8, prefetch_distance);
+
+  for (uint64_t j = 0; j < number; j += 8 * stride) {
+    for (uint64_t i = 0; i < stride; i++) {
+      if (ahead.new_lines()) ahead.prefetch<Hint>(array, 8);
+      ahead.next();
+			data = _mm512_set_epi64(array[j+i+7*stride],array[j+i+6*stride],array[j+i+5*stride],array[j+i+4*stride],array[j+i+3*stride],array[j+i+2*stride],array[j+i+stride],array[j+i]);
+      tmp = _mm512_add_epi64(data, tmp);
+    }
+  }
+
+  return _mm512_reduce_add_epi64 (tmp);
+}
+
+/**
+ * @brief avx512 linear store variant, baseline for the scatter variants
+ *
+ * writes every position's index into it,
+ * returns the sum of all written values for checksumming.
+ *
+ * @param array
+ * @param number
+ * @return uint64_t
+ */
+
+uint64_t scatter_linear_avx512(uint64_t* array, uint64_t number, const uint32_t stride=0) {
+  __m512i tmp, data;
+
+  const __m512i step = _mm512_set1_epi64(8);
+  tmp  = _mm512_setzero_si512();
+  data = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+  for (uint64_t i = 0; i + 8 <= number; i += 8) {
+    _mm512_store_epi64(reinterpret_cast<__m512i *> (&array[i]), data);
+    tmp  = _mm512_add_epi64(data, tmp);
+    data = _mm512_add_epi64(data, step);
+  }
+
+  return _mm512_reduce_add_epi64(tmp);
+}
+
+/**
+ * @brief avx512 strided store variant using scatter instruction
+ *
+ * writes every position's index into it,
+ * returns the sum of all written values for checksumming.
+ *
+ * @param array
+ * @param number
+ * @param stride
+ * @return uint64_t
+ */
+uint64_t scatter_strided_avx512(uint64_t* array, uint64_t number, const uint32_t stride) {
+  __m512i tmp, data;
+
+  const __m256i scatterindex = _mm256_set_epi32(7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
+  const __m512i lane_positions = _mm512_set_epi64(7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
+  const __m512i one = _mm512_set1_epi64(1);
+  tmp = _mm512_setzero_si512();
+
+  for (uint64_t j = 0; j < number; j += 8 * stride) {
+    data = _mm512_add_epi64(lane_positions, _mm512_set1_epi64(j));
+    for (uint64_t i = 0; i < stride; i++) {
+      _mm512_i32scatter_epi64(reinterpret_cast<void *> (&array[j + i]), scatterindex, data, 8);
+      tmp  = _mm512_add_epi64(data, tmp);
+      data = _mm512_add_epi64(data, one);
+    }
+  }
+
+  return _mm512_reduce_add_epi64(tmp);
+}
+
+/**
+ * @brief avx512 lookup variant using gather instruction
+ *
+ * sums up the values at the positions in index (32 bit offsets, below 2**31),
+ * e.g. foreign key lookups or late materialization.
+ *
+ * @param array
+ * @param index
+ * @param number of positions in index
+ * @return uint64_t
+ */
+uint64_t lookup_gather_avx512(const uint64_t* array, const uint32_t* index, uint64_t number) {
+  __m512i tmp, data;
+  __m256i positions;
+
+  tmp = _mm512_setzero_si512();
+  for (uint64_t i = 0; i + 8 <= number; i += 8) {
+    positions = _mm256_loadu_si256(reinterpret_cast<const __m256i *> (&index[i]));
+    data = _mm512_i32gather_epi64(positions, reinterpret_cast<void const *> (array), 8);
+    tmp  = _mm512_add_epi64(data, tmp);
+  }
+
+  return _mm512_reduce_add_epi64(tmp);
+}
+
+/**
+ * @brief avx512 lookup variant using gather instruction
+ *
+ * sums up the values at the positions in index (64 bit offsets),
+ * e.g. foreign key lookups or late materialization.
+ *
+ * @param array
+ * @param index
+ * @param number of positions in index
+ * @return uint64_t
+ */
+uint64_t lookup_gather_avx512(const uint64_t* array, const uint64_t* index, uint64_t number) {
+  __m512i tmp, positions, data;
+
+  tmp = _mm512_setzero_si512();
+  for (uint64_t i = 0; i + 8 <= number; i += 8) {
+    positions = _mm512_loadu_si512(reinterpret_cast<void const *> (&index[i]));
+    data = _mm512_i64gather_epi64(positions, reinterpret_cast<void const *> (array), 8);
+    tmp  = _mm512_add_epi64(data, tmp);
+  }
+
+  return _mm512_reduce_add_epi64(tmp);
+}
+
+/**
+ * @brief avx512 lookup variant using gather instruction and software prefetching
+ *
+ * like the variant without prefetching (32 bit offsets), but prefetches the
+ * values prefetch_distance gathers ahead into L1, once the index is that far.
+ *
+ * @param array
+ * @param index
+ * @param number of positions in index
+ * @return uint64_t
+ */
+uint64_t lookup_gather_prefetch_avx512(const uint64_t* array, const uint32_t* index, uint64_t number) {
+  __m512i tmp, data;
+  __m256i positions;
+
+  const uint64_t ahead = prefetch_distance * 8;
+  tmp = _mm512_setzero_si512();
+  for (uint64_t i = 0; i + 8 <= number; i += 8) {
+    if (i + ahead + 8 <= number) prefetch_positions<_MM_HINT_T0>(array, &index[i + ahead], 8);
+    positions = _mm256_loadu_si256(reinterpret_cast<const __m256i *> (&index[i]));
+    data = _mm512_i32gather_epi64(positions, reinterpret_cast<void const *> (array), 8);
+    tmp  = _mm512_add_epi64(data, tmp);
+  }
+
+  return _mm512_reduce_add_epi64(tmp);
+}
+
+/**
+ * @brief avx512 lookup variant using gather instruction and software prefetching
+ *
+ * like the variant without prefetching (64 bit offsets), but prefetches the
+ * values prefetch_distance gathers ahead into L1, once the index is that far.
+ *
+ * @param array
+ * @param index
+ * @param number of positions in index
+ * @return uint64_t
+ */
+uint64_t lookup_gather_prefetch_avx512(const uint64_t* array, const uint64_t* index, uint64_t number) {
+  __m512i tmp, positions, data;
+
+  const uint64_t ahead = prefetch_distance * 8;
+  tmp = _mm512_setzero_si512();
+  for (uint64_t i = 0; i + 8 <= number; i += 8) {
+    if (i + ahead + 8 <= number) prefetch_positions<_MM_HINT_T0>(array, &index[i + ahead], 8);
+    positions = _mm512_loadu_si512(reinterpret_cast<void const *> (&index[i]));
+    data = _mm512_i64gather_epi64(positions, reinterpret_cast<void const *> (array), 8);
+    tmp  = _mm512_add_epi64(data, tmp);
+  }
+
+  return _mm512_reduce_add_epi64(tmp);
+}
+
+/**
+ * @brief avx512 lookup variant using set instruction
+ *
+ * sums up the values at the positions in index (32 or 64 bit offsets),
+ * e.g. foreign key lookups or late materialization.
+ *
+ * @param array
+ * @param index
+ * @param number of positions in index
+ * @return uint64_t
+ */
+template <class IndexT>
+uint64_t lookup_set_avx512(const uint64_t* array, const IndexT* index, uint64_t number) {
+  __m512i tmp, data;
+
+  tmp = _mm512_setzero_si512();
+  for (uint64_t i = 0; i + 8 <= number; i += 8) {
+    data = _mm512_set_epi64(array[index[i+7]], array[index[i+6]], array[index[i+5]], array[index[i+4]], array[index[i+3]], array[index[i+2]], array[index[i+1]], array[index[i]]);
+    tmp  = _mm512_add_epi64(data, tmp);
+  }
+
+  return _mm512_reduce_add_epi64(tmp);
+}
+
+/**
+ * @brief avx512 group-by sum using conflict detection
+ *
+ * like the 32 bit variant, for 8 keys at a time (zero extended to 64 bit
+ * for conflict_epi64, at most 3 steps).
+ *
+ * @param values
+ * @param keys below bucket_count
+ * @param number of keys
+ * @param buckets
+ * @param bucket_count
+ * @return uint64_t
+ */
+template <bool Histogram>
+uint64_t groupby_conflict_avx512(const uint64_t* values, const uint32_t* keys, uint64_t number, uint64_t* buckets, uint64_t bucket_count) {
+  __m512i sum, add;
+  const __m512i one = _mm512_set1_epi64(1);
+  const __m512i last = _mm512_set1_epi64(63);
+
+  sum = _mm512_setzero_si512();
+  uint64_t i = 0;
+  for (; i + 8 <= number; i += 8) {
+    const __m256i key = _mm256_loadu_si256(reinterpret_cast<const __m256i *> (&keys[i]));
+    add = Histogram ? one : _mm512_loadu_si512(reinterpret_cast<const void *> (&values[i]));
+    sum = _mm512_add_epi64(add, sum);
+
+    const __m512i conflicts = _mm512_conflict_epi64(_mm512_cvtepu32_epi64(key));
+    __mmask8 pending = _mm512_test_epi64_mask(conflicts, conflicts);
+    // the nearest earlier lane with the same key, -1 if there is none
+    __m512i previous = _mm512_sub_epi64(last, _mm512_lzcnt_epi64(conflicts));
+    while (pending) {
+      // the lanes whose previous lane still has an earlier one with its key
+      const __mmask8 next = _mm512_mask_test_epi64_mask(pending, _mm512_sllv_epi64(one, previous), _mm512_set1_epi64(pending));
+      add = _mm512_mask_add_epi64(add, pending, add, _mm512_permutexvar_epi64(previous, add));
+      previous = _mm512_mask_permutexvar_epi64(previous, pending, previous, previous);
+      pending = next;
+    }
+
+    const __m512i bucket = _mm512_i32gather_epi64(key, reinterpret_cast<void const *> (buckets), 8);
+    _mm512_i32scatter_epi64(reinterpret_cast<void *> (buckets), key, _mm512_add_epi64(bucket, add), 8);
+  }
+
+  return _mm512_reduce_add_epi64(sum) + groupby_scalar<Histogram>(values + i, keys + i, number - i, buckets, bucket_count);
+}
+
+/**
+ * @brief avx512 hash table probe, vertical: 8 keys at a time
+ *
+ * every lane probes its own key, from its probe_start slot on: lanes that
+ * found their key or an empty slot get the next keys of the input (expand
+ * load), the others go on with their next slot, so no lane idles while
+ * others resolve collisions. Gather loads the slots with a gather,
+ * otherwise with scalar loads into set_epi64. the keys still in the lanes
+ * once the input runs short, and the rest of the input, are probed scalar.
+ *
+ * @param table
+ * @param keys to look up
+ * @param number of keys
+ * @return uint64_t sum of the values of the keys found
+ */
+template <bool Gather>
+uint64_t probe_vertical_avx512(const hash_table<uint64_t>& table, const uint64_t* keys, uint64_t number) {
+  const __m512i zero = _mm512_setzero_si512();
+  const __m512i one = _mm512_set1_epi64(1);
+  const __m512i slot_mask = _mm512_set1_epi64(table.slots() - 1);
+  // the upper halves are 0, so mullo_epi32 multiplies the lower 32 bits of
+  // the keys into the lower halves and clears the upper ones, like probe_start
+  // (mullo_epi64 would need AVX512DQ)
+  const __m512i multiplier = _mm512_set1_epi64(PROBE_HASH_MULTIPLIER);
+  const __m128i hash_shift = _mm_cvtsi64_si128(32 - table.slots_log2 + table.bucket_log2);
+  const __m128i bucket_shift = _mm_cvtsi64_si128(table.bucket_log2);
+  alignas(64) uint64_t lane_slots[8];
+  alignas(64) uint64_t lane_keys[8];
+  __m512i tmp, probe, slot, found, data;
+  __mmask8 active, refill, hit, empty;
+
+  tmp = probe = slot = zero;
+  active = 0;
+  uint64_t i = 0;
+  for (;;) {
+    refill = (__mmask8) ~active;
+    const uint64_t fill = __builtin_popcount(refill);
+    if (i + fill > number) break;
+    probe = _mm512_mask_expandloadu_epi64(probe, refill, &keys[i]);
+    i += fill;
+    slot = _mm512_mask_mov_epi64(slot, refill,
+      _mm512_sll_epi64(_mm512_srl_epi64(_mm512_mullo_epi32(probe, multiplier), hash_shift), bucket_shift));
+    if (Gather) {
+      found = _mm512_i64gather_epi64(slot, reinterpret_cast<void const *> (table.keys), 8);
+    } else {
+      _mm512_store_si512(lane_slots, slot);
+      found = _mm512_set_epi64(table.keys[lane_slots[7]], table.keys[lane_slots[6]], table.keys[lane_slots[5]], table.keys[lane_slots[4]], table.keys[lane_slots[3]], table.keys[lane_slots[2]], table.keys[lane_slots[1]], table.keys[lane_slots[0]]);
+    }
+    hit = _mm512_cmpeq_epi64_mask(found, probe);
+    empty = _mm512_cmpeq_epi64_mask(found, zero);
+    if (hit != 0) {
+      if (Gather) {
+        data = _mm512_mask_i64gather_epi64(zero, hit, slot, reinterpret_cast<void const *> (table.values), 8);
+      } else {
+        data = _mm512_maskz_mov_epi64(hit, _mm512_set_epi64(table.values[lane_slots[7]], table.values[lane_slots[6]], table.values[lane_slots[5]], table.values[lane_slots[4]], table.values[lane_slots[3]], table.values[lane_slots[2]], table.values[lane_slots[1]], table.values[lane_slots[0]]));
+      }
+      tmp = _mm512_add_epi64(data, tmp);
+    }
+    active = (__mmask8) ~(hit | empty);
+    slot = _mm512_and_si512(_mm512_add_epi64(slot, one), slot_mask);
+  }
+
+  uint64_t res = _mm512_reduce_add_epi64(tmp);
+  _mm512_store_si512(lane_keys, probe);
+  _mm512_store_si512(lane_slots, slot);
+  for (uint32_t lane = 0; lane < 8; lane++) {
+    if (active >> lane & 1) res += probe_from(table, lane_keys[lane], lane_slots[lane]);
+  }
+
+  return res + probe_scalar(table, keys + i, number - i);
+}
+
+/**
+ * @brief avx512 hash table probe, horizontal: one key at a time
+ *
+ * for the buckets layout: compares the key with the 8 slots of its bucket
+ * (one cache line) at once, then with the next bucket until the key or an
+ * empty slot is among them.
+ *
+ * @param table in the buckets layout
+ * @param keys to look up
+ * @param number of keys
+ * @return uint64_t sum of the values of the keys found
+ */
+uint64_t probe_bucket_avx512(const hash_table<uint64_t>& table, const uint64_t* keys, uint64_t number) {
+  const __m512i zero = _mm512_setzero_si512();
+  const uint64_t slot_mask = table.slots() - 1;
+  __m512i probe, bucket;
+
+  uint64_t res = 0;
+  for (uint64_t i = 0; i < number; i++) {
+    probe = _mm512_set1_epi64(keys[i]);
+    for (uint64_t slot = probe_start(keys[i], table.slots_log2, table.bucket_log2); ; slot = (slot + 8) & slot_mask) {
+      bucket = _mm512_loadu_si512(reinterpret_cast<void const *> (&table.keys[slot]));
+      const __mmask8 hit = _mm512_cmpeq_epi64_mask(bucket, probe);
+      if (hit != 0) {
+        res += table.values[slot + __builtin_ctz(hit)];
+        break;
+      }
+      if (_mm512_cmpeq_epi64_mask(bucket, zero) != 0) break;
+    }
+  }
+
+  return res;
+}
+
+/**
+ * @brief avx512 pointer chase, 8 chains at once
+ *
+ * every lane follows its own chain through next, from starts[lane] on: the
+ * positions of one gather are the values of the previous one, so the hops
+ * are dependent loads, 8 of them in flight.
+ *
+ * @param next the cycle
+ * @param starts 8 positions
+ * @param hops gathers per lane
+ * @return uint64_t sum of the positions the lanes end at
+ */
+uint64_t chase_gather_avx512(const uint64_t* next, const uint64_t* starts, uint64_t hops) {
+  __m512i positions;
+
+  positions = _mm512_loadu_si512(reinterpret_cast<void const *> (starts));
+  for (uint64_t h = 0; h < hops; h++) {
+    positions = _mm512_i64gather_epi64(positions, reinterpret_cast<void const *> (next), 8);
+  }
+
+  return _mm512_reduce_add_epi64(positions);
+}
+
 #endif /* AGG_AVX512_64BITVARIANTS_H */
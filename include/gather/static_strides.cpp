@@ -0,0 +1,34 @@
+#ifndef STATIC_STRIDES_CPP
+#define STATIC_STRIDES_CPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/** the strides the *_static kernels are compiled for, each one with the
+ * stride as a template argument (constant gather index, trip count known
+ * to the compiler): all up to 16, a few record widths and the powers of
+ * two of the default sweep. other strides run the generic kernel.
+ */
+using static_strides = std::integer_sequence<uint32_t,
+	1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,
+	24, 32, 48, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768>;
+
+template <uint32_t... Strides>
+int static_stride_slot(uint32_t stride, std::integer_sequence<uint32_t, Strides...>) {
+	const uint32_t strides[] = { Strides... };
+	for (size_t slot = 0; slot < sizeof...(Strides); slot++) {
+		if (strides[slot] == stride) return slot;
+	}
+	return -1;
+}
+
+/** the position of stride in static_strides (and so in the jump tables of
+ * the *_static kernels), -1 if there is no kernel compiled for it.
+ */
+inline int static_stride_slot(uint32_t stride) {
+	return static_stride_slot(stride, static_strides());
+}
+
+
+#endif // include guard STATIC_STRIDES_CPP
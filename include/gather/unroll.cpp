@@ -0,0 +1,25 @@
+#ifndef UNROLL_CPP
+#define UNROLL_CPP
+
+#include <utility>
+
+/** calls step(std::integral_constant<unsigned, u>()) for u = 0, 1, ... N - 1,
+ * unrolled at compile time, so step can index arrays of registers with
+ * decltype(u)::value and the compiler keeps them in registers.
+ * the vector kernels using it are __attribute__((flatten)): this function
+ * is compiled for the baseline, the steps for the kernel's instruction set,
+ * so they are only inlined into it if everything is inlined into the kernel.
+ */
+template <class Step, unsigned... U>
+inline void unrolled(const Step& step, std::integer_sequence<unsigned, U...>) {
+	int expand[] = { 0, (step(std::integral_constant<unsigned, U>()), 0)... };
+	(void) expand;
+}
+
+template <unsigned N, class Step>
+inline void unrolled(const Step& step) {
+	unrolled(step, std::make_integer_sequence<unsigned, N>());
+}
+
+
+#endif // include guard UNROLL_CPP
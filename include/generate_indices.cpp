@@ -0,0 +1,206 @@
+#ifndef GENERATE_INDICES_CPP
+#define GENERATE_INDICES_CPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+
+/** patterns of the positions the lookup kernels read:
+ * uniform: uniformly random over all values,
+ * zipf: zipf distributed ranks (a few values are looked up very often),
+ *   scattered over the values, like popular foreign keys,
+ * sorted: uniform, but ascending, like lookups after sorting the keys,
+ * clustered: groups of LOOKUP_CLUSTER_SIZE random positions within one
+ *   random 4 KiB page,
+ * holes: ascending positions from the start to the end of the values, like
+ *   late materialization after a filter that passes every row with a
+ *   probability of selectivity: the rows such a filter passes, stretched
+ *   over the values.
+ */
+enum index_distribution {
+	INDEX_UNIFORM,
+	INDEX_ZIPF,
+	INDEX_SORTED,
+	INDEX_CLUSTERED,
+	INDEX_HOLES,
+	NUMBER_OF_INDEX_DISTRIBUTIONS,
+};
+
+constexpr uint64_t LOOKUP_CLUSTER_SIZE = 16;
+constexpr uint64_t LOOKUP_PAGE_BYTES = 4096;
+
+std::string index_distribution_name(index_distribution distribution) {
+	switch (distribution) {
+		case INDEX_UNIFORM:   return "uniform";
+		case INDEX_ZIPF:      return "zipf";
+		case INDEX_SORTED:    return "sorted";
+		case INDEX_CLUSTERED: return "clustered";
+		case INDEX_HOLES:     return "holes";
+		default:              return "unknown";
+	}
+}
+
+/** sets distribution according to name (see index_distribution_name),
+ * returns false (and leaves distribution as it is) for an unknown name.
+ */
+bool parse_index_distribution(const std::string& name, index_distribution* distribution) {
+	for (int candidate = 0; candidate < NUMBER_OF_INDEX_DISTRIBUTIONS; candidate++) {
+		if (name == index_distribution_name((index_distribution) candidate)) {
+			*distribution = (index_distribution) candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+/** zipf distributed ranks 1..number_of_elements with the given exponent
+ * (> 0), sampled in constant time and memory by rejection-inversion
+ * (Hörmann and Derflinger, "Rejection-inversion to generate variates from
+ * monotone discrete distributions", 1996), as the table of a cdf over 2**30
+ * elements would be larger than the data.
+ */
+class zipf_distribution {
+	double exponent;
+	double number_of_elements;
+	double h_integral_x1;
+	double h_integral_number_of_elements;
+	double s;
+
+	// log1p(x) / x, exact around 0
+	static double helper1(double x) {
+		if (std::fabs(x) > 1e-8) return std::log1p(x) / x;
+		return 1 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+	}
+
+	// expm1(x) / x, exact around 0
+	static double helper2(double x) {
+		if (std::fabs(x) > 1e-8) return std::expm1(x) / x;
+		return 1 + x * 0.5 * (1 + x * (1.0 / 3.0) * (1 + 0.25 * x));
+	}
+
+	double h(double x) const {
+		return std::exp(-exponent * std::log(x));
+	}
+
+	double h_integral(double x) const {
+		const double log_x = std::log(x);
+		return helper2((1 - exponent) * log_x) * log_x;
+	}
+
+	double h_integral_inverse(double x) const {
+		double t = x * (1 - exponent);
+		if (t < -1) t = -1;
+		return std::exp(helper1(t) * x);
+	}
+
+public:
+	zipf_distribution(uint64_t number_of_elements, double exponent) :
+		exponent(exponent),
+		number_of_elements(number_of_elements),
+		h_integral_x1(h_integral(1.5) - 1),
+		h_integral_number_of_elements(h_integral(number_of_elements + 0.5)),
+		s(2 - h_integral_inverse(h_integral(2.5) - h(2)))
+	{}
+
+	template <class Generator>
+	uint64_t operator()(Generator& generator) {
+		std::uniform_real_distribution<double> uniform(0, 1);
+		while (true) {
+			const double u = h_integral_number_of_elements
+				+ uniform(generator) * (h_integral_x1 - h_integral_number_of_elements);
+			const double x = h_integral_inverse(u);
+			double k = std::floor(x + 0.5);
+			if (k < 1) k = 1;
+			if (k > number_of_elements) k = number_of_elements;
+			if (k - x <= s || u >= h_integral(k + 0.5) - h(k)) return (uint64_t) k;
+		}
+	}
+};
+
+/** parameters of the distributions that have some */
+struct index_parameters {
+	double zipf_exponent = 0.99;
+	double selectivity = 0.5;
+};
+
+inline uint64_t greatest_common_divisor(uint64_t a, uint64_t b) {
+	while (b != 0) {
+		const uint64_t r = a % b;
+		a = b;
+		b = r;
+	}
+	return a;
+}
+
+/** writes number positions into values_count values, each of value_bytes
+ * bytes, distributed as distribution, into index.
+ * the zipf ranks are scattered over the values by multiplying with a number
+ * coprime to values_count (modulo values_count), which is a permutation.
+ * the same seed gives the same positions for every distribution.
+ */
+template <class IndexT>
+void generate_indices(
+	IndexT* index,
+	uint64_t number,
+	uint64_t values_count,
+	uint64_t value_bytes,
+	index_distribution distribution,
+	const index_parameters& parameters,
+	uint64_t seed
+) {
+	// another stream than the values' for every distribution
+	std::mt19937_64 gen(seed ^ (0x5DEECE66Dull * (distribution + 1)));
+	std::uniform_int_distribution<uint64_t> position(0, values_count - 1);
+
+	switch (distribution) {
+		case INDEX_UNIFORM:
+			for (uint64_t i = 0; i < number; i++) index[i] = position(gen);
+			break;
+		case INDEX_SORTED:
+			for (uint64_t i = 0; i < number; i++) index[i] = position(gen);
+			std::sort(index, index + number);
+			break;
+		case INDEX_ZIPF: {
+			zipf_distribution rank(values_count, parameters.zipf_exponent);
+			uint64_t multiplier = 0x9E3779B97F4A7C15ull % values_count;
+			while (greatest_common_divisor(multiplier, values_count) != 1) multiplier++;
+			for (uint64_t i = 0; i < number; i++) {
+				index[i] = (uint64_t) ((unsigned __int128) (rank(gen) - 1) * multiplier % values_count);
+			}
+			break;
+		}
+		case INDEX_CLUSTERED: {
+			const uint64_t page_values = std::min(values_count, LOOKUP_PAGE_BYTES / value_bytes);
+			std::uniform_int_distribution<uint64_t> page(0, values_count / page_values - 1);
+			std::uniform_int_distribution<uint64_t> in_page(0, page_values - 1);
+			uint64_t page_begin = 0;
+			for (uint64_t i = 0; i < number; i++) {
+				if (i % LOOKUP_CLUSTER_SIZE == 0) page_begin = page(gen) * page_values;
+				index[i] = page_begin + in_page(gen);
+			}
+			break;
+		}
+		case INDEX_HOLES: {
+			// number of skipped rows before each passed one
+			std::geometric_distribution<uint64_t> skipped(parameters.selectivity);
+			uint64_t row = 0;
+			for (uint64_t i = 0; i < number; i++) {
+				row += skipped(gen);
+				index[i] = row++;
+			}
+			// row is past the last passed one, so the positions stay below values_count
+			for (uint64_t i = 0; i < number; i++) {
+				index[i] = (uint64_t) ((unsigned __int128) index[i] * values_count / row);
+			}
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+
+#endif // include guard GENERATE_INDICES_CPP
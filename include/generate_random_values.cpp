@@ -1,30 +1,72 @@
 #ifndef GENERATE_RANDOM_VALUES_CPP
 #define GENERATE_RANDOM_VALUES_CPP
 
-/** uses std::mt19937 seeded with std::random_device and the current time
- * to write values from a std::uniform_int_distribution into
- * all number fields of the array
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "thread_pool.cpp"
+
+/** counter based random numbers: the i-th number of the stream of seed is a
+ * hash (the finalizer of splitmix64) of seed and i, so every thread can
+ * generate any part of the values, and they are the same for any number of
+ * threads.
+ */
+inline uint64_t counter_random(uint64_t seed, uint64_t i) {
+	uint64_t z = seed + (i + 1) * 0x9E3779B97F4A7C15ull;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+// the values are 1..6 unless --max-value says otherwise
+constexpr uint64_t DEFAULT_MAX_VALUE = 6;
+
+/** the i-th value of the data of seed, uniform in 1..max_value */
+template <typename T>
+inline T random_value(uint64_t seed, uint64_t i, uint64_t max_value = DEFAULT_MAX_VALUE) {
+	return 1 + (T) (((unsigned __int128) counter_random(seed, i) * max_value) >> 64);
+}
+
+/** a seed from std::random_device and the current time,
+ * for runs without --seed.
+ */
+inline uint64_t random_seed() {
+	std::random_device rd;
+	return ((uint64_t) rd() << 32 | rd()) ^ (uint64_t)
+		std::chrono::high_resolution_clock::now().time_since_epoch().count();
+}
+
+/** writes random_value(seed, i, max_value) into every number field of the
+ * array (max_value at most the largest T), on all workers of the pool, each
+ * on its own contiguous part (which it touches first, so its pages are on
+ * the worker's node unless the memory is bound somewhere), and returns the
+ * sum over the values in 64 bit, like aggregate_scalar_wide (the sum of
+ * aggregate_scalar is its lower bits).
  */
 template <typename T>
-void generate_random_values(T* array, uint64_t number) {
-  static_assert(is_integral<T>::value, "Data type is not integral.");
-  std::random_device rd;
-  std::mt19937::result_type seed = rd() ^ (
-          (std::mt19937::result_type)
-          std::chrono::duration_cast<std::chrono::seconds>(
-          std::chrono::system_clock::now().time_since_epoch()
-          ).count() +
-          (std::mt19937::result_type)
-          std::chrono::duration_cast<std::chrono::microseconds>(
-          std::chrono::high_resolution_clock::now().time_since_epoch()
-          ).count());
-
-  std::mt19937 gen(seed);
-  std::uniform_int_distribution<T> distrib(1, 6);
-
-  for (uint64_t j = 0; j < number; ++j) {
-    array[j] = distrib(gen);
-  }
+uint64_t generate_random_values(thread_pool& pool, T* array, uint64_t number, uint64_t seed, uint64_t max_value = DEFAULT_MAX_VALUE) {
+  static_assert(std::is_integral<T>::value, "Data type is not integral.");
+  const size_t workers = pool.size();
+  // one cache line per worker
+  std::vector< uint64_t > sums( workers * 8 );
+
+  pool.run( workers, [array, number, seed, max_value, workers, &sums] ( const uint64_t tid ) {
+    const uint64_t begin = number * tid / workers;
+    const uint64_t end = number * ( tid + 1 ) / workers;
+    uint64_t sum = 0;
+    for (uint64_t j = begin; j < end; ++j) {
+      array[j] = random_value<T>(seed, j, max_value);
+      sum += array[j];
+    }
+    sums[ tid * 8 ] = sum;
+  } );
+
+  uint64_t total = 0;
+  for (size_t tid = 0; tid < workers; tid++) total += sums[ tid * 8 ];
+  return total;
 }
 
 
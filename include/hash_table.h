@@ -0,0 +1,82 @@
+#ifndef HASH_TABLE_H
+#define HASH_TABLE_H
+
+#include <cstdint>
+#include <string>
+
+/** layouts of the open addressing hash tables the probe kernels read:
+ * linear: linear probing, from the slot the key hashes to,
+ * buckets: the key hashes to a bucket of one cache line (TABLE_BUCKET_BYTES)
+ *   of slots, which is searched as a whole, then the next bucket.
+ */
+enum table_layout {
+	LAYOUT_LINEAR,
+	LAYOUT_BUCKETS,
+	NUMBER_OF_TABLE_LAYOUTS,
+};
+
+constexpr uint64_t TABLE_BUCKET_BYTES = 64;
+constexpr uint32_t PROBE_HASH_MULTIPLIER = 0x9E3779B1u;
+
+std::string table_layout_name(table_layout layout) {
+	switch (layout) {
+		case LAYOUT_LINEAR:  return "linear";
+		case LAYOUT_BUCKETS: return "buckets";
+		default:             return "unknown";
+	}
+}
+
+/** sets layout according to name (see table_layout_name),
+ * returns false (and leaves layout as it is) for an unknown name.
+ */
+bool parse_table_layout(const std::string& name, table_layout* layout) {
+	for (int candidate = 0; candidate < NUMBER_OF_TABLE_LAYOUTS; candidate++) {
+		if (name == table_layout_name((table_layout) candidate)) {
+			*layout = (table_layout) candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+/** an open addressing hash table of 2**slots_log2 slots, the keys and their
+ * values (the payload) in two arrays, key 0 marks an empty slot.
+ * a key is searched from probe_start on, slot by slot (wrapping around at
+ * the end), until it or an empty slot comes up; the table is never full.
+ * in the buckets layout, probe_start is the first slot of a bucket of
+ * 2**bucket_log2 slots (0 for linear probing).
+ */
+template <class ResultT>
+struct hash_table {
+	table_layout layout;
+	uint64_t slots_log2;
+	uint64_t bucket_log2;
+	uint64_t entries;
+	ResultT* keys;
+	ResultT* values;
+
+	uint64_t slots() const { return (uint64_t) 1 << slots_log2; }
+};
+
+/** the first slot of key: a multiplicative hash of its lower 32 bits to one
+ * of the 2**(slots_log2 - bucket_log2) buckets. the vector kernels compute
+ * the same with a 32 bit multiplication and shifts.
+ */
+inline uint64_t probe_start(uint64_t key, uint64_t slots_log2, uint64_t bucket_log2) {
+	return ((uint64_t) ((uint32_t) key * PROBE_HASH_MULTIPLIER) >> (32 - slots_log2 + bucket_log2)) << bucket_log2;
+}
+
+/** the key of the i-th entry of a table: a bijection of the 32 bit numbers
+ * (odd multiplications and xor shifts), so the keys of different i differ,
+ * and only table_key(0) is 0.
+ */
+inline uint32_t table_key(uint32_t i) {
+	uint32_t key = i * 0x2C1B3C6Du;
+	key ^= key >> 15;
+	key *= 0x297A2D39u;
+	key ^= key >> 16;
+	return key;
+}
+
+
+#endif // include guard HASH_TABLE_H
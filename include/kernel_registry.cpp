@@ -0,0 +1,314 @@
+#ifndef KERNEL_REGISTRY_CPP
+#define KERNEL_REGISTRY_CPP
+
+#include <cstdint>
+#include <cstring>
+#include <math.h>
+#include <immintrin.h>
+#include <string>
+#include <vector>
+
+// the scalar kernels are compiled for the baseline, they run everywhere.
+// they have to be included before the target pragmas below, so the
+// include guards keep the kernel headers from pulling them in there.
+#include "gather/aggregate_scalar.cpp"
+#include "gather/scatter_scalar.cpp"
+#include "gather/lookup_scalar.cpp"
+#include "gather/groupby_scalar.cpp"
+#include "gather/probe_scalar.cpp"
+#include "gather/chase_scalar.cpp"
+#include "gather/prefetch.cpp"
+#include "gather/unroll.cpp"
+#include "gather/static_strides.cpp"
+#include "aggregation_type.h"
+#include "cpu_features.cpp"
+
+// the binary itself is built for the baseline (so it starts on every x86-64
+// machine), the vector kernels are compiled for their instruction sets here
+// and only called if isa_supported() says so.
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#include "gather/simd_variants/avx/agg_avx_32BitVariants.h"
+#include "gather/simd_variants/avx/agg_avx_64BitVariants.h"
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2,avx512f,avx512cd,avx512vl")
+#include "gather/simd_variants/avx512/agg_avx512_32BitVariants.h"
+#include "gather/simd_variants/avx512/agg_avx512_64BitVariants.h"
+#pragma GCC pop_options
+
+/** the kernels compiled for one instruction set, benchmarked together
+ * (and written into the same result files).
+ * the aggregators run over the strides, the lookups over the index
+ * distributions (see generate_indices.cpp), the group-by kernels over the
+ * bucket counts and key distributions, the probe kernels over the hash
+ * table sizes, layouts and hit rates, the chases over the working sets.
+ */
+template <class ResultT>
+struct kernel_set {
+	cpu_isa isa;
+	vector<aggregator_t<ResultT>> aggregators;
+	vector<lookup_kernel<ResultT>> lookups;
+	vector<groupby_kernel<ResultT>> groupbys;
+	vector<probe_kernel<ResultT>> probes;
+	vector<chase_kernel<ResultT>> chases;
+};
+
+/** every kernel for elements of type ResultT, grouped by instruction set.
+ * the labels are the same across the sets, so --kernels=gather picks the
+ * gather kernel of every set.
+ */
+template <class ResultT>
+vector<kernel_set<ResultT>> registered_kernels();
+
+template <>
+vector<kernel_set<uint32_t>> registered_kernels<uint32_t>() {
+	using ResultT = uint32_t;
+	return {
+		{ ISA_AVX, {
+			{ aggregate_scalar,					"scalar",	false },
+			{ aggregate_scalar_wide<ResultT>,	"scalar_wide",	false,	nullptr,	false,	false,	true },
+			{ aggregate_linear_avx256,			"linear",	false },
+			//{aggregate_stream_linear_avx256,	"stream",	false }, // was run, but not exported in old version
+			{ aggregate_strided_gather_avx256,	"gather",	true },
+			{ aggregate_strided_set_avx256,		"seti",		true },
+			{ aggregate_strided_gather_i64_avx256,	"gather_idx64",	true },
+			{ aggregate_linear_wide_avx256,	"linear_wide",	false,	nullptr,	false,	false,	true },
+			{ aggregate_strided_gather_wide_avx256,	"gather_wide",	true,	nullptr,	false,	false,	true },
+			{ aggregate_linear_masked_avx256,	"linear_masked",	false,	nullptr,	false,	true },
+			{ aggregate_strided_gather_masked_avx256,	"gather_masked",	true,	nullptr,	false,	true },
+			{ aggregate_strided_gather_static_avx256,	"gather_static",	true },
+			{ aggregate_strided_set_static_avx256,	"seti_static",	true },
+			{ aggregate_strided_gather_unrolled_avx256<2, 1>,	"gather_u2_a1",	true },
+			{ aggregate_strided_gather_unrolled_avx256<4, 1>,	"gather_u4_a1",	true },
+			{ aggregate_strided_gather_unrolled_avx256<8, 1>,	"gather_u8_a1",	true },
+			{ aggregate_strided_gather_unrolled_avx256<2, 2>,	"gather_u2_a2",	true },
+			{ aggregate_strided_gather_unrolled_avx256<4, 4>,	"gather_u4_a4",	true },
+			{ aggregate_strided_gather_unrolled_avx256<8, 8>,	"gather_u8_a8",	true },
+			{ aggregate_strided_gather_prefetch_avx256<_MM_HINT_T0>,	"gather_prefetch_t0",	true,	nullptr,	true },
+			{ aggregate_strided_gather_prefetch_avx256<_MM_HINT_T1>,	"gather_prefetch_t1",	true,	nullptr,	true },
+			{ aggregate_strided_gather_prefetch_avx256<_MM_HINT_NTA>,	"gather_prefetch_nta",	true,	nullptr,	true },
+			{ aggregate_strided_set_prefetch_avx256<_MM_HINT_T0>,	"seti_prefetch_t0",	true,	nullptr,	true },
+			{ aggregate_strided_set_prefetch_avx256<_MM_HINT_T1>,	"seti_prefetch_t1",	true,	nullptr,	true },
+			{ aggregate_strided_set_prefetch_avx256<_MM_HINT_NTA>,	"seti_prefetch_nta",	true,	nullptr,	true },
+			{ nullptr,							"scatter_linear",	false,	scatter_linear_avx256 },
+			{ nullptr,							"scatter",	true,	scatter_strided_emulated_avx256 },
+			{ nullptr,							"scatter_scalar",	true,	scatter_strided_scalar<8, ResultT> },
+		}, {
+			{ "lookup_scalar_idx32",	lookup_scalar },
+			{ "lookup_gather_idx32",	lookup_gather_avx256 },
+			{ "lookup_gather_prefetch_idx32",	lookup_gather_prefetch_avx256,	nullptr,	true },
+			{ "lookup_set_idx32",		lookup_set_avx256 },
+			{ "lookup_scalar_idx64",	nullptr,	lookup_scalar },
+			{ "lookup_gather_idx64",	nullptr,	lookup_gather_avx256 },
+			{ "lookup_gather_prefetch_idx64",	nullptr,	lookup_gather_prefetch_avx256,	true },
+			{ "lookup_set_idx64",		nullptr,	lookup_set_avx256 },
+		}, {
+			// no group-by kernels, AVX2 has no conflict detection
+		}, {
+			{ "probe_scalar",	probe_scalar<ResultT> },
+			{ "probe_gather",	probe_vertical_avx256<true> },
+			{ "probe_set",	probe_vertical_avx256<false> },
+			{ "probe_bucket",	probe_bucket_avx256,	true },
+		}, {
+			{ "chase_scalar",	chase_scalar<ResultT>,	1 },
+			{ "chase_gather",	chase_gather_avx256,	8 },
+		} },
+		{ ISA_AVX512, {
+			{ aggregate_scalar,					"scalar",	false },
+			{ aggregate_scalar_wide<ResultT>,	"scalar_wide",	false,	nullptr,	false,	false,	true },
+			{ aggregate_linear_avx512,			"linear",	false },
+			{ aggregate_strided_gather_avx512,	"gather",	true },
+			{ aggregate_strided_set_avx512,		"seti",		true },
+			{ aggregate_strided_gather_i64_avx512,	"gather_idx64",	true },
+			{ aggregate_linear_wide_avx512,	"linear_wide",	false,	nullptr,	false,	false,	true },
+			{ aggregate_strided_gather_wide_avx512,	"gather_wide",	true,	nullptr,	false,	false,	true },
+			{ aggregate_linear_masked_avx512,	"linear_masked",	false,	nullptr,	false,	true },
+			{ aggregate_strided_gather_masked_avx512,	"gather_masked",	true,	nullptr,	false,	true },
+			{ aggregate_strided_gather_static_avx512,	"gather_static",	true },
+			{ aggregate_strided_set_static_avx512,	"seti_static",	true },
+			{ aggregate_strided_gather_unrolled_avx512<2, 1>,	"gather_u2_a1",	true },
+			{ aggregate_strided_gather_unrolled_avx512<4, 1>,	"gather_u4_a1",	true },
+			{ aggregate_strided_gather_unrolled_avx512<8, 1>,	"gather_u8_a1",	true },
+			{ aggregate_strided_gather_unrolled_avx512<2, 2>,	"gather_u2_a2",	true },
+			{ aggregate_strided_gather_unrolled_avx512<4, 4>,	"gather_u4_a4",	true },
+			{ aggregate_strided_gather_unrolled_avx512<8, 8>,	"gather_u8_a8",	true },
+			{ aggregate_strided_gather_prefetch_avx512<_MM_HINT_T0>,	"gather_prefetch_t0",	true,	nullptr,	true },
+			{ aggregate_strided_gather_prefetch_avx512<_MM_HINT_T1>,	"gather_prefetch_t1",	true,	nullptr,	true },
+			{ aggregate_strided_gather_prefetch_avx512<_MM_HINT_NTA>,	"gather_prefetch_nta",	true,	nullptr,	true },
+			{ aggregate_strided_set_prefetch_avx512<_MM_HINT_T0>,	"seti_prefetch_t0",	true,	nullptr,	true },
+			{ aggregate_strided_set_prefetch_avx512<_MM_HINT_T1>,	"seti_prefetch_t1",	true,	nullptr,	true },
+			{ aggregate_strided_set_prefetch_avx512<_MM_HINT_NTA>,	"seti_prefetch_nta",	true,	nullptr,	true },
+			{ nullptr,							"scatter_linear",	false,	scatter_linear_avx512 },
+			{ nullptr,							"scatter",	true,	scatter_strided_avx512 },
+			{ nullptr,							"scatter_scalar",	true,	scatter_strided_scalar<16, ResultT> },
+		}, {
+			{ "lookup_scalar_idx32",	lookup_scalar },
+			{ "lookup_gather_idx32",	lookup_gather_avx512 },
+			{ "lookup_gather_prefetch_idx32",	lookup_gather_prefetch_avx512,	nullptr,	true },
+			{ "lookup_set_idx32",		lookup_set_avx512 },
+			{ "lookup_scalar_idx64",	nullptr,	lookup_scalar },
+			{ "lookup_gather_idx64",	nullptr,	lookup_gather_avx512 },
+			{ "lookup_gather_prefetch_idx64",	nullptr,	lookup_gather_prefetch_avx512,	true },
+			{ "lookup_set_idx64",		nullptr,	lookup_set_avx512 },
+		}, {
+			{ "groupby_scalar",	groupby_scalar<false, ResultT> },
+			{ "groupby_atomic",	groupby_atomic<false, ResultT>,	false,	true },
+			{ "groupby_sort",	groupby_sort<false, ResultT> },
+			{ "groupby_conflict",	groupby_conflict_avx512<false> },
+			{ "histogram_scalar",	groupby_scalar<true, ResultT>,	true },
+			{ "histogram_atomic",	groupby_atomic<true, ResultT>,	true,	true },
+			{ "histogram_sort",	groupby_sort<true, ResultT>,	true },
+			{ "histogram_conflict",	groupby_conflict_avx512<true>,	true },
+		}, {
+			{ "probe_scalar",	probe_scalar<ResultT> },
+			{ "probe_gather",	probe_vertical_avx512<true> },
+			{ "probe_set",	probe_vertical_avx512<false> },
+			{ "probe_bucket",	probe_bucket_avx512,	true },
+		}, {
+			{ "chase_scalar",	chase_scalar<ResultT>,	1 },
+			{ "chase_gather",	chase_gather_avx512,	16 },
+		} },
+	};
+}
+
+template <>
+vector<kernel_set<uint64_t>> registered_kernels<uint64_t>() {
+	using ResultT = uint64_t;
+	return {
+		{ ISA_AVX, {
+			{ aggregate_scalar,					"scalar",	false },
+			{ aggregate_linear_avx256,			"linear",	false },
+			{ aggregate_strided_gather_avx256,	"gather",	true },
+			{ aggregate_strided_set_avx256,		"seti",		true },
+			{ aggregate_strided_gather_i64_avx256,	"gather_idx64",	true },
+			{ aggregate_linear_masked_avx256,	"linear_masked",	false,	nullptr,	false,	true },
+			{ aggregate_strided_gather_masked_avx256,	"gather_masked",	true,	nullptr,	false,	true },
+			{ aggregate_strided_gather_static_avx256,	"gather_static",	true },
+			{ aggregate_strided_set_static_avx256,	"seti_static",	true },
+			{ aggregate_strided_gather_unrolled_avx256<2, 1>,	"gather_u2_a1",	true },
+			{ aggregate_strided_gather_unrolled_avx256<4, 1>,	"gather_u4_a1",	true },
+			{ aggregate_strided_gather_unrolled_avx256<8, 1>,	"gather_u8_a1",	true },
+			{ aggregate_strided_gather_unrolled_avx256<2, 2>,	"gather_u2_a2",	true },
+			{ aggregate_strided_gather_unrolled_avx256<4, 4>,	"gather_u4_a4",	true },
+			{ aggregate_strided_gather_unrolled_avx256<8, 8>,	"gather_u8_a8",	true },
+			{ aggregate_strided_gather_prefetch_avx256<_MM_HINT_T0>,	"gather_prefetch_t0",	true,	nullptr,	true },
+			{ aggregate_strided_gather_prefetch_avx256<_MM_HINT_T1>,	"gather_prefetch_t1",	true,	nullptr,	true },
+			{ aggregate_strided_gather_prefetch_avx256<_MM_HINT_NTA>,	"gather_prefetch_nta",	true,	nullptr,	true },
+			{ aggregate_strided_set_prefetch_avx256<_MM_HINT_T0>,	"seti_prefetch_t0",	true,	nullptr,	true },
+			{ aggregate_strided_set_prefetch_avx256<_MM_HINT_T1>,	"seti_prefetch_t1",	true,	nullptr,	true },
+			{ aggregate_strided_set_prefetch_avx256<_MM_HINT_NTA>,	"seti_prefetch_nta",	true,	nullptr,	true },
+			{ nullptr,							"scatter_linear",	false,	scatter_linear_avx256 },
+			{ nullptr,							"scatter",	true,	scatter_strided_emulated_avx256 },
+			{ nullptr,							"scatter_scalar",	true,	scatter_strided_scalar<4, ResultT> },
+		}, {
+			{ "lookup_scalar_idx32",	lookup_scalar },
+			{ "lookup_gather_idx32",	lookup_gather_avx256 },
+			{ "lookup_gather_prefetch_idx32",	lookup_gather_prefetch_avx256,	nullptr,	true },
+			{ "lookup_set_idx32",		lookup_set_avx256 },
+			{ "lookup_scalar_idx64",	nullptr,	lookup_scalar },
+			{ "lookup_gather_idx64",	nullptr,	lookup_gather_avx256 },
+			{ "lookup_gather_prefetch_idx64",	nullptr,	lookup_gather_prefetch_avx256,	true },
+			{ "lookup_set_idx64",		nullptr,	lookup_set_avx256 },
+		}, {
+			// no group-by kernels, AVX2 has no conflict detection
+		}, {
+			{ "probe_scalar",	probe_scalar<ResultT> },
+			{ "probe_gather",	probe_vertical_avx256<true> },
+			{ "probe_set",	probe_vertical_avx256<false> },
+			{ "probe_bucket",	probe_bucket_avx256,	true },
+		}, {
+			{ "chase_scalar",	chase_scalar<ResultT>,	1 },
+			{ "chase_gather",	chase_gather_avx256,	4 },
+		} },
+		{ ISA_AVX512, {
+			{ aggregate_scalar,					"scalar",	false },
+			{ aggregate_linear_avx512,			"linear",	false },
+			{ aggregate_strided_gather_avx512,	"gather",	true },
+			{ aggregate_strided_set_avx512,		"seti",		true },
+			{ aggregate_strided_gather_i64_avx512,	"gather_idx64",	true },
+			{ aggregate_linear_masked_avx512,	"linear_masked",	false,	nullptr,	false,	true },
+			{ aggregate_strided_gather_masked_avx512,	"gather_masked",	true,	nullptr,	false,	true },
+			{ aggregate_strided_gather_static_avx512,	"gather_static",	true },
+			{ aggregate_strided_set_static_avx512,	"seti_static",	true },
+			{ aggregate_strided_gather_unrolled_avx512<2, 1>,	"gather_u2_a1",	true },
+			{ aggregate_strided_gather_unrolled_avx512<4, 1>,	"gather_u4_a1",	true },
+			{ aggregate_strided_gather_unrolled_avx512<8, 1>,	"gather_u8_a1",	true },
+			{ aggregate_strided_gather_unrolled_avx512<2, 2>,	"gather_u2_a2",	true },
+			{ aggregate_strided_gather_unrolled_avx512<4, 4>,	"gather_u4_a4",	true },
+			{ aggregate_strided_gather_unrolled_avx512<8, 8>,	"gather_u8_a8",	true },
+			{ aggregate_strided_gather_prefetch_avx512<_MM_HINT_T0>,	"gather_prefetch_t0",	true,	nullptr,	true },
+			{ aggregate_strided_gather_prefetch_avx512<_MM_HINT_T1>,	"gather_prefetch_t1",	true,	nullptr,	true },
+			{ aggregate_strided_gather_prefetch_avx512<_MM_HINT_NTA>,	"gather_prefetch_nta",	true,	nullptr,	true },
+			{ aggregate_strided_set_prefetch_avx512<_MM_HINT_T0>,	"seti_prefetch_t0",	true,	nullptr,	true },
+			{ aggregate_strided_set_prefetch_avx512<_MM_HINT_T1>,	"seti_prefetch_t1",	true,	nullptr,	true },
+			{ aggregate_strided_set_prefetch_avx512<_MM_HINT_NTA>,	"seti_prefetch_nta",	true,	nullptr,	true },
+			{ nullptr,							"scatter_linear",	false,	scatter_linear_avx512 },
+			{ nullptr,							"scatter",	true,	scatter_strided_avx512 },
+			{ nullptr,							"scatter_scalar",	true,	scatter_strided_scalar<8, ResultT> },
+		}, {
+			{ "lookup_scalar_idx32",	lookup_scalar },
+			{ "lookup_gather_idx32",	lookup_gather_avx512 },
+			{ "lookup_gather_prefetch_idx32",	lookup_gather_prefetch_avx512,	nullptr,	true },
+			{ "lookup_set_idx32",		lookup_set_avx512 },
+			{ "lookup_scalar_idx64",	nullptr,	lookup_scalar },
+			{ "lookup_gather_idx64",	nullptr,	lookup_gather_avx512 },
+			{ "lookup_gather_prefetch_idx64",	nullptr,	lookup_gather_prefetch_avx512,	true },
+			{ "lookup_set_idx64",		nullptr,	lookup_set_avx512 },
+		}, {
+			{ "groupby_scalar",	groupby_scalar<false, ResultT> },
+			{ "groupby_atomic",	groupby_atomic<false, ResultT>,	false,	true },
+			{ "groupby_sort",	groupby_sort<false, ResultT> },
+			{ "groupby_conflict",	groupby_conflict_avx512<false> },
+			{ "histogram_scalar",	groupby_scalar<true, ResultT>,	true },
+			{ "histogram_atomic",	groupby_atomic<true, ResultT>,	true,	true },
+			{ "histogram_sort",	groupby_sort<true, ResultT>,	true },
+			{ "histogram_conflict",	groupby_conflict_avx512<true>,	true },
+		}, {
+			{ "probe_scalar",	probe_scalar<ResultT> },
+			{ "probe_gather",	probe_vertical_avx512<true> },
+			{ "probe_set",	probe_vertical_avx512<false> },
+			{ "probe_bucket",	probe_bucket_avx512,	true },
+		}, {
+			{ "chase_scalar",	chase_scalar<ResultT>,	1 },
+			{ "chase_gather",	chase_gather_avx512,	8 },
+		} },
+	};
+}
+
+/** whether any kernel (of any set) for elements of type ResultT has label */
+template <class ResultT>
+bool registered_kernel(const string& label) {
+	for (const kernel_set<ResultT>& set : registered_kernels<ResultT>()) {
+		for (const aggregator_t<ResultT>& aggregator : set.aggregators) {
+			if (aggregator.label == label) return true;
+		}
+		for (const lookup_kernel<ResultT>& lookup : set.lookups) {
+			if (lookup.label == label) return true;
+		}
+		for (const groupby_kernel<ResultT>& groupby : set.groupbys) {
+			if (groupby.label == label) return true;
+		}
+		for (const probe_kernel<ResultT>& probe : set.probes) {
+			if (probe.label == label) return true;
+		}
+		for (const chase_kernel<ResultT>& chase : set.chases) {
+			if (chase.label == label) return true;
+		}
+	}
+	return false;
+}
+
+/** warns about every label in labels that no registered kernel has.
+ */
+void warn_unknown_kernels(const vector<string>& labels) {
+	for (const string& label : labels) {
+		if (!registered_kernel<uint32_t>(label) && !registered_kernel<uint64_t>(label)) {
+			cerr << "WARNING: there is no kernel '" << label << "', ignoring it" << endl;
+		}
+	}
+}
+
+
+#endif // include guard KERNEL_REGISTRY_CPP
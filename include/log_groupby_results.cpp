@@ -0,0 +1,88 @@
+#ifndef LOG_GROUPBY_RESULTS_CPP
+#define LOG_GROUPBY_RESULTS_CPP
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "measures.h"
+#include "options.cpp"
+#include "benchmark_data.cpp"
+
+/* appends the line for one bucket count and key distribution to filename:
+ * the number of buckets, the distribution's name, then mis and throughput
+ * of every group-by kernel, in the order of labels (which the "# columns:"
+ * header line names).
+ * clean starts the file over, with header as its first lines.
+ */
+void log_groupby_results(
+	const std::string& filename,
+	uint64_t bucket_count,
+	const std::string& distribution,
+	const std::vector< measures >& results,
+	const std::vector< std::string >& labels,
+	bool clean,
+	std::string header = ""
+) {
+    if ( clean ) {
+        std::ofstream out( filename );
+        out << header << "# columns: buckets distribution";
+        for ( auto& label : labels ) {
+            out << " " << label << ":mis " << label << ":throughput";
+        }
+        out << std::endl;
+        out.close();
+    }
+
+    std::ofstream out( filename, std::ios_base::app );
+    out << bucket_count << " " << distribution;
+    for ( auto& r : results ) {
+        out << " " << r.mis << " " << r.throughput;
+    }
+    out << std::endl;
+    out.close();
+}
+
+/* like log_groupby_results, but writes the hardware counters
+ * of every group-by kernel.
+ */
+void log_groupby_counters(
+	const std::string& filename,
+	uint64_t bucket_count,
+	const std::string& distribution,
+	const std::vector< measures >& results,
+	const std::vector< std::string >& labels,
+	bool clean,
+	std::string header = ""
+) {
+    if ( clean ) {
+        std::ofstream out( filename );
+        out << header << "# columns: buckets distribution";
+        for ( auto& label : labels ) {
+            out << " " << perf_counter_columns( label );
+        }
+        out << std::endl;
+        out.close();
+    }
+
+    std::ofstream out( filename, std::ios_base::app );
+    out << bucket_count << " " << distribution;
+    for ( auto& r : results ) {
+        print_perf_counts( out, r.counters );
+    }
+    out << std::endl;
+    out.close();
+}
+
+/** the group-by specific options as "# key: value" lines, see options_header */
+template <class ResultT>
+std::string groupby_header(const run_options& options, const groupby_keys<ResultT>& keys) {
+	std::string header = "";
+	header += "# rows: " + std::to_string(keys.number) + "\n";
+	header += "# zipf_exponent: " + std::to_string(options.index_options.zipf_exponent) + "\n";
+	header += "# selectivity: " + std::to_string(options.index_options.selectivity) + "\n";
+	return header;
+}
+
+
+#endif // include guard LOG_GROUPBY_RESULTS_CPP
@@ -0,0 +1,95 @@
+#ifndef LOG_LATENCY_RESULTS_CPP
+#define LOG_LATENCY_RESULTS_CPP
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "measures.h"
+#include "options.cpp"
+#include "benchmark_data.cpp"
+
+/** the mean latency of one hop of a chase of hops dependent loads */
+inline double ns_per_hop(const measures& measurement, uint64_t hops) {
+	return measurement.duration / (double) hops;
+}
+
+/** the first columns of a line of the latency files: the bytes of the
+ * working set and its placement
+ */
+template <class ResultT>
+std::string latency_row(const chase_cycle<ResultT>& cycle, const placement& where) {
+	return std::to_string(cycle.bytes) + " " + placement_name(where);
+}
+
+/* appends the line for one working set (row, see latency_row) to filename:
+ * then ns per hop and mis (million loads per second, over all chains) of
+ * every chase kernel, in the order of labels (which the "# columns:" header
+ * line names).
+ * clean starts the file over, with header as its first lines.
+ */
+void log_latency_results(
+	const std::string& filename,
+	const std::string& row,
+	uint64_t hops,
+	const std::vector< measures >& results,
+	const std::vector< std::string >& labels,
+	bool clean,
+	std::string header = ""
+) {
+    if ( clean ) {
+        std::ofstream out( filename );
+        out << header << "# columns: working_set placement";
+        for ( auto& label : labels ) {
+            out << " " << label << ":ns_per_hop " << label << ":mis";
+        }
+        out << std::endl;
+        out.close();
+    }
+
+    std::ofstream out( filename, std::ios_base::app );
+    out << row;
+    for ( auto& r : results ) {
+        out << " " << ns_per_hop( r, hops ) << " " << r.mis;
+    }
+    out << std::endl;
+    out.close();
+}
+
+/* like log_latency_results, but writes the hardware counters
+ * of every chase kernel.
+ */
+void log_latency_counters(
+	const std::string& filename,
+	const std::string& row,
+	const std::vector< measures >& results,
+	const std::vector< std::string >& labels,
+	bool clean,
+	std::string header = ""
+) {
+    if ( clean ) {
+        std::ofstream out( filename );
+        out << header << "# columns: working_set placement";
+        for ( auto& label : labels ) {
+            out << " " << perf_counter_columns( label );
+        }
+        out << std::endl;
+        out.close();
+    }
+
+    std::ofstream out( filename, std::ios_base::app );
+    out << row;
+    for ( auto& r : results ) {
+        print_perf_counts( out, r.counters );
+    }
+    out << std::endl;
+    out.close();
+}
+
+/** the chase specific options as "# key: value" lines, see options_header */
+inline std::string latency_header(const run_options& options) {
+	return "# hops: " + std::to_string(options.hops) + "\n";
+}
+
+
+#endif // include guard LOG_LATENCY_RESULTS_CPP
@@ -0,0 +1,84 @@
+#ifndef LOG_LOOKUP_RESULTS_CPP
+#define LOG_LOOKUP_RESULTS_CPP
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "measures.h"
+#include "options.cpp"
+#include "benchmark_data.cpp"
+
+/* appends the line for one index distribution to filename: its name,
+ * then mis and throughput of every lookup kernel, in the order of labels
+ * (which the "# columns:" header line names).
+ * clean starts the file over, with header as its first lines.
+ */
+void log_lookup_results(
+	const std::string& filename,
+	const std::string& distribution,
+	const std::vector< measures >& results,
+	const std::vector< std::string >& labels,
+	bool clean,
+	std::string header = ""
+) {
+    if ( clean ) {
+        std::ofstream out( filename );
+        out << header << "# columns: distribution";
+        for ( auto& label : labels ) {
+            out << " " << label << ":mis " << label << ":throughput";
+        }
+        out << std::endl;
+        out.close();
+    }
+
+    std::ofstream out( filename, std::ios_base::app );
+    out << distribution;
+    for ( auto& r : results ) {
+        out << " " << r.mis << " " << r.throughput;
+    }
+    out << std::endl;
+    out.close();
+}
+
+/* like log_lookup_results, but writes the hardware counters
+ * of every lookup kernel.
+ */
+void log_lookup_counters(
+	const std::string& filename,
+	const std::string& distribution,
+	const std::vector< measures >& results,
+	const std::vector< std::string >& labels,
+	bool clean,
+	std::string header = ""
+) {
+    if ( clean ) {
+        std::ofstream out( filename );
+        out << header << "# columns: distribution";
+        for ( auto& label : labels ) {
+            out << " " << perf_counter_columns( label );
+        }
+        out << std::endl;
+        out.close();
+    }
+
+    std::ofstream out( filename, std::ios_base::app );
+    out << distribution;
+    for ( auto& r : results ) {
+        print_perf_counts( out, r.counters );
+    }
+    out << std::endl;
+    out.close();
+}
+
+/** the lookup specific options as "# key: value" lines, see options_header */
+std::string lookup_header(const run_options& options, const lookup_indices& indices) {
+	std::string header = "";
+	header += "# lookups: " + std::to_string(indices.number) + "\n";
+	header += "# zipf_exponent: " + std::to_string(options.index_options.zipf_exponent) + "\n";
+	header += "# selectivity: " + std::to_string(options.index_options.selectivity) + "\n";
+	return header;
+}
+
+
+#endif // include guard LOG_LOOKUP_RESULTS_CPP
@@ -1,44 +1,153 @@
 #ifndef LOG_MULTITHREADED_RESULTS_CPP
 #define LOG_MULTITHREADED_RESULTS_CPP
 
-/* We anticipate the following order: scalar, linear, gather, seti */
+/* appends the line for stride_size to the file of core count key,
+ * the columns follow the order of the aggregators vector,
+ * e.g. scalar, linear, gather, seti, scatter...
+ * clean starts the file over, with header as its first lines.
+ */
 void log_multithreaded_results_per_file(
 	std::string basename,
 	const size_t stride_size,
 	std::vector< multithreaded_measures >& results,
-	bool clean
+	uint64_t key,
+	bool clean,
+	std::string header = ""
 ) {
-    std::vector< uint64_t > keys;
-    /* Extract all keys */
-    for ( auto it = results[0].begin(); it != results[0].end(); ++it ) {
-        keys.push_back( it->first );
+    const std::string filename = basename + "_" + std::to_string( key ) + "_cores.dat";
+
+    if ( clean ) {
+        if ( remove( filename.c_str() ) == 0 ) {
+            std::cout << "Succesfully removed " << filename << " before the benchmark." << std::endl;
+        } else {
+            std::cout << "ERROR removing " << filename << " before the benchmark (maybe file was not present anyway). CHECK RESULTS" << std::endl;
+        }
+        std::ofstream out( filename );
+        out << header;
+        out.close();
     }
 
+    std::ofstream out( filename, std::ios_base::app );
+    out << stride_size << " " << stride_size * 8;
+    for ( auto& r : results ) {
+        out << " " << r[ key ].mis << " " << r[ key ].throughput;
+    }
+    out << std::endl;
+    out.close();
+}
+
+/* like log_multithreaded_results_per_file, but writes the hardware
+ * counters of every aggregator (named in the "# columns:" header line)
+ * into <basename>_<key>_cores_counters.dat.
+ */
+void log_multithreaded_counters_per_file(
+	std::string basename,
+	const size_t stride_size,
+	std::vector< multithreaded_measures >& results,
+	const std::vector< std::string >& labels,
+	uint64_t key,
+	bool clean,
+	std::string header = ""
+) {
+    const std::string filename = basename + "_" + std::to_string( key ) + "_cores_counters.dat";
+
     if ( clean ) {
-        for ( auto key : keys ) {
-            std::string del_file = basename + "_" + std::to_string( key ) + "_cores.dat";
-            if ( remove( del_file.c_str() ) == 0 ) {
-                std::cout << "Succesfully removed " << del_file << " before the benchmark." << std::endl;
-            } else {
-                std::cout << "ERROR removing " << del_file << " before the benchmark (maybe file was not present anyway). CHECK RESULTS" << std::endl;
-            }
+        std::ofstream out( filename );
+        out << header << "# columns: stride stride*8";
+        for ( auto& label : labels ) {
+            out << " " << perf_counter_columns( label );
         }
+        out << std::endl;
+        out.close();
+    }
+
+    std::ofstream out( filename, std::ios_base::app );
+    out << stride_size << " " << stride_size * 8;
+    for ( auto& r : results ) {
+        print_perf_counts( out, r[ key ].counters );
     }
+    out << std::endl;
+    out.close();
+}
 
-    for ( auto key : keys ) {
-        std::ofstream out( basename + "_" + std::to_string( key ) + "_cores.dat", std::ios_base::app );
-        out << stride_size << " " << stride_size * 8;
-        for ( auto r : results ) {
-            out << " " << r[ key ].mis << " " << r[ key ].throughput;
+/* appends a line to filename: first_columns (e.g. the stride), then how
+ * unevenly the threads took for every kernel, in the order of labels (named
+ * in the "# columns:" line, after column_names): slowest / fastest thread
+ * and the coefficient of variation of the thread durations.
+ * clean starts the file over, with header as its first lines.
+ */
+void log_imbalance(
+	const std::string& filename,
+	const std::string& column_names,
+	const std::string& first_columns,
+	const std::vector< measures >& results,
+	const std::vector< std::string >& labels,
+	bool clean,
+	std::string header = ""
+) {
+    if ( clean ) {
+        std::ofstream out( filename );
+        out << header << "# columns: " << column_names;
+        for ( auto& label : labels ) {
+            out << " " << label << ":max/min " << label << ":cv";
+        }
+        out << std::endl;
+        out.close();
+    }
+
+    std::ofstream out( filename, std::ios_base::app );
+    out << first_columns;
+    for ( auto& r : results ) {
+        out << " " << r.imbalance << " " << r.thread_cv;
+    }
+    out << std::endl;
+    out.close();
+}
+
+/* like log_imbalance, but writes what the background load (see
+ * background_load) reached meanwhile: mis and throughput of all background
+ * threads together, for every kernel.
+ */
+void log_background(
+	const std::string& filename,
+	const std::string& column_names,
+	const std::string& first_columns,
+	const std::vector< measures >& results,
+	const std::vector< std::string >& labels,
+	bool clean,
+	std::string header = ""
+) {
+    if ( clean ) {
+        std::ofstream out( filename );
+        out << header << "# columns: " << column_names;
+        for ( auto& label : labels ) {
+            out << " " << label << ":background_mis " << label << ":background_throughput";
         }
         out << std::endl;
         out.close();
     }
+
+    std::ofstream out( filename, std::ios_base::app );
+    out << first_columns;
+    for ( auto& r : results ) {
+        out << " " << r.background_mis << " " << r.background_throughput;
+    }
+    out << std::endl;
+    out.close();
+}
+
+/** ", background <throughput> GB/s" for the console if measurement was
+ * measured under a background load, else ""
+ */
+std::string background_note(const measures& measurement) {
+	if (std::isnan(measurement.background_throughput)) return "";
+	return ", background " + std::to_string(measurement.background_throughput) + " GB/s";
 }
 
 void print_multithreaded_results( std::ostream& logfile, std::string ident, multithreaded_measures& results ) {
     for ( auto it = results.begin(); it != results.end(); ++it ) {
-        logfile << "[" << ident << "] Core Count: " << it->first << " TPut: " << it->second.throughput << std::endl;
+        logfile << "[" << ident << "] Core Count: " << it->first << " TPut: " << it->second.throughput
+                << " Imbalance: " << it->second.imbalance << " CV: " << it->second.thread_cv << std::endl;
     }
 }
 
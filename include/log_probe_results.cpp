@@ -0,0 +1,95 @@
+#ifndef LOG_PROBE_RESULTS_CPP
+#define LOG_PROBE_RESULTS_CPP
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "measures.h"
+#include "options.cpp"
+#include "benchmark_data.cpp"
+
+/** the first columns of a line of the probe files: the number of slots, the
+ * layout of the table and the hit rate of the keys
+ */
+template <class ResultT>
+std::string probe_row(const hash_table<ResultT>& table, const probe_keys<ResultT>& keys) {
+	std::ostringstream row;
+	row << table.slots() << " " << table_layout_name(table.layout) << " " << keys.hit_rate;
+	return row.str();
+}
+
+/* appends the line for one table and hit rate (row, see probe_row) to
+ * filename: then mis and throughput of every probe kernel, in the order of
+ * labels (which the "# columns:" header line names).
+ * clean starts the file over, with header as its first lines.
+ */
+void log_probe_results(
+	const std::string& filename,
+	const std::string& row,
+	const std::vector< measures >& results,
+	const std::vector< std::string >& labels,
+	bool clean,
+	std::string header = ""
+) {
+    if ( clean ) {
+        std::ofstream out( filename );
+        out << header << "# columns: slots layout hit_rate";
+        for ( auto& label : labels ) {
+            out << " " << label << ":mis " << label << ":throughput";
+        }
+        out << std::endl;
+        out.close();
+    }
+
+    std::ofstream out( filename, std::ios_base::app );
+    out << row;
+    for ( auto& r : results ) {
+        out << " " << r.mis << " " << r.throughput;
+    }
+    out << std::endl;
+    out.close();
+}
+
+/* like log_probe_results, but writes the hardware counters
+ * of every probe kernel.
+ */
+void log_probe_counters(
+	const std::string& filename,
+	const std::string& row,
+	const std::vector< measures >& results,
+	const std::vector< std::string >& labels,
+	bool clean,
+	std::string header = ""
+) {
+    if ( clean ) {
+        std::ofstream out( filename );
+        out << header << "# columns: slots layout hit_rate";
+        for ( auto& label : labels ) {
+            out << " " << perf_counter_columns( label );
+        }
+        out << std::endl;
+        out.close();
+    }
+
+    std::ofstream out( filename, std::ios_base::app );
+    out << row;
+    for ( auto& r : results ) {
+        print_perf_counts( out, r.counters );
+    }
+    out << std::endl;
+    out.close();
+}
+
+/** the probe specific options as "# key: value" lines, see options_header */
+template <class ResultT>
+std::string probe_header(const run_options& options, const probe_keys<ResultT>& keys) {
+	std::string header = "";
+	header += "# probes: " + std::to_string(keys.number) + "\n";
+	header += "# load_factor: " + std::to_string(options.load_factor) + "\n";
+	return header;
+}
+
+
+#endif // include guard LOG_PROBE_RESULTS_CPP
@@ -0,0 +1,95 @@
+#ifndef LOG_STATISTICS_CPP
+#define LOG_STATISTICS_CPP
+
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "measures.h"
+#include "statistics.cpp"
+
+/** the columns log_statistics writes for a kernel, named after label */
+std::string statistics_columns(const std::string& label) {
+	std::string columns = "";
+	for (const char* statistic : { "min", "median", "p5", "p95", "mean", "stddev", "ci95", "outliers" }) {
+		if (!columns.empty()) columns += " ";
+		columns += label + ":" + statistic;
+	}
+	return columns;
+}
+
+/* appends a line to filename: first_columns (e.g. the stride), then the
+ * statistics of the execution durations (ns) of every kernel, in the order
+ * of labels (named in the "# columns:" line, after column_names).
+ * clean starts the file over, with header as its first lines.
+ */
+void log_statistics(
+	const std::string& filename,
+	const std::string& column_names,
+	const std::string& first_columns,
+	const std::vector< measures >& results,
+	const std::vector< std::string >& labels,
+	bool clean,
+	std::string header = ""
+) {
+    if ( clean ) {
+        std::ofstream out( filename );
+        out << header << "# columns: " << column_names;
+        for ( auto& label : labels ) {
+            out << " " << statistics_columns( label );
+        }
+        out << std::endl;
+        out.close();
+    }
+
+    std::ofstream out( filename, std::ios_base::app );
+    out << first_columns << std::fixed << std::setprecision( 1 );
+    for ( auto& r : results ) {
+        const sample_statistics& s = r.statistics;
+        out << " " << s.min << " " << s.median << " " << s.p5 << " " << s.p95
+            << " " << s.mean << " " << s.stddev << " " << s.ci95 << " " << s.outliers;
+    }
+    out << std::endl;
+    out.close();
+}
+
+/* appends a line per kernel to filename: first_columns, the label and the
+ * duration (ns) of each of its measured executions, in execution order.
+ * kernels without samples (skipped) are left out.
+ * clean starts the file over, with header as its first lines.
+ */
+void log_samples(
+	const std::string& filename,
+	const std::string& column_names,
+	const std::string& first_columns,
+	const std::vector< measures >& results,
+	const std::vector< std::string >& labels,
+	bool clean,
+	std::string header = ""
+) {
+    if ( clean ) {
+        std::ofstream out( filename );
+        out << header << "# columns: " << column_names << " kernel durations..." << std::endl;
+        out.close();
+    }
+
+    std::ofstream out( filename, std::ios_base::app );
+    for ( size_t k = 0; k < results.size(); k++ ) {
+        if ( results[ k ].samples.empty() ) continue;
+        out << first_columns << " " << labels[ k ] << std::fixed << std::setprecision( 0 );
+        for ( double sample : results[ k ].samples ) out << " " << sample;
+        out << std::endl;
+    }
+    out.close();
+}
+
+/** ", <n> outliers" for the console if measurement has some, else "" */
+std::string outlier_note(const measures& measurement) {
+	if (measurement.statistics.outliers == 0) return "";
+	const uint64_t outliers = measurement.statistics.outliers;
+	return ", " + std::to_string(outliers) + (outliers == 1 ? " outlier" : " outliers");
+}
+
+
+#endif // include guard LOG_STATISTICS_CPP
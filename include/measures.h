@@ -3,17 +3,48 @@
 
 #include <map>
 
+#include <vector>
+
+#include "perf_counters.cpp"
+#include "statistics.cpp"
+
 /** meansurement of a benchmark runthrough:
  * result of the measured aggregation function for correctness checking,
- * duration in ns, throughput in GB/s, mis is million values per second.
+ * duration in ns, throughput in GB/s, mis is million values per second,
+ * hardware counters per execution (summed over all threads),
+ * the prefetch distance of prefetching kernels (0 for the others),
+ * the duration of every measured execution (ns, warm-up ones left out)
+ * and their statistics (duration is their mean).
+ * multi threaded, how unevenly the threads took (averaged over the
+ * executions): slowest / fastest thread and the coefficient of variation
+ * of the thread durations, nan single threaded.
+ * with a background load (see background_load), the mis and throughput
+ * all background threads reached together meanwhile, nan without one.
  */
 struct measures {
 	uint64_t result;
 	double duration;
 	double throughput;
 	double mis;
+	perf_counts counters;
+	uint64_t prefetch_distance = 0;
+	std::vector< double > samples;
+	sample_statistics statistics;
+	double imbalance = NAN;
+	double thread_cv = NAN;
+	double background_mis = NAN;
+	double background_throughput = NAN;
 };
 
+/** measures of a point that could not be run, e.g. because the stride
+ * is too large for the data, nan everywhere (gnuplot leaves them out).
+ */
+inline struct measures skipped_measures() {
+	struct measures skipped = { 0, NAN, NAN, NAN };
+	for (double& value : skipped.counters.value) value = NAN;
+	return skipped;
+}
+
 /** each thread gets to write in its own data result struct
  */
 typedef std::map<uint64_t, struct measures> multithreaded_measures;
@@ -0,0 +1,612 @@
+#ifndef OPTIONS_CPP
+#define OPTIONS_CPP
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// ITERATIONS, WARMUP_ITERATIONS and MAX_CORES, the defaults
+#include "parameters.h"
+#include "allocate.cpp"
+#include "cache_control.cpp"
+#include "cpu_topology.cpp"
+#include "cpu_features.cpp"
+#include "generate_indices.cpp"
+#include "generate_random_values.cpp"
+#include "hash_table.h"
+#include "gather/prefetch.cpp"
+
+/** throughput drop (in percent) of a point against the --baseline
+ * that counts as a regression, if it is significant.
+ */
+constexpr double DEFAULT_REGRESSION_THRESHOLD = 5.0;
+
+/** 1, 2, 4, ... MAX_CORES */
+std::vector< uint64_t > default_core_counts() {
+	std::vector< uint64_t > core_counts;
+	for (uint64_t core_cnt = 1; core_cnt <= MAX_CORES; core_cnt *= 2) core_counts.push_back(core_cnt);
+	return core_counts;
+}
+
+/** 2, 4, 8, ... 2**15 */
+std::vector< uint64_t > default_strides() {
+	std::vector< uint64_t > strides;
+	for (uint64_t stride_pow = 1; stride_pow <= 15; stride_pow++) strides.push_back(1 << stride_pow);
+	return strides;
+}
+
+/** 1, 2, 4, ... 64, the distances --prefetch-distances=auto tries */
+std::vector< uint64_t > auto_prefetch_distances() {
+	std::vector< uint64_t > distances;
+	for (uint64_t distance = 1; distance <= 64; distance *= 2) distances.push_back(distance);
+	return distances;
+}
+
+/** uniform, zipf, sorted, clustered, holes */
+std::vector< index_distribution > default_distributions() {
+	std::vector< index_distribution > distributions;
+	for (int d = 0; d < NUMBER_OF_INDEX_DISTRIBUTIONS; d++) distributions.push_back((index_distribution) d);
+	return distributions;
+}
+
+/** how the multi threaded harness turns the threads' durations into the
+ * duration of an execution:
+ * wall: from the release of the start barrier (the first thread to start)
+ *       until the last thread is done, what all threads together achieve,
+ * average: the average of the threads' own durations, which hides
+ *       stragglers (and so overstates the aggregate throughput).
+ */
+enum timing_mode {
+	TIMING_WALL,
+	TIMING_AVERAGE,
+};
+
+std::string timing_mode_name(timing_mode mode) {
+	switch (mode) {
+		case TIMING_WALL:    return "wall";
+		case TIMING_AVERAGE: return "average";
+	}
+	return "unknown";
+}
+
+/** sets mode according to name ("wall" or "average"),
+ * returns false (and leaves mode as it is) for an unknown name.
+ */
+bool parse_timing_mode(const std::string& name, timing_mode* mode) {
+	for (timing_mode candidate : { TIMING_WALL, TIMING_AVERAGE }) {
+		if (name == timing_mode_name(candidate)) {
+			*mode = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+/** everything about a benchmark run that can be chosen on the command line
+ * (or in a config file). the defaults are what a run without options does.
+ */
+struct run_options {
+	uint64_t data_size_log2 = 0; // 0: not given
+	uint64_t values = 0; // 0: 2**data_size_log2, see number_of_values
+	bool single_threaded = true;
+	bool multi_threaded = false;
+	std::vector< uint64_t > widths = { 32, 64 };
+	std::vector< cpu_isa > isas = { ISA_AVX, ISA_AVX512 };
+	uint64_t iterations = ITERATIONS;
+	uint64_t warmup = WARMUP_ITERATIONS;
+	std::vector< uint64_t > core_counts = default_core_counts();
+	std::vector< uint64_t > strides = default_strides();
+	std::vector< std::string > kernels; // empty: all of them
+	std::vector< uint64_t > prefetch_distances = { DEFAULT_PREFETCH_DISTANCE };
+	uint64_t lookups_log2 = 0; // 0: as many lookups as values
+	// group-by tables of 2**log2 buckets, from l1 to dram resident
+	std::vector< uint64_t > buckets_log2 = { 8, 12, 16, 20, 24 };
+	std::vector< index_distribution > distributions = default_distributions();
+	index_parameters index_options;
+	// hash tables of 2**log2 slots, from l1 to dram (or hbm) resident
+	std::vector< uint64_t > table_sizes_log2 = { 10, 14, 18, 22, 26 };
+	std::vector< table_layout > layouts = { LAYOUT_LINEAR, LAYOUT_BUCKETS };
+	std::vector< double > hit_rates = { 0, 0.5, 1 };
+	double load_factor = 0.5;
+	// pointer chases through 2**log2 bytes, from l1 to dram (or hbm)
+	std::vector< uint64_t > working_sets_log2 = { 14, 18, 22, 26, 28 };
+	uint64_t hops = CHASE_HOPS;
+	// aggregator streaming on further workers while the multi threaded
+	// aggregators and pointer chases are measured, empty: none
+	std::string background;
+	std::vector< uint64_t > background_cores = { 0 };
+	cache_mode cache = CACHE_COLD;
+	timing_mode timing = TIMING_WALL;
+	placement data_placement;
+	pinning_policy pinning = PINNING_COMPACT;
+	std::vector< uint64_t > pinning_list; // the cpus of PINNING_LIST
+	// the cpus the workers are pinned to, multi threaded (set in main)
+	std::vector< uint64_t > pinned_cpus;
+	std::string csv_file; // empty: ./data/gather/<data_size_log2>_points.csv
+	uint64_t seed = random_seed(); // of the values and indices, see --seed
+	uint64_t max_value = DEFAULT_MAX_VALUE; // values are 1..max_value
+	std::string baseline_file; // empty: no comparison
+	double regression_threshold = DEFAULT_REGRESSION_THRESHOLD;
+
+	bool isa_selected(cpu_isa isa) const {
+		for (cpu_isa selected : isas) {
+			if (selected == isa) return true;
+		}
+		return false;
+	}
+
+	uint64_t max_core_count() const {
+		uint64_t max = 0;
+		for (uint64_t core_cnt : core_counts) max = core_cnt > max ? core_cnt : max;
+		return max;
+	}
+
+	/** the workers the multi threaded benchmark needs: the measured ones
+	 * and the background ones next to them
+	 */
+	uint64_t max_worker_count() const {
+		uint64_t max = 0;
+		if (!background.empty()) {
+			for (uint64_t core_cnt : background_cores) max = core_cnt > max ? core_cnt : max;
+		}
+		return max_core_count() + max;
+	}
+
+	/** the number of generated values: --values if given, else 2**data_size_log2 */
+	uint64_t number_of_values() const {
+		return values != 0 ? values : (uint64_t) 1 << data_size_log2;
+	}
+
+	std::string structured_results_filename() const {
+		if (!csv_file.empty()) return csv_file;
+		return "./data/gather/" + std::to_string(data_size_log2) + "_points.csv";
+	}
+
+	/** the structured results filename with _comparison instead of .csv */
+	std::string comparison_filename() const {
+		std::string base = structured_results_filename();
+		if (base.size() > 4 && base.compare(base.size() - 4, 4, ".csv") == 0) base.resize(base.size() - 4);
+		return base + "_comparison.csv";
+	}
+
+	/** the placements the pointer chases run on, one after the other: each
+	 * of the nodes on its own for bind (to tell their latencies apart), else
+	 * data_placement as it is.
+	 */
+	std::vector< placement > chase_placements() const {
+		if (data_placement.policy != PLACEMENT_BIND || !numa_usable()) return { data_placement };
+		std::vector< placement > placements;
+		for (uint64_t node : data_placement.nodes) {
+			placement on_node = data_placement;
+			on_node.nodes = { node };
+			placements.push_back(on_node);
+		}
+		return placements;
+	}
+};
+
+/** parses a list like "0,2,4-7" into numbers (here 0 2 4 5 6 7),
+ * returns false if it is malformed or empty.
+ */
+bool parse_number_list(const std::string& text, std::vector< uint64_t >* numbers) {
+	std::vector< uint64_t > result;
+	size_t begin = 0;
+	while (begin <= text.size()) {
+		size_t end = text.find(',', begin);
+		if (end == std::string::npos) end = text.size();
+		const std::string item = text.substr(begin, end - begin);
+		const size_t dash = item.find('-');
+		char* rest;
+		if (item.empty() || item.find_first_not_of("0123456789-") != std::string::npos) return false;
+		if (dash == std::string::npos) {
+			result.push_back(strtoull(item.c_str(), &rest, 10));
+		} else {
+			const uint64_t first = strtoull(item.substr(0, dash).c_str(), &rest, 10);
+			const uint64_t last = strtoull(item.substr(dash + 1).c_str(), &rest, 10);
+			if (dash == 0 || dash + 1 == item.size() || last < first) return false;
+			for (uint64_t number = first; number <= last; number++) result.push_back(number);
+		}
+		begin = end + 1;
+	}
+	if (result.empty()) return false;
+	*numbers = result;
+	return true;
+}
+
+/** parses a single positive number, returns false if text is none.
+ */
+bool parse_positive_number(const std::string& text, uint64_t* number) {
+	if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) return false;
+	const uint64_t result = strtoull(text.c_str(), NULL, 10);
+	if (result == 0) return false;
+	*number = result;
+	return true;
+}
+
+/** parses a single number (0 too), returns false if text is none.
+ */
+bool parse_number(const std::string& text, uint64_t* number) {
+	if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) return false;
+	*number = strtoull(text.c_str(), NULL, 10);
+	return true;
+}
+
+/** parses a number in (0, 1], returns false if text is none.
+ */
+bool parse_fraction(const std::string& text, double* fraction) {
+	char* rest;
+	const double result = strtod(text.c_str(), &rest);
+	if (text.empty() || *rest != '\0' || !(result > 0 && result <= 1)) return false;
+	*fraction = result;
+	return true;
+}
+
+/** parses a positive number, returns false if text is none.
+ */
+bool parse_positive_real(const std::string& text, double* number) {
+	char* rest;
+	const double result = strtod(text.c_str(), &rest);
+	if (text.empty() || *rest != '\0' || !(result > 0)) return false;
+	*number = result;
+	return true;
+}
+
+/** parses a comma separated list of names, returns false if one is empty.
+ */
+bool parse_name_list(const std::string& text, std::vector< std::string >* names) {
+	std::vector< std::string > result;
+	size_t begin = 0;
+	while (begin <= text.size()) {
+		size_t end = text.find(',', begin);
+		if (end == std::string::npos) end = text.size();
+		if (end == begin) return false;
+		result.push_back(text.substr(begin, end - begin));
+		begin = end + 1;
+	}
+	*names = result;
+	return true;
+}
+
+/** parses a comma separated list of numbers in [0, 1] (like "0,0.5,1"),
+ * returns false if one is none.
+ */
+bool parse_rate_list(const std::string& text, std::vector< double >* rates) {
+	std::vector< std::string > items;
+	if (!parse_name_list(text, &items)) return false;
+	std::vector< double > result;
+	for (const std::string& item : items) {
+		char* rest;
+		const double rate = strtod(item.c_str(), &rest);
+		if (*rest != '\0' || !(rate >= 0 && rate <= 1)) return false;
+		result.push_back(rate);
+	}
+	*rates = result;
+	return true;
+}
+
+void print_usage(std::ostream& out, const char* program) {
+	out
+		<< "usage: " << program << " <data_size_log2> [options]" << std::endl
+		<< "options:" << std::endl
+		<< "  --data-size=<log2>       2**log2 values are generated (instead of the first argument)" << std::endl
+		<< "  --values=<n>             exactly n values are generated, not a power of two;" << std::endl
+		<< "                           the kernels that cannot handle that are run on a prefix" << std::endl
+		<< "                           (default: 2**log2, log2 defaults to the one of n)" << std::endl
+		<< "  --mode=<single|multi>    single threaded, multi threaded or both (single,multi)" << std::endl
+		<< "                           benchmarks (default: single)" << std::endl
+		<< "  --widths=<list>          element widths in bits, 32 and/or 64 (default: 32,64)" << std::endl
+		<< "  --isas=<names>           kernel instruction sets, avx and/or avx512" << std::endl
+		<< "                           (default: avx,avx512, the ones the cpu lacks are skipped)" << std::endl
+		<< "  --iterations=<n>         measured executions per kernel and stride (default: " << ITERATIONS << ")" << std::endl
+		<< "  --warmup=<n>             executions before the measured ones, not recorded" << std::endl
+		<< "                           (default: " << WARMUP_ITERATIONS << ")" << std::endl
+		<< "  --cores=<list>           core counts of the multi threaded benchmark, e.g. 1,28,56,112" << std::endl
+		<< "                           (default: 1,2,4,...," << MAX_CORES << ")" << std::endl
+		<< "  --strides=<list>         strides of the strided kernels, e.g. 3,8,24 or 2-16" << std::endl
+		<< "                           (default: 2,4,8,...,32768, at most " << MAX_STRIDE << ")" << std::endl
+		<< "  --kernels=<labels>       only runs these kernels, e.g. gather,seti (default: all)" << std::endl
+		<< "  --prefetch-distances=<list>|auto" << std::endl
+		<< "                           how many gathers ahead the prefetching kernels prefetch," << std::endl
+		<< "                           with several (auto: 1,2,4,...,64) the fastest one is kept" << std::endl
+		<< "                           per point and written to the _prefetch.dat files" << std::endl
+		<< "                           (default: " << DEFAULT_PREFETCH_DISTANCE << ")" << std::endl
+		<< "  --distributions=<names>  index distributions of the lookup kernels:" << std::endl
+		<< "                           uniform,zipf,sorted,clustered,holes (default: all)" << std::endl
+		<< "  --lookups=<log2>         2**log2 lookups per distribution (default: as many as values)" << std::endl
+		<< "  --buckets=<list>         2**log2 buckets of the group-by and histogram kernels, their" << std::endl
+		<< "                           keys distributed as --distributions (default: 8,12,16,20,24)" << std::endl
+		<< "  --table-sizes=<list>     2**log2 slots of the hash tables of the probe kernels, 4 to 31" << std::endl
+		<< "                           (default: 10,14,18,22,26)" << std::endl
+		<< "  --layouts=<names>        hash table layouts: linear (probing) and/or buckets" << std::endl
+		<< "                           (of a cache line) (default: linear,buckets)" << std::endl
+		<< "  --hit-rates=<list>       fractions of the probe keys that are in the table" << std::endl
+		<< "                           (default: 0,0.5,1)" << std::endl
+		<< "  --load-factor=<fraction> fraction of the slots that hold an entry, at most 0.9" << std::endl
+		<< "                           (default: 0.5)" << std::endl
+		<< "  --working-sets=<list>    2**log2 bytes the pointer chases run through, 12 to 33" << std::endl
+		<< "                           (default: 14,18,22,26,28), on each of the --nodes for bind" << std::endl
+		<< "  --hops=<n>               dependent loads per chain and execution of the pointer" << std::endl
+		<< "                           chases (default: " << CHASE_HOPS << ")" << std::endl
+		<< "  --background=<label>     aggregator (e.g. linear) that streams over data of its own on" << std::endl
+		<< "                           further cores while the multi threaded aggregators and" << std::endl
+		<< "                           pointer chases are measured (default: none)" << std::endl
+		<< "  --background-cores=<list>" << std::endl
+		<< "                           cores of the --background load, one run each (default: 0)" << std::endl
+		<< "  --zipf=<exponent>        exponent of the zipf distribution (default: 0.99)" << std::endl
+		<< "  --selectivity=<fraction> fraction of rows the filter of the holes distribution passes" << std::endl
+		<< "                           (default: 0.5)" << std::endl
+		<< "  --cache=cold|warm|as-is  cache and TLB state every measured execution starts in" << std::endl
+		<< "                           (default: cold)" << std::endl
+		<< "  --timing=wall|average    duration of a multi threaded execution: until the last" << std::endl
+		<< "                           thread is done or the average of the threads' durations" << std::endl
+		<< "                           (default: wall)" << std::endl
+		<< "  --placement=bind|interleave|local" << std::endl
+		<< "                           numa placement of the data: bound to the --nodes," << std::endl
+		<< "                           interleaved over the --nodes or each thread's part on" << std::endl
+		<< "                           the node of its cpu (default: bind)" << std::endl
+		<< "  --nodes=<list>           numa nodes for bind and interleave, e.g. 0,2-3" << std::endl
+		<< "                           (default: 0)" << std::endl
+		<< "  --pinning=compact|scatter|cores|smt-pairs|<cpu list>" << std::endl
+		<< "                           cpus of the multi threaded workers, after the topology in" << std::endl
+		<< "                           /sys: sockets one after the other or round robin, the first" << std::endl
+		<< "                           thread of every core before smt siblings, only one thread" << std::endl
+		<< "                           per core, siblings next to each other, or the cpus given," << std::endl
+		<< "                           e.g. 0-15,32-47 (default: compact)" << std::endl
+		<< "  --pages=4k|thp|2m|1g     pages of the data: normal, transparent huge pages or" << std::endl
+		<< "                           explicit huge pages (reserved in /sys/kernel/mm/hugepages)," << std::endl
+		<< "                           falls back to smaller ones if there are none (default: 4k)" << std::endl
+		<< "  --seed=<n>               seed of the generated values and indices, the same seed" << std::endl
+		<< "                           generates the same data (default: random, written to the results)" << std::endl
+		<< "  --max-value=<n>          the values are random in 1..n (at most the largest value of" << std::endl
+		<< "                           the width), large ones make 32 bit sums wrap (default: " << DEFAULT_MAX_VALUE << ")" << std::endl
+		<< "  --csv=<file>             structured results, one line per point with named columns" << std::endl
+		<< "                           and the machine and build (default: ./data/gather/<log2>_points.csv)" << std::endl
+		<< "  --baseline=<file>        structured results of a previous run: measures the same points" << std::endl
+		<< "                           (and its data size, unless given), compares them and exits" << std::endl
+		<< "                           with " << REGRESSION_DETECTED << " if one got significantly slower than the threshold" << std::endl
+		<< "  --regression-threshold=<percent>" << std::endl
+		<< "                           throughput drop that counts as regression (default: " << DEFAULT_REGRESSION_THRESHOLD << ")" << std::endl
+		<< "  --config=<file>          reads options from file, one key=value per line" << std::endl
+		<< "                           (e.g. strides=3,8), # starts a comment" << std::endl;
+}
+
+bool parse_config_file(const std::string& filename, run_options* options, int depth);
+
+/** parses a single argument, either an option of the form --key=value or
+ * the data size, into options.
+ * prints what was wrong and returns false on unknown options or invalid values.
+ * depth counts nested config files, so they cannot include each other forever.
+ */
+bool parse_option(const std::string& argument, run_options* options, int depth = 0) {
+	const size_t equals = argument.find('=');
+	const std::string key = argument.substr(0, equals);
+	const std::string value = equals == std::string::npos ? "" : argument.substr(equals + 1);
+
+	if (argument.compare(0, 2, "--") != 0) {
+		if (parse_positive_number(argument, &options->data_size_log2)) return true;
+		std::cerr << "invalid data size '" << argument << "'" << std::endl;
+		return false;
+	}
+
+	bool valid;
+	if (key == "--data-size") {
+		valid = parse_positive_number(value, &options->data_size_log2);
+	} else if (key == "--values") {
+		valid = parse_positive_number(value, &options->values);
+	} else if (key == "--mode") {
+		std::vector< std::string > modes;
+		valid = parse_name_list(value, &modes);
+		options->single_threaded = false;
+		options->multi_threaded = false;
+		for (const std::string& mode : modes) {
+			if (mode == "single") options->single_threaded = true;
+			else if (mode == "multi") options->multi_threaded = true;
+			else valid = false;
+		}
+	} else if (key == "--widths") {
+		valid = parse_number_list(value, &options->widths);
+		for (uint64_t width : options->widths) valid = valid && (width == 32 || width == 64);
+	} else if (key == "--isas") {
+		std::vector< std::string > names;
+		valid = parse_name_list(value, &names);
+		options->isas.clear();
+		for (const std::string& name : names) {
+			cpu_isa isa;
+			valid = valid && parse_isa(name, &isa);
+			options->isas.push_back(isa);
+		}
+	} else if (key == "--iterations") {
+		valid = parse_positive_number(value, &options->iterations);
+	} else if (key == "--warmup") {
+		valid = parse_number(value, &options->warmup);
+	} else if (key == "--cores") {
+		valid = parse_number_list(value, &options->core_counts);
+		for (uint64_t core_cnt : options->core_counts) valid = valid && core_cnt > 0;
+	} else if (key == "--strides") {
+		valid = parse_number_list(value, &options->strides);
+		for (uint64_t stride : options->strides) valid = valid && stride > 0 && stride <= MAX_STRIDE;
+	} else if (key == "--kernels") {
+		valid = parse_name_list(value, &options->kernels);
+	} else if (key == "--prefetch-distances") {
+		if (value == "auto") {
+			options->prefetch_distances = auto_prefetch_distances();
+			valid = true;
+		} else {
+			valid = parse_number_list(value, &options->prefetch_distances);
+			for (uint64_t distance : options->prefetch_distances) valid = valid && distance > 0;
+		}
+	} else if (key == "--distributions") {
+		std::vector< std::string > names;
+		valid = parse_name_list(value, &names);
+		options->distributions.clear();
+		for (const std::string& name : names) {
+			index_distribution distribution;
+			valid = valid && parse_index_distribution(name, &distribution);
+			options->distributions.push_back(distribution);
+		}
+	} else if (key == "--lookups") {
+		valid = parse_positive_number(value, &options->lookups_log2);
+	} else if (key == "--buckets") {
+		valid = parse_number_list(value, &options->buckets_log2);
+		for (uint64_t buckets : options->buckets_log2) valid = valid && buckets > 0 && buckets <= 31;
+	} else if (key == "--table-sizes") {
+		valid = parse_number_list(value, &options->table_sizes_log2);
+		for (uint64_t slots : options->table_sizes_log2) valid = valid && slots >= 4 && slots <= 31;
+	} else if (key == "--layouts") {
+		std::vector< std::string > names;
+		valid = parse_name_list(value, &names);
+		options->layouts.clear();
+		for (const std::string& name : names) {
+			table_layout layout;
+			valid = valid && parse_table_layout(name, &layout);
+			options->layouts.push_back(layout);
+		}
+	} else if (key == "--hit-rates") {
+		valid = parse_rate_list(value, &options->hit_rates);
+	} else if (key == "--load-factor") {
+		valid = parse_fraction(value, &options->load_factor) && options->load_factor <= 0.9;
+	} else if (key == "--working-sets") {
+		valid = parse_number_list(value, &options->working_sets_log2);
+		for (uint64_t bytes : options->working_sets_log2) valid = valid && bytes >= 12 && bytes <= 33;
+	} else if (key == "--hops") {
+		valid = parse_positive_number(value, &options->hops);
+	} else if (key == "--background") {
+		options->background = value;
+		valid = !value.empty();
+	} else if (key == "--background-cores") {
+		valid = parse_number_list(value, &options->background_cores);
+	} else if (key == "--zipf") {
+		valid = parse_positive_real(value, &options->index_options.zipf_exponent);
+	} else if (key == "--selectivity") {
+		valid = parse_fraction(value, &options->index_options.selectivity);
+	} else if (key == "--cache") {
+		valid = parse_cache_mode(value, &options->cache);
+	} else if (key == "--timing") {
+		valid = parse_timing_mode(value, &options->timing);
+	} else if (key == "--placement") {
+		valid = parse_placement_policy(value, &options->data_placement.policy);
+	} else if (key == "--nodes") {
+		valid = parse_number_list(value, &options->data_placement.nodes);
+	} else if (key == "--pinning") {
+		valid = parse_pinning_policy(value, &options->pinning);
+		if (!valid) {
+			options->pinning = PINNING_LIST;
+			valid = parse_number_list(value, &options->pinning_list);
+		}
+	} else if (key == "--pages") {
+		valid = parse_page_mode(value, &options->data_placement.pages);
+	} else if (key == "--seed") {
+		valid = parse_number(value, &options->seed);
+	} else if (key == "--max-value") {
+		valid = parse_positive_number(value, &options->max_value);
+	} else if (key == "--csv") {
+		options->csv_file = value;
+		valid = !value.empty();
+	} else if (key == "--baseline") {
+		options->baseline_file = value;
+		valid = !value.empty();
+	} else if (key == "--regression-threshold") {
+		valid = parse_positive_real(value, &options->regression_threshold);
+	} else if (key == "--config") {
+		if (depth >= 8) {
+			std::cerr << "config files nested too deeply at '" << value << "'" << std::endl;
+			return false;
+		}
+		return parse_config_file(value, options, depth + 1);
+	} else {
+		std::cerr << "unknown option '" << argument << "'" << std::endl;
+		return false;
+	}
+	if (!valid) {
+		std::cerr << "invalid value '" << value << "' for " << key << std::endl;
+	}
+	return valid;
+}
+
+/** reads options from a file, one key=value per line (the -- in front of
+ * the key is optional), a # starts a comment.
+ * returns false if the file cannot be read or contains an invalid option.
+ */
+bool parse_config_file(const std::string& filename, run_options* options, int depth) {
+	std::ifstream file(filename);
+	if (!file.good()) {
+		std::cerr << "cannot read config file '" << filename << "'" << std::endl;
+		return false;
+	}
+	std::string line;
+	for (int line_number = 1; std::getline(file, line); line_number++) {
+		line = line.substr(0, line.find('#'));
+		const size_t begin = line.find_first_not_of(" \t\r");
+		if (begin == std::string::npos) continue;
+		line = line.substr(begin, line.find_last_not_of(" \t\r") + 1 - begin);
+		if (line.compare(0, 2, "--") != 0) line = "--" + line;
+		if (!parse_option(line, options, depth)) {
+			std::cerr << "in " << filename << ":" << line_number << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+/** parses argv[1..argc-1] into options: the data size and options of the
+ * form --key=value, later ones override earlier ones (which makes
+ * --config=file followed by single options work as expected).
+ * prints what was wrong (and the usage) and returns false on unknown options,
+ * invalid values or a missing data size.
+ */
+bool parse_options(int argc, const char** argv, run_options* options) {
+	for (int a = 1; a < argc; a++) {
+		if (std::string(argv[a]) == "--help") {
+			print_usage(std::cout, argv[0]);
+			return false;
+		}
+		if (!parse_option(argv[a], options)) {
+			print_usage(std::cerr, argv[0]);
+			return false;
+		}
+	}
+	// the labels and file names keep a log2, the one of --values
+	if (options->data_size_log2 == 0 && options->values != 0) {
+		while (((uint64_t) 2 << options->data_size_log2) <= options->values) options->data_size_log2++;
+		if (options->data_size_log2 == 0) options->data_size_log2 = 1;
+	}
+	// with a baseline, the data size can come from there
+	if (options->data_size_log2 == 0 && options->baseline_file.empty()) {
+		std::cerr << "Data Size as input expected (as log_2)!" << std::endl;
+		print_usage(std::cerr, argv[0]);
+		return false;
+	}
+	if (options->data_size_log2 > 40 || options->lookups_log2 > 40) {
+		std::cerr << "Data Size 2**" << std::max(options->data_size_log2, options->lookups_log2) << " is too large!" << std::endl;
+		return false;
+	}
+	return valid_placement(options->data_placement);
+}
+
+/** describes the options as "# key: value" lines, written at the top of
+ * result files (gnuplot skips them) and into the log.
+ */
+std::string options_header(const run_options& options) {
+	std::string header = "";
+	if (options.values != 0) header += "# values: " + std::to_string(options.values) + "\n";
+	header += "# iterations: " + std::to_string(options.iterations) + "\n";
+	header += "# warmup: " + std::to_string(options.warmup) + "\n";
+	header += "# cache_mode: " + cache_mode_name(options.cache) + "\n";
+	header += "# timing: " + timing_mode_name(options.timing) + "\n";
+	header += "# placement: " + placement_name(options.data_placement) + "\n";
+	if (!options.pinned_cpus.empty()) {
+		header += "# pinning: " + pinning_policy_name(options.pinning) + "\n";
+		header += "# cpus: " + cpu_list_name(options.pinned_cpus) + "\n";
+	}
+	header += "# seed: " + std::to_string(options.seed) + "\n";
+	header += "# max_value: " + std::to_string(options.max_value) + "\n";
+	if (!options.background.empty()) header += "# background: " + options.background + "\n";
+	header += "# prefetch_distances:";
+	for (uint64_t distance : options.prefetch_distances) header += " " + std::to_string(distance);
+	header += "\n";
+	return header;
+}
+
+
+#endif // include guard OPTIONS_CPP
@@ -1,17 +1,41 @@
 #ifndef PARAMETERS_H
 #define PARAMETERS_H
 
+// defaults only, --iterations, --warmup, --cores and --hops choose them at runtime
+
 #ifdef ITERATIONS
 #error ITERATIONS already defined!
 #else
 #define ITERATIONS 10
 #endif
 
+#ifdef WARMUP_ITERATIONS
+#error WARMUP_ITERATIONS already defined!
+#else
+// executions before the measured ones, left out of the results
+#define WARMUP_ITERATIONS 1
+#endif
+
 #ifdef MAX_CORES
 #error MAX_CORES already defined
 #else
-// has to be divisible by 2
+// the default core counts are 1, 2, 4, ... MAX_CORES
 #define MAX_CORES 64
 #endif
 
+#ifdef MAX_STRIDE
+#error MAX_STRIDE already defined
+#else
+// the 32 bit gathers take signed 32 bit offsets: the one of the last of 16
+// lanes (15 * stride) has to fit, larger strides need the _i64 kernels' offsets
+#define MAX_STRIDE (((uint64_t) 1 << 31) / 16 - 1)
+#endif
+
+#ifdef CHASE_HOPS
+#error CHASE_HOPS already defined
+#else
+// dependent loads per chain of a pointer chase
+#define CHASE_HOPS ((uint64_t) 1 << 20)
+#endif
+
 #endif // include guard PARAMETERS_H
@@ -0,0 +1,84 @@
+#ifndef PARTITION_CPP
+#define PARTITION_CPP
+
+#include <cstdint>
+
+#include "gather/aggregate_scalar.cpp"
+
+/** values per part boundary and per vector granule: every part starts
+ * 64 byte aligned (for the aligned vector loads) and the kernels only
+ * ever see whole 512 bit vectors of 32 bit values (which are whole
+ * vectors for all other variants, too).
+ */
+constexpr uint64_t PARTITION_ALIGNMENT = 16;
+
+/** which values each of core_cnt threads works on:
+ * thread tid gets count values starting at offset(tid).
+ * the parts are distance apart, which is n / core_cnt rounded down to a
+ * multiple of PARTITION_ALIGNMENT. count is that, rounded down to whole
+ * PARTITION_ALIGNMENT * stride blocks, so the strided kernels never run
+ * past the end of their part. whatever does not fit is not processed.
+ */
+struct partitioning {
+	uint64_t core_cnt;
+	uint64_t distance;
+	uint64_t count;
+	// only partition_all_values: the first remainder threads get one more value
+	uint64_t remainder = 0;
+
+	uint64_t offset(uint64_t tid) const { return tid * distance + (tid < remainder ? tid : remainder); }
+	/** number of values of thread tid */
+	uint64_t count_of(uint64_t tid) const { return count + (tid < remainder ? 1 : 0); }
+	/** number of values processed by all threads together */
+	uint64_t processed() const { return core_cnt * count + remainder; }
+};
+
+/** splits n values over core_cnt threads for a kernel with the given
+ * stride (0 for non-strided ones), see struct partitioning.
+ */
+partitioning partition_values(uint64_t n, uint64_t core_cnt, uint32_t stride) {
+	const uint64_t granule = PARTITION_ALIGNMENT * (stride == 0 ? 1 : stride);
+	partitioning parts;
+	parts.core_cnt = core_cnt;
+	parts.distance = (n / core_cnt) / PARTITION_ALIGNMENT * PARTITION_ALIGNMENT;
+	parts.count = parts.distance / granule * granule;
+	return parts;
+}
+
+/** splits all n values over core_cnt threads, for the kernels that handle
+ * any number of values (aggregator.any_count): thread tid gets n / core_cnt
+ * values (one more for the first n % core_cnt threads), right after the
+ * ones of thread tid - 1, so the parts are not aligned.
+ */
+partitioning partition_all_values(uint64_t n, uint64_t core_cnt) {
+	partitioning parts;
+	parts.core_cnt = core_cnt;
+	parts.distance = n / core_cnt;
+	parts.count = parts.distance;
+	parts.remainder = n % core_cnt;
+	return parts;
+}
+
+/** the sum over the values covered by parts, wrapping like ResultT
+ * (in 64 bit if wide, see aggregate_scalar_wide).
+ * total has to be the 64 bit sum over all n values, so only the smaller of
+ * the covered or uncovered values has to be summed up again.
+ */
+template <class ResultT>
+uint64_t expected_sum(const ResultT* values, uint64_t n, uint64_t total, const partitioning& parts, bool wide = false) {
+	uint64_t sum = 0;
+	if (parts.processed() * 2 < n) {
+		for (uint64_t tid = 0; tid < parts.core_cnt; tid++) {
+			sum += aggregate_scalar_wide(values + parts.offset(tid), parts.count_of(tid));
+		}
+		return wide ? sum : (ResultT) sum;
+	}
+	for (uint64_t tid = 0; tid < parts.core_cnt; tid++) {
+		sum += aggregate_scalar_wide(values + parts.offset(tid) + parts.count_of(tid), parts.offset(tid + 1) - parts.offset(tid) - parts.count_of(tid));
+	}
+	sum += aggregate_scalar_wide(values + parts.offset(parts.core_cnt), n - parts.offset(parts.core_cnt));
+	return wide ? total - sum : (ResultT) (total - sum);
+}
+
+
+#endif // include guard PARTITION_CPP
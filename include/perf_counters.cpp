@@ -0,0 +1,197 @@
+#ifndef PERF_COUNTERS_CPP
+#define PERF_COUNTERS_CPP
+
+#include <cmath>
+#include <cpuid.h>
+#include <errno.h>
+#include <iostream>
+#include <mutex>
+#include <string.h>
+#include <string>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/** the hardware events counted around every measured execution.
+ * l2_misses and memory_stall_cycles are raw intel events
+ * (L2_RQSTS.MISS and CYCLE_ACTIVITY.STALLS_L1D_MISS, the cycles in which
+ * execution stalls while a load misses the L1D), unavailable elsewhere.
+ */
+enum perf_counter_index {
+	PERF_CYCLES,
+	PERF_INSTRUCTIONS,
+	PERF_L1D_MISSES,
+	PERF_L2_MISSES,
+	PERF_LLC_MISSES,
+	PERF_DTLB_MISSES,
+	PERF_MEMORY_STALL_CYCLES,
+	NUMBER_OF_PERF_COUNTERS,
+};
+
+const char* const perf_counter_names[NUMBER_OF_PERF_COUNTERS] = {
+	"cycles",
+	"instructions",
+	"l1d_misses",
+	"l2_misses",
+	"llc_misses",
+	"dtlb_misses",
+	"memory_stall_cycles",
+};
+
+/** counter values, NAN where a counter is not available.
+ */
+struct perf_counts {
+	double value[NUMBER_OF_PERF_COUNTERS];
+
+	perf_counts() {
+		for (double& v : value) v = 0;
+	}
+
+	perf_counts& operator+=(const perf_counts& other) {
+		for (int c = 0; c < NUMBER_OF_PERF_COUNTERS; c++) value[c] += other.value[c];
+		return *this;
+	}
+
+	perf_counts& operator/=(double divisor) {
+		for (double& v : value) v /= divisor;
+		return *this;
+	}
+};
+
+bool cpu_is_intel() {
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx)) return false;
+	return ebx == signature_INTEL_ebx && ecx == signature_INTEL_ecx && edx == signature_INTEL_edx;
+}
+
+/** type and config (see perf_event_open(2)) of counter,
+ * false if it is not available on this cpu.
+ */
+bool perf_event_config(int counter, uint32_t* type, uint64_t* config) {
+	const uint64_t read_miss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	switch (counter) {
+		case PERF_CYCLES:       *type = PERF_TYPE_HARDWARE; *config = PERF_COUNT_HW_CPU_CYCLES; return true;
+		case PERF_INSTRUCTIONS: *type = PERF_TYPE_HARDWARE; *config = PERF_COUNT_HW_INSTRUCTIONS; return true;
+		case PERF_L1D_MISSES:   *type = PERF_TYPE_HW_CACHE; *config = PERF_COUNT_HW_CACHE_L1D | read_miss; return true;
+		case PERF_LLC_MISSES:   *type = PERF_TYPE_HARDWARE; *config = PERF_COUNT_HW_CACHE_MISSES; return true;
+		case PERF_DTLB_MISSES:  *type = PERF_TYPE_HW_CACHE; *config = PERF_COUNT_HW_CACHE_DTLB | read_miss; return true;
+		// event | umask << 8 | cmask << 24
+		case PERF_L2_MISSES:           *type = PERF_TYPE_RAW; *config = 0x24 | 0x3F << 8; return cpu_is_intel();
+		case PERF_MEMORY_STALL_CYCLES: *type = PERF_TYPE_RAW; *config = 0xA3 | 0x0C << 8 | 0x0C << 24; return cpu_is_intel();
+	}
+	return false;
+}
+
+/** prints a warning about unavailable counters only once per run,
+ * the benchmark keeps running without them.
+ */
+void warn_perf_unavailable(const std::string& what) {
+	static std::mutex warned_mutex;
+	static bool warned = false;
+	std::lock_guard< std::mutex > lock(warned_mutex);
+	if (warned) return;
+	warned = true;
+	std::cerr
+		<< "WARNING: " << what << ", the affected counters are reported as nan "
+		<< "(check /proc/sys/kernel/perf_event_paranoid)" << std::endl;
+}
+
+/** a perf_event_open counter group (leader: cycles) for the calling thread,
+ * user space only. start() and stop() wrap exactly the measured region.
+ * every thread needs its own, see thread_perf_counters().
+ */
+class perf_counters {
+	int fds[NUMBER_OF_PERF_COUNTERS];
+	int leader;
+	// position of every counter in the group read, -1 if not opened
+	int position[NUMBER_OF_PERF_COUNTERS];
+	int opened;
+
+public:
+	perf_counters() : leader(-1), opened(0) {
+		for (int c = 0; c < NUMBER_OF_PERF_COUNTERS; c++) {
+			fds[c] = -1;
+			position[c] = -1;
+			uint32_t type;
+			uint64_t config;
+			if (!perf_event_config(c, &type, &config)) continue;
+
+			struct perf_event_attr attr;
+			memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = type;
+			attr.config = config;
+			attr.disabled = leader == -1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			fds[c] = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+			if (fds[c] == -1) {
+				warn_perf_unavailable(std::string("perf_event_open(") + perf_counter_names[c] + ") failed: " + strerror(errno));
+				continue;
+			}
+			if (leader == -1) leader = fds[c];
+			position[c] = opened++;
+		}
+	}
+
+	~perf_counters() {
+		for (int fd : fds) if (fd != -1) close(fd);
+	}
+
+	void start() {
+		if (leader == -1) return;
+		ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+
+	/** stops counting and adds the counts since start() to counts,
+	 * scaled up if the group was multiplexed with other events.
+	 */
+	void stop(perf_counts* counts) {
+		uint64_t buffer[3 + NUMBER_OF_PERF_COUNTERS];
+		bool valid = false;
+		if (leader != -1) {
+			ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+			// nr, time_enabled, time_running, values...
+			valid = read(leader, buffer, sizeof(buffer)) > 0 && buffer[2] > 0;
+			if (!valid) warn_perf_unavailable("the perf counter group could not be scheduled");
+		}
+		for (int c = 0; c < NUMBER_OF_PERF_COUNTERS; c++) {
+			if (!valid || position[c] == -1) {
+				counts->value[c] = NAN;
+			} else {
+				counts->value[c] += (double) buffer[3 + position[c]] * ((double) buffer[1] / (double) buffer[2]);
+			}
+		}
+	}
+};
+
+/** the counters of the calling thread, opened on first use.
+ * as the pool's workers live for the whole run, that happens once per worker.
+ */
+perf_counters& thread_perf_counters() {
+	thread_local perf_counters counters;
+	return counters;
+}
+
+/** "<label>:<counter>" for every counter, space separated,
+ * the column names of a counter file.
+ */
+std::string perf_counter_columns(const std::string& label) {
+	std::string columns = "";
+	for (int c = 0; c < NUMBER_OF_PERF_COUNTERS; c++) {
+		columns += (c == 0 ? "" : " ") + label + ":" + perf_counter_names[c];
+	}
+	return columns;
+}
+
+void print_perf_counts(std::ostream& out, const perf_counts& counts) {
+	for (int c = 0; c < NUMBER_OF_PERF_COUNTERS; c++) {
+		out << " " << counts.value[c];
+	}
+}
+
+
+#endif // include guard PERF_COUNTERS_CPP
@@ -0,0 +1,81 @@
+#ifndef PREFETCH_TUNING_CPP
+#define PREFETCH_TUNING_CPP
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "measures.h"
+#include "gather/prefetch.cpp"
+
+/** measures a kernel with measure(&measurement), which returns whether
+ * the result was correct. a prefetching kernel is measured once for every
+ * distance in distances (as prefetch_distance) and the measurement with
+ * the highest throughput is kept in *best, with its distance.
+ * returns false if any of the results was wrong.
+ */
+template <class Measure>
+bool measure_prefetch_distances(
+	bool prefetching,
+	const std::vector< uint64_t >& distances,
+	measures* best,
+	const Measure& measure
+) {
+	if (!prefetching) return measure(best);
+	bool success = true;
+	for (size_t d = 0; d < distances.size(); d++) {
+		prefetch_distance = distances[d];
+		measures measurement;
+		success = measure(&measurement) && success;
+		if (d == 0 || measurement.throughput > best->throughput) {
+			*best = measurement;
+			best->prefetch_distance = distances[d];
+		}
+	}
+	return success;
+}
+
+/* appends a line to filename: first_columns (e.g. the stride), then the
+ * prefetch distance every prefetching kernel was fastest with, nan where it
+ * was not measured. the other kernels are left out, the "# columns:" line
+ * (after column_names for first_columns) names the ones that are there.
+ * clean starts the file over, with header as its first lines.
+ * nothing is written if none of the kernels is prefetching.
+ */
+void log_prefetch_distances(
+	const std::string& filename,
+	const std::string& column_names,
+	const std::string& first_columns,
+	const std::vector< measures >& results,
+	const std::vector< std::string >& labels,
+	const std::vector< bool >& prefetching,
+	bool clean,
+	std::string header = ""
+) {
+    bool any = false;
+    for ( bool p : prefetching ) any = any || p;
+    if ( !any ) return;
+
+    if ( clean ) {
+        std::ofstream out( filename );
+        out << header << "# columns: " << column_names;
+        for ( size_t k = 0; k < labels.size(); k++ ) {
+            if ( prefetching[ k ] ) out << " " << labels[ k ] << ":distance";
+        }
+        out << std::endl;
+        out.close();
+    }
+
+    std::ofstream out( filename, std::ios_base::app );
+    out << first_columns;
+    for ( size_t k = 0; k < results.size(); k++ ) {
+        if ( !prefetching[ k ] ) continue;
+        if ( results[ k ].prefetch_distance == 0 ) out << " nan";
+        else out << " " << results[ k ].prefetch_distance;
+    }
+    out << std::endl;
+    out.close();
+}
+
+
+#endif // include guard PREFETCH_TUNING_CPP
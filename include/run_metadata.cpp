@@ -0,0 +1,69 @@
+#ifndef RUN_METADATA_CPP
+#define RUN_METADATA_CPP
+
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include "allocate.cpp"
+#include "cpu_features.cpp"
+
+// set by CMakeLists.txt, unknown when built some other way
+#ifndef GIT_REVISION
+#define GIT_REVISION "unknown"
+#endif
+#ifndef BUILD_FLAGS
+#define BUILD_FLAGS "unknown"
+#endif
+
+/** the value of the first "key : value" line of /proc/cpuinfo with key,
+ * "unknown" if there is none.
+ */
+std::string cpuinfo_value(const std::string& key) {
+	std::ifstream cpuinfo("/proc/cpuinfo");
+	std::string line;
+	while (std::getline(cpuinfo, line)) {
+		if (line.compare(0, key.size(), key) != 0) continue;
+		const size_t colon = line.find(':');
+		if (colon == std::string::npos || line.find_first_not_of(" \t", key.size()) != colon) continue;
+		const size_t begin = line.find_first_not_of(" \t", colon + 1);
+		return begin == std::string::npos ? "" : line.substr(begin);
+	}
+	return "unknown";
+}
+
+/** describes the machine, the binary and the invocation of a run as
+ * "# key: value" lines, written at the top of the structured results, so
+ * runs from different hosts and builds can be told apart after merging.
+ */
+std::string run_metadata(int argc, const char** argv) {
+	char host[256] = "unknown";
+	gethostname(host, sizeof(host) - 1);
+	struct utsname system;
+	const bool uname_ok = uname(&system) == 0;
+	char date[64];
+	const time_t now = time(NULL);
+	strftime(date, sizeof(date), "%FT%T%z", localtime(&now));
+	std::string command = "";
+	for (int a = 0; a < argc; a++) command += (a == 0 ? "" : " ") + std::string(argv[a]);
+
+	std::string metadata = "";
+	metadata += "# host: " + std::string(host) + "\n";
+	metadata += "# date: " + std::string(date) + "\n";
+	metadata += "# command: " + command + "\n";
+	metadata += "# cpu_model: " + cpuinfo_value("model name") + "\n";
+	metadata += "# microcode: " + cpuinfo_value("microcode") + "\n";
+	metadata += "# cpu_features: " + cpu_features_description() + "\n";
+	metadata += "# online_cpus: " + std::to_string(sysconf(_SC_NPROCESSORS_ONLN)) + "\n";
+	metadata += "# numa_nodes: " + (numa_usable() ? std::to_string(numa_num_configured_nodes()) : std::string("none")) + "\n";
+	metadata += "# kernel: " + (uname_ok ? std::string(system.sysname) + " " + system.release + " " + system.version : std::string("unknown")) + "\n";
+	metadata += "# compiler: " + std::string(__VERSION__) + "\n";
+	metadata += "# build_flags: " + std::string(BUILD_FLAGS) + "\n";
+	metadata += "# git_revision: " + std::string(GIT_REVISION) + "\n";
+	return metadata;
+}
+
+
+#endif // include guard RUN_METADATA_CPP
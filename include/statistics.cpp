@@ -0,0 +1,79 @@
+#ifndef STATISTICS_CPP
+#define STATISTICS_CPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/** summary of the durations (ns) of the measured executions of a point:
+ * mean, sample standard deviation and the half width of its 95% confidence
+ * interval (student t), min, median and the 5th/95th percentile, and how
+ * many executions are outliers (outside the tukey fences, 1.5 interquartile
+ * ranges beyond the quartiles), e.g. page fault storms or frequency changes.
+ * nan everywhere (0 outliers) without samples.
+ */
+struct sample_statistics {
+	double mean = NAN;
+	double stddev = NAN;
+	double ci95 = NAN;
+	double min = NAN;
+	double median = NAN;
+	double p5 = NAN;
+	double p95 = NAN;
+	uint64_t outliers = 0;
+};
+
+/** two sided 95% quantile of the student t distribution with
+ * degrees_of_freedom, the normal one from 30 on.
+ */
+inline double student_t95(uint64_t degrees_of_freedom) {
+	static const double t[] = {
+		NAN, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+		2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+		2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045
+	};
+	if (degrees_of_freedom < sizeof(t) / sizeof(t[0])) return t[degrees_of_freedom];
+	return 1.96;
+}
+
+/** percentile (0..100) of sorted samples, linearly interpolated */
+inline double percentile(const std::vector< double >& sorted, double p) {
+	if (sorted.empty()) return NAN;
+	const double position = p / 100.0 * (sorted.size() - 1);
+	const size_t below = (size_t) position;
+	if (below + 1 >= sorted.size()) return sorted.back();
+	return sorted[below] + (position - below) * (sorted[below + 1] - sorted[below]);
+}
+
+sample_statistics summarize(std::vector< double > samples) {
+	sample_statistics statistics;
+	const size_t n = samples.size();
+	if (n == 0) return statistics;
+	std::sort(samples.begin(), samples.end());
+
+	double sum = 0;
+	for (double sample : samples) sum += sample;
+	statistics.mean = sum / n;
+	if (n > 1) {
+		double squares = 0;
+		for (double sample : samples) squares += (sample - statistics.mean) * (sample - statistics.mean);
+		statistics.stddev = std::sqrt(squares / (n - 1));
+		statistics.ci95 = student_t95(n - 1) * statistics.stddev / std::sqrt((double) n);
+	}
+	statistics.min = samples.front();
+	statistics.median = percentile(samples, 50);
+	statistics.p5 = percentile(samples, 5);
+	statistics.p95 = percentile(samples, 95);
+
+	const double q1 = percentile(samples, 25);
+	const double q3 = percentile(samples, 75);
+	const double fence = 1.5 * (q3 - q1);
+	for (double sample : samples) {
+		if (sample < q1 - fence || sample > q3 + fence) statistics.outliers++;
+	}
+	return statistics;
+}
+
+
+#endif // include guard STATISTICS_CPP
@@ -0,0 +1,185 @@
+#ifndef STRUCTURED_RESULTS_CPP
+#define STRUCTURED_RESULTS_CPP
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include "measures.h"
+#include "options.cpp"
+#include "perf_counters.cpp"
+
+/** what a measurement is of: the kernel, its width and instruction set
+ * ("avx" or "avx512", as in --isas), single or multi threaded on cores
+ * threads, and either the stride (0 for kernels without one) or, for the
+ * lookup kernels, the index distribution and the number of lookups (for
+ * the group-by kernels the key distribution, the number of rows and of
+ * buckets, for the probe kernels the layout and slots of the hash table,
+ * the hit rate and the number of probes, for the pointer chases the bytes
+ * of the working set and the hops per chain), and the kernel and cores of
+ * the background load it was measured under (multi threaded, see
+ * --background).
+ */
+struct data_point {
+	bool multi_threaded;
+	uint64_t bits;
+	std::string isa;
+	std::string kernel;
+	uint64_t cores;
+	uint64_t stride;
+	std::string distribution; // empty for the strided kernels
+	uint64_t lookups;
+	uint64_t buckets; // 0 but for the group-by kernels
+	std::string layout; // empty but for the probe kernels
+	uint64_t slots;
+	double hit_rate;
+	uint64_t working_set; // 0 but for the pointer chases
+	uint64_t hops;
+	std::string background; // empty without a background load
+	uint64_t background_cores;
+};
+
+/** the point of a strided (or non-strided, stride 0) kernel */
+data_point strided_point(bool multi_threaded, bool avx512, bool bits64, const std::string& kernel, uint64_t cores, uint64_t stride) {
+	return { multi_threaded, (uint64_t) (bits64 ? 64 : 32), isa_name(avx512 ? ISA_AVX512 : ISA_AVX), kernel, cores, stride, "", 0, 0, "", 0, 0, 0, 0 };
+}
+
+/** the point of a lookup kernel */
+data_point lookup_point(bool multi_threaded, bool avx512, bool bits64, const std::string& kernel, uint64_t cores, const std::string& distribution, uint64_t lookups) {
+	return { multi_threaded, (uint64_t) (bits64 ? 64 : 32), isa_name(avx512 ? ISA_AVX512 : ISA_AVX), kernel, cores, 0, distribution, lookups, 0, "", 0, 0, 0, 0 };
+}
+
+/** the point of a group-by kernel */
+data_point groupby_point(bool multi_threaded, bool avx512, bool bits64, const std::string& kernel, uint64_t cores, const std::string& distribution, uint64_t rows, uint64_t buckets) {
+	return { multi_threaded, (uint64_t) (bits64 ? 64 : 32), isa_name(avx512 ? ISA_AVX512 : ISA_AVX), kernel, cores, 0, distribution, rows, buckets, "", 0, 0, 0, 0 };
+}
+
+/** the point of a probe kernel, its keys are uniformly random */
+data_point probe_point(bool multi_threaded, bool avx512, bool bits64, const std::string& kernel, uint64_t cores,
+	const std::string& layout, uint64_t slots, double hit_rate, uint64_t probes) {
+	return { multi_threaded, (uint64_t) (bits64 ? 64 : 32), isa_name(avx512 ? ISA_AVX512 : ISA_AVX), kernel, cores, 0, "uniform", probes, 0, layout, slots, hit_rate, 0, 0 };
+}
+
+/** the point of a pointer chase kernel */
+data_point chase_point(bool multi_threaded, bool avx512, bool bits64, const std::string& kernel, uint64_t cores, uint64_t working_set, uint64_t hops) {
+	return { multi_threaded, (uint64_t) (bits64 ? 64 : 32), isa_name(avx512 ? ISA_AVX512 : ISA_AVX), kernel, cores, 0, "", 0, 0, "", 0, 0, working_set, hops };
+}
+
+/** value as a csv field, quoted if it contains a comma or quote */
+std::string csv_field(const std::string& value) {
+	if (value.find_first_of(",\"") == std::string::npos) return value;
+	std::string quoted = "\"";
+	for (char c : value) quoted += c == '"' ? std::string("\"\"") : std::string(1, c);
+	return quoted + "\"";
+}
+
+/** value as a csv field, with the precision of the structured results */
+std::string csv_real(double value) {
+	std::ostringstream field;
+	field << std::setprecision(10) << value;
+	return field.str();
+}
+
+/** the cpus the first cores workers (the measured ones) are pinned to, like
+ * "0-3", see --pinning
+ */
+std::string measured_cpus(const run_options& options, uint64_t cores) {
+	const std::vector< uint64_t >& cpus = options.pinned_cpus;
+	return cpu_list_name(std::vector< uint64_t >(cpus.begin(), cpus.begin() + std::min< uint64_t >(cores, cpus.size())));
+}
+
+/** the header line of the structured results */
+std::string structured_columns() {
+	std::string columns =
+		"mode,bits,isa,kernel,cores,stride,distribution,lookups,buckets,layout,slots,hit_rate,working_set,hops,background,background_cores,"
+		"data_size_log2,values,placement,pages,cpus,cache_mode,timing,iterations,warmup,prefetch_distance,"
+		"correct,mis,throughput,duration,min,median,p5,p95,stddev,ci95,outliers,imbalance,thread_cv,ns_per_hop,"
+		"background_mis,background_throughput";
+	for (const char* counter : perf_counter_names) columns += std::string(",") + counter;
+	return columns;
+}
+
+/** one csv file with a line per measured point of the whole run (every
+ * width, instruction set and mode), next to the positional .dat files:
+ * the columns are named in the first line after the "# key: value" metadata
+ * lines, so files of many runs can be merged and queried.
+ * nothing is written before open.
+ */
+class structured_results {
+	std::ofstream out;
+
+public:
+	/** starts filename over with header (the metadata) and the column names,
+	 * returns false if it cannot be written.
+	 */
+	bool open(const std::string& filename, const std::string& header) {
+		out.open(filename);
+		if (!out.good()) return false;
+		out << header << structured_columns() << std::endl;
+		out << std::setprecision(10);
+		return true;
+	}
+
+	void write(
+		const data_point& point,
+		const run_options& options,
+		const std::string& pages,
+		const measures& measurement,
+		bool correct
+	) {
+		if (!out.is_open()) return;
+		const bool lookup = !point.distribution.empty();
+		const bool chase = point.working_set != 0;
+		const sample_statistics& s = measurement.statistics;
+		out << (point.multi_threaded ? "multi" : "single")
+			<< "," << point.bits
+			<< "," << point.isa
+			<< "," << csv_field(point.kernel)
+			<< "," << point.cores
+			<< "," << (lookup || chase ? "" : std::to_string(point.stride))
+			<< "," << point.distribution
+			<< "," << (lookup ? std::to_string(point.lookups) : "")
+			<< "," << (point.buckets != 0 ? std::to_string(point.buckets) : "")
+			<< "," << point.layout
+			<< "," << (point.layout.empty() ? "" : std::to_string(point.slots))
+			<< "," << (point.layout.empty() ? "" : csv_real(point.hit_rate))
+			<< "," << (chase ? std::to_string(point.working_set) : "")
+			<< "," << (chase ? std::to_string(point.hops) : "")
+			<< "," << csv_field(point.background)
+			<< "," << (point.background.empty() ? "" : std::to_string(point.background_cores))
+			<< "," << options.data_size_log2
+			<< "," << options.number_of_values()
+			<< "," << csv_field(placement_name(options.data_placement))
+			<< "," << csv_field(pages)
+			<< "," << csv_field(point.multi_threaded ? measured_cpus(options, point.cores) : "")
+			<< "," << cache_mode_name(options.cache)
+			<< "," << (point.multi_threaded ? timing_mode_name(options.timing) : "")
+			<< "," << options.iterations
+			<< "," << options.warmup
+			<< "," << measurement.prefetch_distance
+			<< "," << (correct ? 1 : 0)
+			<< "," << measurement.mis
+			<< "," << measurement.throughput
+			<< "," << measurement.duration
+			<< "," << s.min << "," << s.median << "," << s.p5 << "," << s.p95
+			<< "," << s.stddev << "," << s.ci95 << "," << s.outliers
+			<< "," << measurement.imbalance
+			<< "," << measurement.thread_cv
+			<< "," << (chase ? csv_real(measurement.duration / point.hops) : "")
+			<< "," << measurement.background_mis
+			<< "," << measurement.background_throughput;
+		for (double value : measurement.counters.value) out << "," << value;
+		out << std::endl;
+	}
+};
+
+/** the structured results of this run, see --csv */
+structured_results& structured_output() {
+	static structured_results output;
+	return output;
+}
+
+
+#endif // include guard STRUCTURED_RESULTS_CPP
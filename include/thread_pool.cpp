@@ -0,0 +1,206 @@
+#ifndef THREAD_POOL_CPP
+#define THREAD_POOL_CPP
+
+#include <atomic>
+#include <climits>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <immintrin.h>
+#include <pthread.h>
+#include <sched.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "error_codes.h"
+
+/** how often waiting threads spin (with pause) before falling back to
+ * sleeping on a futex. a few hundred microseconds, so back to back
+ * iterations never touch the kernel but idle threads don't burn a core.
+ */
+constexpr uint64_t SPIN_BEFORE_SLEEP = 1 << 12;
+
+/** waits until word no longer contains expected.
+ * spins for up to spins rounds first, then sleeps on the futex.
+ * sleepers is incremented while sleeping, so wakers can skip the syscall
+ * if nobody sleeps.
+ */
+inline void wait_while_equal(
+	std::atomic<uint32_t>* word,
+	uint32_t expected,
+	std::atomic<uint32_t>* sleepers,
+	uint64_t spins = SPIN_BEFORE_SLEEP
+) {
+	for (uint64_t i = 0; i < spins; i++) {
+		if (word->load(std::memory_order_acquire) != expected) return;
+		_mm_pause();
+	}
+	while (word->load(std::memory_order_acquire) == expected) {
+		sleepers->fetch_add(1);
+		if (word->load() == expected) {
+			syscall(SYS_futex, (uint32_t*) word, FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+		}
+		sleepers->fetch_sub(1);
+	}
+}
+
+/** increments word (releasing everybody in wait_while_equal on it)
+ * and only enters the kernel if somebody actually sleeps.
+ */
+inline void advance_and_wake(
+	std::atomic<uint32_t>* word,
+	std::atomic<uint32_t>* sleepers
+) {
+	word->fetch_add(1);
+	if (sleepers->load() != 0) {
+		syscall(SYS_futex, (uint32_t*) word, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+	}
+}
+
+/** reusable barrier for a fixed number of participants.
+ * the last one to arrive releases all others by bumping the generation,
+ * which they are spinning on, so they leave the barrier (nearly) together.
+ */
+class spin_barrier {
+	alignas(64) std::atomic<uint32_t> arrived;
+	alignas(64) std::atomic<uint32_t> generation;
+	std::atomic<uint32_t> sleepers;
+	uint32_t participants;
+
+public:
+	spin_barrier() : arrived(0), generation(0), sleepers(0), participants(1) {}
+
+	/** only call while nobody is waiting in the barrier */
+	void reset(uint32_t number_of_participants) {
+		participants = number_of_participants;
+		arrived.store(0);
+	}
+
+	void arrive_and_wait() {
+		const uint32_t current = generation.load(std::memory_order_acquire);
+		if (arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == participants) {
+			arrived.store(0, std::memory_order_relaxed);
+			advance_and_wake(&generation, &sleepers);
+		} else {
+			wait_while_equal(&generation, current, &sleepers);
+		}
+	}
+};
+
+/** a fixed set of worker threads, created once and pinned to cpus[tid]
+ * (via pthread_setaffinity_np), that is reused for every benchmark run.
+ * run(core_cnt, job) executes job(tid) on the workers 0..core_cnt-1,
+ * the others are not woken up. jobs call sync() right before their
+ * measured region, so all of them start at the same time.
+ */
+class thread_pool {
+public:
+	typedef std::function< void(const uint64_t) > job_t;
+
+	thread_pool(const std::vector< uint64_t >& cpus) :
+		slots(cpus.size()), finished(0), sleepers(0), done(0), started(0), active(0)
+	{
+		for (uint64_t tid = 0; tid < cpus.size(); tid++) {
+			workers.emplace_back(&thread_pool::work, this, tid);
+
+			cpu_set_t cpuset;
+			CPU_ZERO( &cpuset );
+			CPU_SET( cpus[tid], &cpuset );
+			int rc = pthread_setaffinity_np( workers.back().native_handle(), sizeof( cpu_set_t ), &cpuset );
+			if (rc != 0) {
+				std::cerr << "Error calling pthread_setaffinity_np for cpu " << cpus[tid] << ": " << rc << "\n";
+				exit( PINNING_FAILED );
+			}
+		}
+		// the first run should not have to wait for thread creation
+		while (started.load() != workers.size()) std::this_thread::yield();
+	}
+
+	~thread_pool() {
+		for (slot& s : slots) {
+			s.job = nullptr;
+			advance_and_wake(&s.generation, &sleepers);
+		}
+		for (std::thread& worker : workers) worker.join();
+	}
+
+	size_t size() const { return workers.size(); }
+
+	/** runs job(tid) on the first core_cnt workers and returns
+	 * once all of them are done.
+	 */
+	void run(size_t core_cnt, const job_t& job) {
+		if (core_cnt > workers.size()) {
+			std::cerr << "thread pool has only " << workers.size() << " workers, "
+				<< core_cnt << " requested" << std::endl;
+			exit( NOT_ENOUGH_THREADS );
+		}
+		const uint32_t current = finished.load();
+		active = core_cnt;
+		done.store(0);
+		start_barrier.reset(core_cnt);
+		for (size_t tid = 0; tid < core_cnt; tid++) {
+			slots[tid].job = &job;
+			advance_and_wake(&slots[tid].generation, &sleepers);
+		}
+		wait_while_equal(&finished, current, &sleepers);
+	}
+
+	/** to be called by every job, waits until all workers of the current run
+	 * arrived and releases them together.
+	 */
+	void sync() {
+		start_barrier.arrive_and_wait();
+	}
+
+private:
+	/** what a single worker is told to do, the generation is bumped
+	 * for every job, a nullptr job stops the worker.
+	 */
+	struct alignas(64) slot {
+		std::atomic<uint32_t> generation;
+		const job_t* job;
+		slot() : generation(0), job(nullptr) {}
+	};
+
+	void work(const uint64_t tid) {
+		slot& own = slots[tid];
+		uint32_t seen = own.generation.load();
+		started.fetch_add(1);
+		while (true) {
+			wait_while_equal(&own.generation, seen, &sleepers);
+			seen = own.generation.load();
+			if (own.job == nullptr) return;
+			(*own.job)(tid);
+			if (done.fetch_add(1) + 1 == active) {
+				advance_and_wake(&finished, &sleepers);
+			}
+		}
+	}
+
+	std::vector< std::thread > workers;
+	std::vector< slot > slots;
+	alignas(64) std::atomic<uint32_t> finished;
+	std::atomic<uint32_t> sleepers;
+	alignas(64) std::atomic<uint32_t> done;
+	std::atomic<uint32_t> started;
+	uint32_t active;
+	spin_barrier start_barrier;
+};
+
+/** the cpus this process may run on (its affinity mask, e.g. from taskset) */
+inline std::vector< uint64_t > available_cpus() {
+	std::vector< uint64_t > cpus;
+	cpu_set_t cpuset;
+	CPU_ZERO( &cpuset );
+	if (sched_getaffinity( 0, sizeof( cpu_set_t ), &cpuset ) != 0) return { 0 };
+	for (uint64_t cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+		if (CPU_ISSET( cpu, &cpuset )) cpus.push_back(cpu);
+	}
+	return cpus;
+}
+
+
+#endif // include guard THREAD_POOL_CPP
@@ -1,23 +1,17 @@
-
-# roughly 20 to 30, too low causes segfaults without explanation
-# what too low means depends on threadedness and max_stride (hardcoded)
+# roughly 20 to 33 (2**33 64 bit values are 64 GiB), strides that do not
+# fit into the data are skipped
 # 2**data_size values are allocated
 data_size=26
 data_size=$1
 
-# options: single, multi
-threadedness=multi
-threadedness=$2
-
-# options: avx, avx512
-avx_type=avx
-avx_type=$3
+# everything after the data size is passed to the benchmark,
+# e.g. --mode=single,multi --isas=avx512 --widths=64 --strides=3,8,24
+# --cores=1,56,112 or --config=sweep.cfg
+# (see the usage the benchmark prints for all options)
+shift 1
+options="$@"
 
-# options: 64, 32
-integer_bitcount=64
-integer_bitcount=$4
-
-benchmark=${threadedness}_threaded_benchmark_agg_${avx_type}_${integer_bitcount}
+benchmark=gather_benchmark
 
 echo "makeing sure, the benchmark $benchmark is compiled up to date"
 make $benchmark
@@ -25,6 +19,6 @@ make $benchmark
 logfilename="./data/log_${data_size}_${benchmark}_$(date +%s)"
 echo "start time: $(date +'%F_%T')" >> $logfilename
 echo "running the benchmark, logging to: $logfilename"
-./bin/$benchmark $data_size |& tee --append $logfilename
+echo "options: $options" >> $logfilename
+./bin/$benchmark $data_size $options |& tee --append $logfilename
 echo "stop time: $(date +'%F_%T')" >> $logfilename
-
@@ -0,0 +1,282 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "error_codes.h"
+
+// ITERATIONS and MAX_CORES (defaults of the options)
+#include "parameters.h"
+
+using namespace std;
+
+// every kernel, compiled for its instruction set
+#include "kernel_registry.cpp"
+// template <ResultT> int run_single_threaded(...)
+#include "single_threaded/common.cpp"
+// template <ResultT> int run_multi_threaded(...)
+#include "multi_threaded/common.cpp"
+#include "run_metadata.cpp"
+
+/** runs the kernels for elements of type ResultT of every selected
+ * instruction set the cpu supports, single and/or multi threaded
+ * (on the pool) as chosen in options, all on the same generated data:
+ * first the aggregators over the strides, then the lookups over the
+ * index distributions, then the group-by kernels over the bucket counts
+ * and key distributions, then the probe kernels over the hash tables and
+ * hit rates, then the pointer chases over the working sets and nodes.
+ * the multi threaded aggregators and pointer chases run once per background
+ * load (see --background).
+ * returns the first error, SUCCESS if there is none.
+ */
+template <class ResultT>
+int run_width(const run_options& options, thread_pool* pool) {
+	constexpr bool bits64 = std::is_same<ResultT, uint64_t>::value;
+
+	vector<kernel_set<ResultT>> kernel_sets;
+	// the --background aggregator of each of kernel_sets, unselected ones too
+	vector<aggregator_t<ResultT>> background_kernels;
+	bool with_scatter = false;
+	for (const kernel_set<ResultT>& set : registered_kernels<ResultT>()) {
+		if (!options.isa_selected(set.isa)) continue;
+		if (!isa_supported(set.isa)) {
+			cerr << "WARNING: this cpu does not support " << isa_name(set.isa) << ", skipping its kernels" << endl;
+			continue;
+		}
+		const kernel_set<ResultT> selected = {
+			set.isa,
+			select_kernels(set.aggregators, options.kernels),
+			select_kernels(set.lookups, options.kernels),
+			select_kernels(set.groupbys, options.kernels),
+			select_kernels(set.probes, options.kernels),
+			select_kernels(set.chases, options.kernels),
+		};
+		if (selected.aggregators.empty() && selected.lookups.empty() && selected.groupbys.empty() && selected.probes.empty()
+			&& selected.chases.empty()) continue;
+		for (const aggregator_t<ResultT>& aggregator : selected.aggregators) with_scatter = with_scatter || aggregator.scatter;
+		if (options.multi_threaded && !options.background.empty()) {
+			const vector<aggregator_t<ResultT>> background = select_kernels(set.aggregators, { options.background });
+			if (background.empty() || !background[0].function) {
+				cerr << "--background " << options.background << " is no aggregator of " << isa_name(set.isa) << endl;
+				return INVALID_OPTION;
+			}
+			background_kernels.push_back(background[0]);
+		}
+		kernel_sets.push_back(selected);
+	}
+	if (kernel_sets.empty()) {
+		cerr << "no " << (bits64 ? 64 : 32) << " bit kernels to run" << endl;
+		return SUCCESS;
+	}
+
+	benchmark_data<ResultT> data = prepare_benchmark_data<ResultT>(options.number_of_values(), options.data_placement, with_scatter, *pool, options.seed, options.max_value);
+
+	// the background streams over values of its own, one set of loads per
+	// instruction set (without --background, each has just no load)
+	ResultT* background_values = NULL;
+	if (!background_kernels.empty()) {
+		background_values = prepare_background_values<ResultT>(data.number_of_values, options.data_placement, *pool, options.seed, options.max_value);
+	}
+	vector<vector<background_load>> backgrounds;
+	for (size_t k = 0; k < kernel_sets.size(); k++) {
+		const aggregator_t<ResultT>* kernel = background_kernels.empty() ? nullptr : &background_kernels[k];
+		backgrounds.push_back(background_loads(options, kernel, background_values, data.number_of_values));
+		for (const background_load& background : backgrounds.back()) {
+			if (background.core_cnt != 0 && background.chunks == 0) {
+				cerr << "too few values for " << background.core_cnt << " background cores" << endl;
+				release_benchmark_data(data);
+				deallocate(background_values, data.number_of_values);
+				return DATA_SIZE_TOO_LOW;
+			}
+		}
+	}
+
+	int result = SUCCESS;
+	bool with_lookups = false;
+	bool with_groupbys = false;
+	bool with_probes = false;
+	bool with_chases = false;
+	for (size_t k = 0; k < kernel_sets.size(); k++) {
+		const kernel_set<ResultT>& set = kernel_sets[k];
+		const bool avx512 = set.isa == ISA_AVX512;
+		with_lookups = with_lookups || !set.lookups.empty();
+		with_groupbys = with_groupbys || !set.groupbys.empty();
+		with_probes = with_probes || !set.probes.empty();
+		with_chases = with_chases || !set.chases.empty();
+		if (set.aggregators.empty()) continue;
+		if (options.single_threaded && result == SUCCESS) {
+			result = run_single_threaded<ResultT>(set.aggregators, data, avx512, bits64, options);
+		}
+		for (const background_load& background : backgrounds[k]) {
+			if (options.multi_threaded && result == SUCCESS) {
+				result = run_multi_threaded<ResultT>(*pool, set.aggregators, data, avx512, bits64, options, background);
+			}
+		}
+	}
+
+	// the indices of one distribution at a time are generated and used by
+	// every instruction set, each distribution is one line of the lookup files
+	if (with_lookups && result == SUCCESS) {
+		const uint64_t lookups_log2 = options.lookups_log2 == 0 ? options.data_size_log2 : options.lookups_log2;
+		lookup_indices indices = allocate_lookup_indices(lookups_log2, data.number_of_values, options.data_placement);
+		for (size_t d = 0; d < options.distributions.size(); d++) {
+			generate_lookup_indices(&indices, data, options.distributions[d], options.index_options, options.seed);
+			for (const kernel_set<ResultT>& set : kernel_sets) {
+				const bool avx512 = set.isa == ISA_AVX512;
+				if (set.lookups.empty()) continue;
+				if (options.single_threaded && result == SUCCESS) {
+					result = run_single_threaded_lookups<ResultT>(set.lookups, data, indices, avx512, bits64, options, d == 0);
+				}
+				if (options.multi_threaded && result == SUCCESS) {
+					result = run_multi_threaded_lookups<ResultT>(*pool, set.lookups, data, indices, avx512, bits64, options, d == 0);
+				}
+			}
+		}
+		release_lookup_indices(indices);
+	}
+
+	// the keys of one bucket count and distribution at a time, each one
+	// line of the group-by files, grouping the values of data as rows
+	if (with_groupbys && result == SUCCESS) {
+		groupby_keys<ResultT> keys = allocate_groupby_keys(data, options.data_placement);
+		bool clean = true;
+		for (uint64_t buckets_log2 : options.buckets_log2) {
+			for (index_distribution distribution : options.distributions) {
+				generate_groupby_keys(&keys, data, (uint64_t) 1 << buckets_log2, distribution, options.index_options, options.seed);
+				for (const kernel_set<ResultT>& set : kernel_sets) {
+					const bool avx512 = set.isa == ISA_AVX512;
+					if (set.groupbys.empty()) continue;
+					if (options.single_threaded && result == SUCCESS) {
+						result = run_single_threaded_groupbys<ResultT>(set.groupbys, data, keys, avx512, bits64, options, clean);
+					}
+					if (options.multi_threaded && result == SUCCESS) {
+						result = run_multi_threaded_groupbys<ResultT>(*pool, set.groupbys, data, keys, avx512, bits64, options, clean);
+					}
+				}
+				clean = false;
+			}
+		}
+		release_groupby_keys(keys);
+	}
+
+	// one table (layout and size) at a time, probed with the keys of every
+	// hit rate, each one line of the probe files
+	if (with_probes && result == SUCCESS) {
+		probe_keys<ResultT> keys = allocate_probe_keys(data, options.data_placement);
+		bool clean = true;
+		for (table_layout layout : options.layouts) {
+			for (uint64_t slots_log2 : options.table_sizes_log2) {
+				hash_table<ResultT> table = build_hash_table<ResultT>(layout, slots_log2, options.load_factor, options.data_placement, options.seed, options.max_value);
+				for (double hit_rate : options.hit_rates) {
+					generate_probe_keys(&keys, table, hit_rate, options.seed, options.max_value);
+					for (const kernel_set<ResultT>& set : kernel_sets) {
+						const bool avx512 = set.isa == ISA_AVX512;
+						if (set.probes.empty()) continue;
+						if (options.single_threaded && result == SUCCESS) {
+							result = run_single_threaded_probes<ResultT>(set.probes, data, table, keys, avx512, bits64, options, clean);
+						}
+						if (options.multi_threaded && result == SUCCESS) {
+							result = run_multi_threaded_probes<ResultT>(*pool, set.probes, data, table, keys, avx512, bits64, options, clean);
+						}
+					}
+					clean = false;
+				}
+				release_hash_table(table);
+			}
+		}
+		release_probe_keys(keys);
+	}
+
+	// one cycle (working set and node) at a time, each one line of the
+	// latency files, the placement in the options of the runs is its own
+	if (with_chases && result == SUCCESS) {
+		bool clean = true;
+		for (const placement& where : options.chase_placements()) {
+			run_options on_node = options;
+			on_node.data_placement = where;
+			for (uint64_t bytes_log2 : options.working_sets_log2) {
+				chase_cycle<ResultT> cycle = build_chase_cycle<ResultT>(bytes_log2, where, options.seed);
+				for (size_t k = 0; k < kernel_sets.size(); k++) {
+					const kernel_set<ResultT>& set = kernel_sets[k];
+					const bool avx512 = set.isa == ISA_AVX512;
+					if (set.chases.empty()) continue;
+					if (options.single_threaded && result == SUCCESS) {
+						result = run_single_threaded_chases<ResultT>(set.chases, cycle, avx512, bits64, on_node, clean);
+					}
+					for (const background_load& background : backgrounds[k]) {
+						if (options.multi_threaded && result == SUCCESS) {
+							result = run_multi_threaded_chases<ResultT>(*pool, set.chases, cycle, avx512, bits64, on_node, clean, background);
+						}
+					}
+				}
+				clean = false;
+				release_chase_cycle(cycle);
+			}
+		}
+	}
+
+	release_benchmark_data(data);
+	if (background_values != NULL) deallocate(background_values, data.number_of_values);
+	return result;
+}
+
+int run_widths(const run_options& options, thread_pool* pool) {
+	for (uint64_t width : options.widths) {
+		const int result = width == 32
+			? run_width<uint32_t>(options, pool)
+			: run_width<uint64_t>(options, pool);
+		if (result != SUCCESS) return result;
+	}
+	return SUCCESS;
+}
+
+int main(int argc, const char** argv) {
+    run_options options;
+    if (!parse_options(argc, argv, &options)) {
+        return options.data_size_log2 == 0 ? NO_DATA_SIZE_GIVEN : INVALID_OPTION;
+    }
+	if (!options.baseline_file.empty()) {
+		if (!baseline().load(options.baseline_file) || !baseline().apply_sweep(&options)) return INVALID_OPTION;
+		if (options.data_size_log2 == 0) return NO_DATA_SIZE_GIVEN;
+		if (options.structured_results_filename() == options.baseline_file) {
+			cerr << "the results would overwrite the baseline '" << options.baseline_file << "', choose another --csv" << endl;
+			return INVALID_OPTION;
+		}
+	}
+	warn_unknown_kernels(options.kernels);
+	cout << "cpu features: " << cpu_features_description() << endl;
+
+	// workers are created and pinned once, then reused for every
+	// width, instruction set, aggregator, stride and core count,
+	// they also generate the data (single threaded: one per available cpu),
+	// the background load runs on the ones after the measured ones
+	vector< uint64_t > cpus = available_cpus();
+	if (options.multi_threaded) {
+		options.pinned_cpus = worker_cpus(options.pinning, options.pinning_list, cpus, options.max_worker_count());
+		if (options.pinned_cpus.empty()) {
+			cerr << "--pinning=" << (options.pinning == PINNING_LIST ? cpu_list_name(options.pinning_list) : pinning_policy_name(options.pinning))
+				<< " has fewer than the " << options.max_worker_count() << " cpus the workers need" << endl;
+			return NOT_ENOUGH_THREADS;
+		}
+		cpus = options.pinned_cpus;
+		cout << "workers pinned to cpus " << cpu_list_name(cpus) << " (" << pinning_policy_name(options.pinning) << ")" << endl;
+	}
+
+	const string structured_filename = options.structured_results_filename();
+	if (!structured_output().open(structured_filename, run_metadata(argc, argv) + options_header(options))) {
+		cerr << "writing data to '" << structured_filename << "' failed!" << endl;
+		return RESULT_FILE_NOT_OPENED;
+	}
+	cout << "writing structured results to '" << structured_filename << "'." << endl;
+	if (baseline().loaded() && !baseline().start(run_metadata(argc, argv) + options_header(options), options.comparison_filename(), options.regression_threshold)) {
+		cerr << "writing data to '" << options.comparison_filename() << "' failed!" << endl;
+		return RESULT_FILE_NOT_OPENED;
+	}
+
+	thread_pool pool(cpus);
+	const int result = run_widths(options, &pool);
+	if (result == SUCCESS && !baseline().finish()) return REGRESSION_DETECTED;
+	return result;
+}
@@ -3,20 +3,17 @@
 #include<iostream>
 #include<random>
 #include<chrono>
-#include "immintrin.h"
 #include<fstream>
 #include <string.h>
 #include <math.h>
 #include <functional>
-#include <future>
 #include <thread>
 #include <vector>
 #include <algorithm>
 
-#include "gather/simd_variants/avx/agg_avx_64BitVariants.h"
 #include "error_codes.h"
 
-// ITERATIONS and MAX_CORES
+// ITERATIONS and MAX_CORES (defaults of the options)
 #include "parameters.h"
 
 using namespace std;
@@ -25,148 +22,524 @@ using namespace std;
 #include "aggregation_type.h"
 #include "measures.h"
 #include "make_label.cpp"
+#include "options.cpp"
+#include "partition.cpp"
 multithreaded_measures scalar, linear, gather, seti;
 
-#include "create_thread.cpp"
+#include "thread_pool.cpp"
 #include "log_multithreaded_results.cpp"
-#include "generate_random_values.cpp"
+#include "benchmark_data.cpp"
+#include "log_lookup_results.cpp"
+#include "log_groupby_results.cpp"
+#include "log_probe_results.cpp"
+#include "log_latency_results.cpp"
+#include "gather/lookup_scalar.cpp"
+#include "prefetch_tuning.cpp"
+#include "log_statistics.cpp"
+#include "baseline_comparison.cpp"
+
+/** the load background workers put on the memory system while the workers
+ * of measure_parts are measured: core_cnt more workers (the ones after
+ * those) call pass(tid, chunk) on chunk after chunk of their part of the
+ * background data, round and round, from the start of the measured workers
+ * until the last of them is done. every pass reads chunk_values values
+ * (chunk_bytes). label names the kernel, empty without a background load.
+ */
+struct background_load {
+	std::string label;
+	size_t core_cnt = 0;
+	uint64_t chunks = 0; // per worker
+	uint64_t chunk_values = 0;
+	uint64_t chunk_bytes = 0;
+	std::function< uint64_t(const uint64_t, const uint64_t) > pass;
+};
+
+/** the values a background pass reads: small enough that the measured
+ * workers are never waited for long, large enough for the hardware
+ * prefetchers to get going.
+ */
+constexpr uint64_t BACKGROUND_CHUNK_BYTES = 1 << 20;
+
+/** the load of kernel (an aggregator, strided ones at stride 1) on core_cnt
+ * workers over the n values, each worker on its own part (see
+ * partition_values). chunks is 0 if the parts are too small for the kernel.
+ */
+template <class ResultT>
+background_load make_background_load(const aggregator_t<ResultT>& kernel, const ResultT* values, uint64_t n, size_t core_cnt) {
+	background_load load;
+	load.label = kernel.label;
+	load.core_cnt = core_cnt;
+	if (core_cnt == 0) return load;
+	const partitioning parts = partition_values(n, core_cnt, 0);
+	if (parts.count == 0) return load;
+	const uint64_t chunk = std::min< uint64_t >(BACKGROUND_CHUNK_BYTES / sizeof(ResultT), parts.count);
+	load.chunks = parts.count / chunk;
+	load.chunk_values = chunk;
+	load.chunk_bytes = chunk * sizeof(ResultT);
+	const aggregation_function_t<ResultT> func = kernel.function;
+	const uint32_t stride = kernel.strided ? 1 : 0;
+	load.pass = [parts, values, chunk, func, stride] ( const uint64_t tid, const uint64_t c ) {
+		return func( values + parts.offset( tid ) + c * chunk, chunk, stride );
+	};
+	return load;
+}
 
+/** the background loads the multi threaded runs are measured under, one
+ * run each: kernel on every one of options.background_cores over the n
+ * values, or just no background load if kernel is nullptr (no --background).
+ */
 template <class ResultT>
-bool benchmark(multithreaded_measures* res, uint64_t correct_result, const ResultT* values, uint64_t n, const uint32_t stride, double GB, aggregation_function_t<ResultT> func) {
-    for ( size_t core_cnt = 1; core_cnt <= MAX_CORES; core_cnt *= 2 ) { /* Run with 1, 2, 4, ... MAX_CORES cores */
-        std::vector< std::thread* > pool;
-
-        ResultT* tmp_res = (ResultT*) aligned_alloc( 8 * sizeof(ResultT), core_cnt * sizeof( ResultT ) );
-        double* tmp_dur   = (double*)   aligned_alloc( 64, core_cnt * sizeof( double )  );
-        bool* ready_vec = (bool*) malloc( core_cnt * sizeof( bool ) );
-
-        auto magic = [core_cnt, values, n, stride] ( const uint64_t tid, ResultT* local_result, double* local_duration, bool* local_ready, std::shared_future< void >* sync_barrier, aggregation_function_t<ResultT> local_func ) {
-            // flush all caches and TLB
-            // clean start setting
-            void flush_cache_all(void);
-            void flush_tlb_all(void);
-            local_ready[ tid ] = true;
-            const uint64_t my_value_count = n / core_cnt; /* Should be always divisible by 2, 4 or 8 */
-			// is uint32_t in some benchmarks, wich is hopefully irrelevant
-            const uint64_t my_offset = tid * my_value_count;
-            sync_barrier->wait();
-
-            auto begin = chrono::high_resolution_clock::now();
-            local_result[ tid ] = local_func(values + my_offset, my_value_count, stride);
-            auto end = std::chrono::high_resolution_clock::now();
-
-            local_duration[ tid ] += std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
-        };
+vector<background_load> background_loads(const run_options& options, const aggregator_t<ResultT>* kernel, const ResultT* values, uint64_t n) {
+	if (kernel == nullptr) return { background_load() };
+	vector<background_load> loads;
+	for (uint64_t core_cnt : options.background_cores) {
+		loads.push_back(make_background_load(*kernel, values, n, core_cnt));
+	}
+	return loads;
+}
 
-        double averaged_duration = 0.0;
-        for (int i=0; i<ITERATIONS; i++) {
-            std::promise< void > p;
-		    std::shared_future< void > ready_future( p.get_future( ) );
+/** "_<cores>_<label>_background", which the result files of a run under
+ * background get before their core count, "" without a background load.
+ */
+std::string background_suffix(const background_load& background) {
+	if (background.label.empty()) return "";
+	return "_" + to_string(background.core_cnt) + "_" + background.label + "_background";
+}
 
-            memset( tmp_res, 0, core_cnt * sizeof( ResultT ) );
-            memset( tmp_dur, 0, core_cnt * sizeof( double ) );
-            memset( ready_vec, 0, core_cnt * sizeof( bool ) );
+/** the background cores as "# key: value" line, see options_header */
+std::string background_header(const background_load& background) {
+	if (background.label.empty()) return "";
+	return "# background_cores: " + to_string(background.core_cnt) + "\n";
+}
 
-            for ( size_t tid = 0; tid < core_cnt; ++tid ) {
-                pool.emplace_back( create_thread( tid, tmp_res, tmp_dur, ready_vec, &ready_future, magic, func ) );
+/** point, marked as measured under background */
+data_point under_background(data_point point, const background_load& background) {
+	point.background = background.label;
+	point.background_cores = background.core_cnt;
+	return point;
+}
+
+/** what background worker tid does in an execution of measure_parts:
+ * passes until stop is set (the one it is in is finished), returns the
+ * bytes it read and the nanoseconds that took.
+ */
+void run_background(
+	thread_pool& pool,
+	const background_load& background,
+	const uint64_t tid,
+	const std::atomic< bool >& stop,
+	double* bytes,
+	double* duration
+) {
+        uint64_t passes = 0;
+        uint64_t chunk = 0;
+        pool.sync(); /* starts with the measured workers */
+        auto begin = chrono::steady_clock::now();
+        while ( background.chunks != 0 && !stop.load( std::memory_order_relaxed ) ) {
+            background.pass( tid, chunk );
+            passes++;
+            chunk = chunk + 1 == background.chunks ? 0 : chunk + 1;
+        }
+        auto end = chrono::steady_clock::now();
+        *bytes = static_cast< double >( passes * background.chunk_bytes );
+        *duration = static_cast< double >( chrono::duration_cast<chrono::nanoseconds>( end - begin ).count() );
+}
+
+/** runs call(tid) on parts.core_cnt workers of the pool, options.warmup
+ * times without recording anything, then options.iterations times and
+ * returns its result (summed over the threads), duration, throughput (of
+ * bytes per execution), mis (of parts.processed() values), the hardware
+ * counters (summed over the threads, averaged over the executions), the
+ * duration of every execution with their statistics and how unevenly the
+ * threads took.
+ * the duration of an execution is chosen by options.timing: from the first
+ * thread leaving the start barrier until the last one is done (wall) or
+ * the average of the threads' durations (average).
+ * before every execution, each worker calls prepare(tid), which brings
+ * its part of the data into the cache state chosen in options.
+ * meanwhile, the workers after those put background on the memory system
+ * (the pool needs them, too), which is measured on its own.
+ */
+template <class Prepare, class Call>
+struct measures measure_parts(
+	thread_pool& pool,
+	const run_options& options,
+	const partitioning& parts,
+	uint64_t bytes,
+	const Prepare& prepare,
+	const Call& call,
+	const background_load& background = background_load()
+) {
+        const size_t core_cnt = parts.core_cnt;
+        const uint64_t iterations = options.iterations;
+        uint64_t* tmp_res = (uint64_t*) aligned_alloc( 64, core_cnt * sizeof( uint64_t ) );
+        /* steady_clock time points (ns), comparable between the threads */
+        std::vector< int64_t > tmp_begin( core_cnt );
+        std::vector< int64_t > tmp_end( core_cnt );
+        int64_t* begins = tmp_begin.data();
+        int64_t* ends = tmp_end.data();
+        std::vector< perf_counts > tmp_counts( core_cnt );
+        perf_counts* counts = tmp_counts.data();
+        /* the background workers, tid core_cnt and on, run until the last measured one is done */
+        const size_t workers = core_cnt + background.core_cnt;
+        std::vector< double > tmp_background_bytes( background.core_cnt );
+        std::vector< double > tmp_background_durations( background.core_cnt );
+        double* background_bytes = tmp_background_bytes.data();
+        double* background_durations = tmp_background_durations.data();
+        std::atomic< size_t > running( core_cnt );
+        std::atomic< bool > stop( false );
+
+        const thread_pool::job_t magic = [&pool, &prepare, &call, &background, &running, &stop, core_cnt, tmp_res, begins, ends, counts,
+            background_bytes, background_durations] ( const uint64_t tid ) {
+            if ( tid >= core_cnt ) {
+                run_background( pool, background, tid - core_cnt, stop, &background_bytes[ tid - core_cnt ], &background_durations[ tid - core_cnt ] );
+                return;
             }
-            bool all_ready = false;
-            while ( !all_ready ) {
-                /* Wait until all threads are ready to go before we pull the trigger */
-                using namespace std::chrono_literals;
-                std::this_thread::sleep_for( 1ms );
-                all_ready = true;
-                for ( size_t i = 0; i < core_cnt; ++i ) {
-                    all_ready &= ready_vec[ i ];
-                }
+            // flush (or warm) caches and TLB, clean start setting
+            prepare( tid );
+            perf_counters& counters = thread_perf_counters();
+            pool.sync(); /* all workers start together */
+
+            counters.start();
+            auto begin = chrono::steady_clock::now();
+            tmp_res[ tid ] = call( tid );
+            auto end = chrono::steady_clock::now();
+            counters.stop( &counts[ tid ] );
+            if ( running.fetch_sub( 1 ) == 1 ) stop.store( true );
+
+            begins[ tid ] = chrono::duration_cast<chrono::nanoseconds>( begin.time_since_epoch() ).count();
+            ends[ tid ] = chrono::duration_cast<chrono::nanoseconds>( end.time_since_epoch() ).count();
+        };
+
+        const auto execute = [&pool, &running, &stop, core_cnt, workers, &magic] () {
+            running.store( core_cnt );
+            stop.store( false );
+            pool.run( workers, magic ); /* returns once all workers are done */
+        };
+
+        for (uint64_t i=0; i<options.warmup; i++) {
+            execute();
+        }
+        for ( size_t i = 0; i < core_cnt; ++i ) {
+            tmp_counts[ i ] = perf_counts();
+        }
+
+        double total_duration = 0.0;
+        double total_imbalance = 0.0;
+        double total_cv = 0.0;
+        double total_background_rate = 0.0; /* bytes per ns, summed over the background workers */
+        std::vector< double > samples;
+        for (uint64_t i=0; i<iterations; i++) {
+            memset( tmp_res, 0, core_cnt * sizeof( uint64_t ) );
+
+            execute();
+
+            for ( size_t t = 0; t < background.core_cnt; ++t ) {
+                if ( tmp_background_durations[ t ] > 0 ) total_background_rate += tmp_background_bytes[ t ] / tmp_background_durations[ t ];
             }
-            p.set_value(); /* Start execution by notifying on the void promise */
-            std::for_each( pool.begin(), pool.end(),
-                []( std::thread* t ) {
-                     t->join();
-                     delete t; }
-            ); /* Join and delete threads as soon as they are finished */
-            pool.clear();
-            double iteration_duration = 0.0;
-            for ( size_t i = 0; i < core_cnt; ++i ) {
-                iteration_duration += tmp_dur[ i ];
+
+            int64_t first_begin = tmp_begin[ 0 ];
+            int64_t last_end = tmp_end[ 0 ];
+            double sum = 0.0, squares = 0.0;
+            double shortest = INFINITY, longest = 0.0;
+            for ( size_t t = 0; t < core_cnt; ++t ) {
+                const double thread_duration = static_cast< double >( tmp_end[ t ] - tmp_begin[ t ] );
+                first_begin = std::min( first_begin, tmp_begin[ t ] );
+                last_end = std::max( last_end, tmp_end[ t ] );
+                sum += thread_duration;
+                squares += thread_duration * thread_duration;
+                shortest = std::min( shortest, thread_duration );
+                longest = std::max( longest, thread_duration );
             }
-            averaged_duration += iteration_duration / static_cast< double >( core_cnt );
+            const double average = sum / static_cast< double >( core_cnt );
+            const double variance = std::max( 0.0, squares / static_cast< double >( core_cnt ) - average * average );
+            const double iteration_duration = options.timing == TIMING_WALL
+                ? static_cast< double >( last_end - first_begin )
+                : average;
+            total_duration += iteration_duration;
+            total_imbalance += longest / shortest;
+            total_cv += std::sqrt( variance ) / average;
+            samples.push_back( iteration_duration );
         }
 
-        /* Beware, this is an average of averages. We can also do average of max(thread_runtimes) */
-        const double cur_dur = static_cast< double >( averaged_duration ) / static_cast< double >( ITERATIONS );
+        const double cur_dur = total_duration / static_cast< double >( iterations );
         /* Integer in Millions / time * 10^9 (becausue nanoseconds) */
-        const double cur_mis = ( static_cast<double>( n ) / 1000000.0 ) / ( cur_dur * 1e-9 );
+        const double cur_mis = ( static_cast<double>( parts.processed() ) / 1000000.0 ) / ( cur_dur * 1e-9 );
+        const double GB = static_cast<double>( bytes ) / ( 1024.0 * 1024.0 * 1024.0 );
         const double cur_tput = GB / ( cur_dur * 1e-9 );
         uint64_t cur_res = 0;
+        perf_counts cur_counts;
         for ( size_t i = 0; i < core_cnt; ++i ) {
             cur_res += tmp_res[ i ];
+            cur_counts += tmp_counts[ i ]; /* summed over the threads */
+        }
+        cur_counts /= iterations;
+
+        struct measures tmp_measures = { cur_res, cur_dur, cur_tput, cur_mis, cur_counts };
+        tmp_measures.samples = samples;
+        tmp_measures.statistics = summarize( samples );
+        tmp_measures.imbalance = total_imbalance / static_cast< double >( iterations );
+        tmp_measures.thread_cv = total_cv / static_cast< double >( iterations );
+        if ( background.core_cnt != 0 ) {
+            const double rate = total_background_rate / static_cast< double >( iterations );
+            const double value_bytes = static_cast< double >( background.chunk_bytes ) / static_cast< double >( std::max< uint64_t >( background.chunk_values, 1 ) );
+            /* GB/s and million values per second from bytes per ns */
+            tmp_measures.background_throughput = rate * 1e9 / ( 1024.0 * 1024.0 * 1024.0 );
+            tmp_measures.background_mis = rate / value_bytes * 1e3;
         }
 
-        const struct measures tmp_measures = { cur_res, cur_dur, cur_tput, cur_mis };
-        (*res)[ core_cnt ] = tmp_measures;
-
-        free( ready_vec );
-        free( tmp_dur );
         free( tmp_res );
-    }
 
-    bool success = true;
-    for ( size_t core_cnt = 1; core_cnt <= MAX_CORES; core_cnt *= 2 ) {
-        success &= (*res)[ core_cnt ].result == correct_result;
-    }
+        return tmp_measures;
+}
 
-    return success;
+/** runs func on parts.core_cnt workers of the pool, each on its own part of
+ * the values (see partition.cpp), see measure_parts.
+ * ArrayT is const for aggregating (reading) functions and non-const for
+ * scattering (writing) ones. background runs meanwhile.
+ */
+template <class ArrayT>
+struct measures measure_core_count(
+	thread_pool& pool,
+	const run_options& options,
+	const partitioning& parts,
+	ArrayT* values,
+	const uint32_t stride,
+	uint64_t (*func)(ArrayT*, uint64_t, const uint32_t),
+	const background_load& background
+) {
+        const cache_mode cache = options.cache;
+        return measure_parts( pool, options, parts, parts.processed() * sizeof( *values ),
+            [cache, parts, values] ( const uint64_t tid ) {
+                prepare_caches( cache, values + parts.offset( tid ), parts.count_of( tid ) * sizeof( *values ) );
+            },
+            [parts, values, stride, func] ( const uint64_t tid ) {
+                return func( values + parts.offset( tid ), parts.count_of( tid ), stride ); /* whole blocks of 16 * stride values, unless any_count */
+            }, background );
 }
 
+/** runs func on the parts of the values, see measure_core_count.
+ * returns true if the result matches correct_result, the sum over the
+ * values covered by parts (compared as ResultT, i.e. wrapping like ResultT does,
+ * or in 64 bit for wide functions).
+ */
 template <class ResultT>
-int main_multi_threaded(
-	const vector<aggregator_t<ResultT>> aggregators,
-	uint64_t data_size_log2,
-	bool multi_threaded,
-	bool avx512,
-	bool bits64
-) {
-    // define number of values
-    // 27 --> 134 million integers --> 8GB
-    // 26 --> 67 million integers --> 4GB
-    uint64_t number_of_values = pow(2, data_size_log2);
-	cerr << "number_of_values: " << number_of_values << endl;
+bool benchmark(thread_pool& pool, const run_options& options, const partitioning& parts, multithreaded_measures* res, uint64_t correct_result, const ResultT* values, const uint32_t stride, aggregation_function_t<ResultT> func, bool wide = false, const background_load& background = background_load()) {
+    (*res)[ parts.core_cnt ] = measure_core_count( pool, options, parts, values, stride, func, background );
+    if ( wide ) return (*res)[ parts.core_cnt ].result == correct_result;
+    return (ResultT) (*res)[ parts.core_cnt ].result == (ResultT) correct_result;
+}
 
+/** like benchmark, but for scatter functions, which write into values.
+ * values is overwritten with a poison pattern first, afterwards the sum
+ * over the parts of values has to match the checksums returned by func,
+ * which only happens if func actually wrote every position.
+ * both checksums are compared as ResultT, i.e. wrapping like ResultT does.
+ */
+template <class ResultT>
+bool benchmark_scatter(thread_pool& pool, const run_options& options, const partitioning& parts, multithreaded_measures* res, ResultT* values, uint64_t n, const uint32_t stride, scatter_function_t<ResultT> func, const background_load& background = background_load()) {
+    memset( values, 0xff, n * sizeof( ResultT ) );
+    (*res)[ parts.core_cnt ] = measure_core_count( pool, options, parts, values, stride, func, background );
+    uint64_t written = 0;
+    for ( size_t tid = 0; tid < parts.core_cnt; ++tid ) {
+        written += aggregate_scalar( values + parts.offset( tid ), parts.count_of( tid ) );
+    }
+    return (ResultT) (*res)[ parts.core_cnt ].result == (ResultT) written;
+}
 
-    // define max stride size (power of 2)
-    size_t max_stride = 15;
-	cerr << "max_stride: " << max_stride << ", 2**max_stride: " << (1 << max_stride) << endl;
+/** like benchmark, but for lookup functions: every worker looks up the
+ * values at the positions in its part of index (see partition.cpp),
+ * the values themselves are shared. mis is million lookups per second,
+ * throughput counts the looked up values (not the index).
+ * before every execution, each worker brings its part of the index and
+ * its share of the values into the cache state chosen in options.
+ * returns true if the result matches the one of lookup_scalar.
+ */
+template <class ResultT, class IndexT>
+bool benchmark_lookup(thread_pool& pool, const run_options& options, const partitioning& parts, measures* res, const ResultT* values, uint64_t values_count, const IndexT* index, lookup_function_t<ResultT, IndexT> func) {
+    const partitioning value_parts = partition_values( values_count, parts.core_cnt, 0 );
+    const cache_mode cache = options.cache;
+    *res = measure_parts( pool, options, parts, parts.processed() * sizeof( ResultT ),
+        [cache, parts, value_parts, values, values_count, index] ( const uint64_t tid ) {
+            const uint64_t value_offset = value_parts.offset( tid );
+            const uint64_t value_count = tid + 1 == parts.core_cnt ? values_count - value_offset : value_parts.distance;
+            prepare_caches( cache, values + value_offset, value_count * sizeof( ResultT ), index + parts.offset( tid ), parts.count * sizeof( IndexT ) );
+        },
+        [parts, values, index, func] ( const uint64_t tid ) {
+            return func( values, index + parts.offset( tid ), parts.count );
+        } );
+    uint64_t expected = 0;
+    for ( size_t tid = 0; tid < parts.core_cnt; ++tid ) {
+        expected += lookup_scalar( values, index + parts.offset( tid ), parts.count );
+    }
+    return (ResultT) (*res).result == (ResultT) expected;
+}
 
-	if (max_stride + 1 < data_size_log2) {
-		/* this stride is fine */
-	} else {
-		cerr
-			<< "Data Size is 2**" << data_size_log2 << " == " << (1<<data_size_log2)
-			<< " which does not allow the hardcoded maximum stride of "
-			<< "2**" << max_stride << " == " << (1<<max_stride) << "!"
-		<< endl;
-		return DATA_SIZE_TOO_LOW;
-	}
+/** like benchmark, but for group-by functions: every worker adds its part
+ * of the rows (values and keys, see partition_all_values) into buckets.
+ * shared functions (atomic updates) all add into buckets directly, the
+ * others each into their own table in private_buckets (core_cnt tables of
+ * bucket_count buckets), which the workers then merge into buckets, every
+ * one a slice of the buckets. the merge is part of the measured time.
+ * before every execution, each worker zeroes its slice of buckets and its
+ * table and brings them and its rows into the cache state chosen in options.
+ * mis is million rows per second, throughput counts the values and keys read.
+ * returns true if the buckets end up like expected (and the result is the
+ * sum of the added values).
+ */
+template <class ResultT>
+bool benchmark_groupby(
+    thread_pool& pool,
+    const run_options& options,
+    const partitioning& parts,
+    measures* res,
+    const ResultT* values,
+    const uint32_t* keys,
+    ResultT* buckets,
+    ResultT* private_buckets,
+    uint64_t bucket_count,
+    const std::vector< ResultT >& expected,
+    uint64_t expected_sum,
+    const groupby_kernel<ResultT>& groupby
+) {
+    const partitioning bucket_parts = partition_all_values( bucket_count, parts.core_cnt );
+    const cache_mode cache = options.cache;
+    const bool histogram = groupby.histogram;
+    const bool shared = groupby.shared;
+    const groupby_function_t<ResultT> func = groupby.function;
+    const uint64_t row_bytes = ( histogram ? 0 : sizeof( ResultT ) ) + sizeof( uint32_t );
+    *res = measure_parts( pool, options, parts, parts.processed() * row_bytes,
+        [cache, parts, bucket_parts, values, keys, buckets, private_buckets, bucket_count, histogram, shared] ( const uint64_t tid ) {
+            memset( buckets + bucket_parts.offset( tid ), 0, bucket_parts.count_of( tid ) * sizeof( ResultT ) );
+            if ( !shared ) memset( private_buckets + tid * bucket_count, 0, bucket_count * sizeof( ResultT ) );
+            prepare_caches( cache, buckets + bucket_parts.offset( tid ), bucket_parts.count_of( tid ) * sizeof( ResultT ),
+                shared ? nullptr : private_buckets + tid * bucket_count, shared ? 0 : bucket_count * sizeof( ResultT ) );
+            prepare_caches( cache, values + parts.offset( tid ), histogram ? 0 : parts.count_of( tid ) * sizeof( ResultT ),
+                keys + parts.offset( tid ), parts.count_of( tid ) * sizeof( uint32_t ) );
+        },
+        [&pool, parts, bucket_parts, values, keys, buckets, private_buckets, bucket_count, shared, func] ( const uint64_t tid ) {
+            if ( shared ) {
+                return func( values + parts.offset( tid ), keys + parts.offset( tid ), parts.count_of( tid ), buckets, bucket_count );
+            }
+            const uint64_t sum = func( values + parts.offset( tid ), keys + parts.offset( tid ), parts.count_of( tid ),
+                private_buckets + tid * bucket_count, bucket_count );
+            pool.sync(); /* every table is done */
+            ResultT* slice = buckets + bucket_parts.offset( tid );
+            for ( uint64_t t = 0; t < parts.core_cnt; ++t ) {
+                const ResultT* table = private_buckets + t * bucket_count + bucket_parts.offset( tid );
+                for ( uint64_t b = 0; b < bucket_parts.count_of( tid ); ++b ) slice[ b ] += table[ b ];
+            }
+            return sum;
+        } );
+    return (ResultT) (*res).result == (ResultT) expected_sum
+        && memcmp( buckets, expected.data(), bucket_count * sizeof( ResultT ) ) == 0;
+}
 
-    //compute GB for number of values
-    double GB = (((double)number_of_values*sizeof(ResultT)/(double)1024)/(double)1024)/(double)1024;
+/** like benchmark, but for hash table probes: every worker looks up its part
+ * of the keys (see partition_all_values) in the one table they share.
+ * before every execution, each worker brings its keys and a slice of the
+ * table into the cache state chosen in options.
+ * mis is million probes per second, throughput counts the keys read.
+ * returns true if the sum of the values found is expected.
+ */
+template <class ResultT>
+bool benchmark_probe(
+    thread_pool& pool,
+    const run_options& options,
+    const partitioning& parts,
+    measures* res,
+    const hash_table<ResultT>& table,
+    const ResultT* keys,
+    uint64_t expected,
+    probe_function_t<ResultT> func
+) {
+    const partitioning slot_parts = partition_all_values( table.slots(), parts.core_cnt );
+    const cache_mode cache = options.cache;
+    *res = measure_parts( pool, options, parts, parts.processed() * sizeof( ResultT ),
+        [cache, parts, slot_parts, &table, keys] ( const uint64_t tid ) {
+            prepare_caches( cache, table.keys + slot_parts.offset( tid ), slot_parts.count_of( tid ) * sizeof( ResultT ),
+                table.values + slot_parts.offset( tid ), slot_parts.count_of( tid ) * sizeof( ResultT ) );
+            prepare_caches( cache, keys + parts.offset( tid ), parts.count_of( tid ) * sizeof( ResultT ) );
+        },
+        [parts, &table, keys, func] ( const uint64_t tid ) {
+            return func( table, keys + parts.offset( tid ), parts.count_of( tid ) );
+        } );
+    return (ResultT) (*res).result == (ResultT) expected;
+}
 
+/** like benchmark, but for pointer chases: every one of core_cnt workers
+ * follows its own lanes chains through the one cycle they share (all chains
+ * start evenly spread over it), so the other workers' chases are the load
+ * under which each one's latency is measured (background adds its own).
+ * before every execution, each worker brings a slice of the working set into
+ * the caches (whatever options.cache says).
+ * mis is million loads per second (of all chains), throughput counts the
+ * positions read.
+ * returns true if all chains end where expected.
+ */
+template <class ResultT>
+bool benchmark_chase(
+    thread_pool& pool,
+    const run_options& options,
+    size_t core_cnt,
+    measures* res,
+    const chase_cycle<ResultT>& cycle,
+    const ResultT* starts,
+    uint64_t lanes,
+    uint64_t expected,
+    chase_function_t<ResultT> func,
+    const background_load& background = background_load()
+) {
+    const uint64_t hops = options.hops;
+    const partitioning loads = partition_all_values( core_cnt * hops * lanes, core_cnt );
+    const partitioning slices = partition_all_values( cycle.number, core_cnt );
+    *res = measure_parts( pool, options, loads, loads.processed() * sizeof( ResultT ),
+        [slices, &cycle] ( const uint64_t tid ) {
+            prepare_caches( CACHE_WARM, cycle.next + slices.offset( tid ), slices.count_of( tid ) * sizeof( ResultT ) );
+        },
+        [&cycle, starts, lanes, hops, func] ( const uint64_t tid ) {
+            return func( cycle.next, starts + tid * lanes, hops );
+        }, background );
+    return (ResultT) (*res).result == (ResultT) expected;
+}
 
-    /**
-     * allocate memory and fill with random numbers
-     */
-    ResultT* array = allocate<ResultT>(number_of_values);
-    if (array != NULL) {
-        cout << "Memory allocated - " << number_of_values << " values" << endl;
-    } else {
-        cout << "Memory not allocated" << endl;
-		exit(NO_MEMORY);
-    }
-    generate_random_values(array, number_of_values);
-    uint64_t correct = aggregate_scalar(array, number_of_values);
-    cout <<"Generation done."<<endl;
+/** moves the part of the values each of the core_cnt workers works on
+ * to the numa node of the worker's cpu, only for --placement=local.
+ */
+template <class ResultT>
+void place_partitions(thread_pool& pool, const run_options& options, size_t core_cnt, ResultT* values, uint64_t n) {
+    if ( options.data_placement.policy != PLACEMENT_LOCAL || values == NULL ) return;
+    const partitioning parts = partition_values( n, core_cnt, 0 );
+    pool.run( core_cnt, [&options, parts, values] ( const uint64_t tid ) {
+        place_locally( options.data_placement, values + parts.offset( tid ), parts.distance * sizeof( ResultT ) );
+    } );
+}
+
+/** runs the aggregators (all of one instruction set) on the workers of
+ * the pool over data for every core count and stride in options and
+ * writes the results to ./data/gather/<label>_<core count>_cores.dat,
+ * _cores_counters.dat, _cores_statistics.dat, _cores_samples.dat and
+ * _cores_imbalance.dat (and the prefetch distances to _cores_prefetch.dat).
+ * under a background load, <label> ends with its background_suffix and
+ * its throughput goes to _cores_background.dat.
+ * the pool needs at least options.max_core_count() workers, and the
+ * background ones on top.
+ */
+template <class ResultT>
+int run_multi_threaded(
+	thread_pool& pool,
+	const vector<aggregator_t<ResultT>>& aggregators,
+	const benchmark_data<ResultT>& data,
+	bool avx512,
+	bool bits64,
+	const run_options& options,
+	const background_load& background = background_load()
+) {
+	const bool multi_threaded = true;
+	const uint64_t number_of_values = data.number_of_values;
+	ResultT* array = data.array;
+	ResultT* scatter_array = data.scatter_array;
+	const uint64_t correct = data.correct;
 
     /**
      * run several benchmarks on generated data
@@ -177,8 +550,16 @@ int main_multi_threaded(
 	measurements.assign(aggregators.size(), multithreaded_measures());
 
     // open files to store runtime measurements
-	string label = make_label(data_size_log2, multi_threaded, avx512, bits64);
-	string result_filename_base = "./data/gather/" + label;
+	string label = make_label(options.data_size_log2, multi_threaded, avx512, bits64);
+	string result_filename_base = "./data/gather/" + label + background_suffix(background);
+	const string header = options_header(options) + data_header(data) + background_header(background);
+	vector<string> labels;
+	vector<bool> prefetching;
+	for (const aggregator_t<ResultT>& aggregator : aggregators) {
+		labels.push_back(aggregator.label);
+		prefetching.push_back(aggregator.prefetching);
+	}
+	cout << header;
 
 	/*
 	if (result_file.good()) {
@@ -190,57 +571,397 @@ int main_multi_threaded(
 	*/
 
 
-	// note: the stride is the outer loop for the benefit of the output file,
-	// non-strided aggregation methods will still run only once.
-    bool first_run = true;
-	const int min_stride_pow = 1;
-	for (int stride_pow = min_stride_pow; stride_pow <= max_stride; stride_pow++) {
-		uint64_t stride_size = pow(2, stride_pow);
+	// note: the core count is the outer loop, so the data only has to be
+	// (re)placed once per core count and each core count's file is written
+	// line by line (one line per stride).
+	// non-strided aggregation methods will still run only once per core count
+	// (at the first stride).
+	for ( size_t core_cnt : options.core_counts ) {
+		place_partitions(pool, options, core_cnt, array, number_of_values);
+		place_partitions(pool, options, core_cnt, scatter_array, number_of_values);
 
-		for (int a = 0; a < aggregators.size(); a++) {
-			const aggregation_function_t<ResultT>& function = aggregators[a].function;
-			const string& label = aggregators[a].label;
-			const bool& strided = aggregators[a].strided;
+		for (size_t s = 0; s < options.strides.size(); s++) {
+			uint64_t stride_size = options.strides[s];
+			// the kernels measured at this stride, for the samples
+			vector<struct measures> measured;
+			vector<string> measured_labels;
 
-			multithreaded_measures& measurement = measurements[a];
+			for (int a = 0; a < aggregators.size(); a++) {
+				const aggregation_function_t<ResultT>& function = aggregators[a].function;
+				const scatter_function_t<ResultT>& scatter = aggregators[a].scatter;
+				const string& label = aggregators[a].label;
+				const bool& strided = aggregators[a].strided;
 
-			if (!strided) {
-				if (stride_pow == 1) {
-					if (benchmark(&measurement, correct, array, number_of_values, 0, GB, function)) {
-						cout << label << " done" << endl;
+				multithreaded_measures& measurement = measurements[a];
+
+				if (!strided && s != 0) {
+					/* already measured, non-strided functions only run once */
+				} else {
+					const uint32_t stride = strided ? stride_size : 0;
+					// only whole blocks of the stride are processed by each worker,
+					// except by the kernels that handle any number of values
+					const partitioning parts = aggregators[a].any_count
+						? partition_all_values(number_of_values, core_cnt)
+						: partition_values(number_of_values, core_cnt, stride);
+					bool success;
+					if (parts.processed() == 0) {
+						measurement[core_cnt] = skipped_measures();
+					} else if (scatter) {
+						success = benchmark_scatter(pool, options, parts, &measurement, scatter_array, number_of_values, stride, scatter, background);
 					} else {
-						cout << label << " failed" << endl;
+						const uint64_t expected = expected_sum(array, number_of_values, correct, parts, aggregators[a].wide);
+						success = measure_prefetch_distances(aggregators[a].prefetching, options.prefetch_distances, &measurement[core_cnt],
+							[&] (measures* res) {
+								multithreaded_measures by_core_count;
+								const bool matches = benchmark(pool, options, parts, &by_core_count, expected, array, stride, function, aggregators[a].wide, background);
+								*res = by_core_count[core_cnt];
+								return matches;
+							});
 					}
+					if (parts.processed() == 0) {
+						cout << label << " skipped, stride " << stride << " does not fit into the data (" << core_cnt << " cores)" << endl;
+					} else if (success && aggregators[a].prefetching) {
+						cout << label << " done (" << core_cnt << " cores), prefetch distance " << measurement[core_cnt].prefetch_distance << background_note(measurement[core_cnt]) << outlier_note(measurement[core_cnt]) << endl;
+					} else if (success) {
+						cout << label << " done (" << core_cnt << " cores)" << background_note(measurement[core_cnt]) << outlier_note(measurement[core_cnt]) << endl;
+					} else {
+						cout << label << " failed (" << core_cnt << " cores)" << endl;
+					}
+					if (parts.processed() != 0) {
+						record_point(under_background(strided_point(multi_threaded, avx512, bits64, label, core_cnt, stride), background), options, data.pages, measurement[core_cnt], success);
+					}
+					measured.push_back(measurement[core_cnt]);
+					measured_labels.push_back(label);
 				}
+
+			}
+
+			/* Write all to one file per core count */
+			log_multithreaded_results_per_file(
+				result_filename_base,
+				stride_size,
+				measurements,
+				core_cnt,
+				s == 0,
+				header
+			);
+			log_multithreaded_counters_per_file(
+				result_filename_base,
+				stride_size,
+				measurements,
+				labels,
+				core_cnt,
+				s == 0,
+				header
+			);
+			vector<measures> core_count_measurements;
+			for (multithreaded_measures& measurement : measurements) core_count_measurements.push_back(measurement[core_cnt]);
+			log_prefetch_distances(
+				result_filename_base + "_" + to_string(core_cnt) + "_cores_prefetch.dat",
+				"stride stride*8",
+				to_string(stride_size) + " " + to_string(stride_size * 8),
+				core_count_measurements,
+				labels,
+				prefetching,
+				s == 0,
+				header
+			);
+			log_statistics(
+				result_filename_base + "_" + to_string(core_cnt) + "_cores_statistics.dat",
+				"stride stride*8",
+				to_string(stride_size) + " " + to_string(stride_size * 8),
+				core_count_measurements,
+				labels,
+				s == 0,
+				header
+			);
+			log_imbalance(
+				result_filename_base + "_" + to_string(core_cnt) + "_cores_imbalance.dat",
+				"stride stride*8",
+				to_string(stride_size) + " " + to_string(stride_size * 8),
+				core_count_measurements,
+				labels,
+				s == 0,
+				header
+			);
+			if (!background.label.empty()) log_background(
+				result_filename_base + "_" + to_string(core_cnt) + "_cores_background.dat",
+				"stride stride*8",
+				to_string(stride_size) + " " + to_string(stride_size * 8),
+				core_count_measurements,
+				labels,
+				s == 0,
+				header
+			);
+			log_samples(
+				result_filename_base + "_" + to_string(core_cnt) + "_cores_samples.dat",
+				"stride stride*8",
+				to_string(stride_size) + " " + to_string(stride_size * 8),
+				measured,
+				measured_labels,
+				s == 0,
+				header
+			);
+		}
+	}
+	for (int a = 0; a < aggregators.size(); a++) {
+	    print_multithreaded_results( cout, aggregators[a].label, measurements[a] );
+	}
+
+	return SUCCESS;
+}
+
+/** runs the lookup kernels (all of one instruction set) on the workers of
+ * the pool over data at the positions in indices for every core count in
+ * options and appends their row to
+ * ./data/gather/<label>_<core count>_cores_lookups.dat, _counters.dat,
+ * _statistics.dat, _samples.dat, _imbalance.dat and _prefetch.dat,
+ * clean starts these files over.
+ */
+template <class ResultT>
+int run_multi_threaded_lookups(
+	thread_pool& pool,
+	const vector<lookup_kernel<ResultT>>& lookups,
+	const benchmark_data<ResultT>& data,
+	const lookup_indices& indices,
+	bool avx512,
+	bool bits64,
+	const run_options& options,
+	bool clean
+) {
+	const bool multi_threaded = true;
+	const string distribution = index_distribution_name(indices.distribution);
+	const string header = options_header(options) + data_header(data) + lookup_header(options, indices);
+	const string base = "./data/gather/" + make_label(options.data_size_log2, multi_threaded, avx512, bits64);
+
+	for ( size_t core_cnt : options.core_counts ) {
+		// the index is read in parts, the values by everyone
+		place_partitions(pool, options, core_cnt, indices.index64, indices.number);
+		place_partitions(pool, options, core_cnt, indices.index32, indices.number);
+		const partitioning parts = partition_values(indices.number, core_cnt, 0);
+
+		vector<struct measures> measurements;
+		vector<string> labels;
+		vector<bool> prefetching;
+		for (const lookup_kernel<ResultT>& lookup : lookups) {
+			measures measurement = skipped_measures();
+			if (parts.count == 0) {
+				cout << lookup.label << " skipped, too few lookups (" << core_cnt << " cores)" << endl;
+			} else if (lookup.index32 && indices.index32 == NULL) {
+				cout << lookup.label << " skipped, 32 bit offsets cannot address all values" << endl;
 			} else {
-				if (benchmark(&measurement, correct, array, number_of_values, stride_size, GB, function)) {
-					cout << label << " done" << endl;
+				const bool success = measure_prefetch_distances(lookup.prefetching, options.prefetch_distances, &measurement,
+					[&] (measures* res) {
+						return lookup.index32
+							? benchmark_lookup(pool, options, parts, res, data.array, data.number_of_values, indices.index32, lookup.index32)
+							: benchmark_lookup(pool, options, parts, res, data.array, data.number_of_values, indices.index64, lookup.index64);
+					});
+				if (success && lookup.prefetching) {
+					cout << lookup.label << " done (" << distribution << ", " << core_cnt << " cores), prefetch distance " << measurement.prefetch_distance << outlier_note(measurement) << endl;
+				} else if (success) {
+					cout << lookup.label << " done (" << distribution << ", " << core_cnt << " cores)" << outlier_note(measurement) << endl;
 				} else {
-					cout << label << " failed" << endl;
+					cout << lookup.label << " failed (" << distribution << ", " << core_cnt << " cores)" << endl;
 				}
+				record_point(lookup_point(multi_threaded, avx512, bits64, lookup.label, core_cnt, distribution, parts.processed()), options, data.pages, measurement, success);
 			}
-
+			measurements.push_back(measurement);
+			labels.push_back(lookup.label);
+			prefetching.push_back(lookup.prefetching);
 		}
 
-		/* Write all to one file */
-		log_multithreaded_results_per_file(
-			result_filename_base,
-			stride_pow,
-			measurements,
-			first_run
-		);
+		const string filename = base + "_" + to_string(core_cnt) + "_cores_lookups";
+		log_lookup_results(filename + ".dat", distribution, measurements, labels, clean, header);
+		log_lookup_counters(filename + "_counters.dat", distribution, measurements, labels, clean, header);
+		log_prefetch_distances(filename + "_prefetch.dat", "distribution", distribution, measurements, labels, prefetching, clean, header);
+		log_statistics(filename + "_statistics.dat", "distribution", distribution, measurements, labels, clean, header);
+		log_samples(filename + "_samples.dat", "distribution", distribution, measurements, labels, clean, header);
+		log_imbalance(filename + "_imbalance.dat", "distribution", distribution, measurements, labels, clean, header);
+	}
+	return SUCCESS;
+}
 
-		if (first_run) {
-			first_run = false;
-		}
+/** runs the group-by kernels (all of one instruction set) on the workers of
+ * the pool over data with the keys (of one bucket count and distribution)
+ * for every core count in options and appends their row to
+ * ./data/gather/<label>_<core count>_cores_groupby.dat, _counters.dat,
+ * _statistics.dat, _samples.dat and _imbalance.dat, clean starts these files over.
+ * the private tables of the kernels that are not shared are skipped if
+ * they would be larger than the rows.
+ */
+template <class ResultT>
+int run_multi_threaded_groupbys(
+	thread_pool& pool,
+	const vector<groupby_kernel<ResultT>>& groupbys,
+	const benchmark_data<ResultT>& data,
+	const groupby_keys<ResultT>& keys,
+	bool avx512,
+	bool bits64,
+	const run_options& options,
+	bool clean
+) {
+	const bool multi_threaded = true;
+	const string distribution = index_distribution_name(keys.distribution);
+	const string header = options_header(options) + data_header(data) + groupby_header(options, keys);
+	const string base = "./data/gather/" + make_label(options.data_size_log2, multi_threaded, avx512, bits64);
+	const string row = to_string(keys.bucket_count) + " " + distribution;
+
+	ResultT* buckets = allocate<ResultT>(keys.bucket_count, options.data_placement);
+	if (buckets == NULL) {
+		cout << "Memory for the buckets not allocated" << endl;
+		return NO_MEMORY;
 	}
-	for (int a = 0; a < aggregators.size(); a++) {
-	    print_multithreaded_results( cout, aggregators[a].label, measurements[a] );
+	for ( size_t core_cnt : options.core_counts ) {
+		// the rows are read in parts, every worker adds into all buckets
+		place_partitions(pool, options, core_cnt, keys.keys, keys.number);
+		const partitioning parts = partition_all_values(keys.number, core_cnt);
+		const bool with_private = core_cnt * keys.bucket_count <= keys.number;
+		ResultT* private_buckets = with_private ? allocate<ResultT>(core_cnt * keys.bucket_count, options.data_placement) : NULL;
+		if (with_private && private_buckets == NULL) {
+			cout << "Memory for the private buckets not allocated" << endl;
+			deallocate(buckets, keys.bucket_count);
+			return NO_MEMORY;
+		}
+
+		vector<struct measures> measurements;
+		vector<string> labels;
+		for (const groupby_kernel<ResultT>& groupby : groupbys) {
+			measures measurement = skipped_measures();
+			if (!groupby.shared && !with_private) {
+				cout << groupby.label << " skipped, " << core_cnt << " private tables of " << keys.bucket_count << " buckets are more than the rows" << endl;
+			} else {
+				const bool success = benchmark_groupby(pool, options, parts, &measurement, data.array, keys.keys, buckets, private_buckets, keys.bucket_count,
+					groupby.histogram ? keys.counts : keys.sums, groupby.histogram ? keys.number : data.correct, groupby);
+				if (success) {
+					cout << groupby.label << " done (" << keys.bucket_count << " buckets, " << distribution << ", " << core_cnt << " cores)" << outlier_note(measurement) << endl;
+				} else {
+					cout << groupby.label << " failed (" << keys.bucket_count << " buckets, " << distribution << ", " << core_cnt << " cores)" << endl;
+				}
+				record_point(groupby_point(multi_threaded, avx512, bits64, groupby.label, core_cnt, distribution, keys.number, keys.bucket_count), options, data.pages, measurement, success);
+			}
+			measurements.push_back(measurement);
+			labels.push_back(groupby.label);
+		}
+		if (private_buckets != NULL) deallocate(private_buckets, core_cnt * keys.bucket_count);
+
+		const string filename = base + "_" + to_string(core_cnt) + "_cores_groupby";
+		log_groupby_results(filename + ".dat", keys.bucket_count, distribution, measurements, labels, clean, header);
+		log_groupby_counters(filename + "_counters.dat", keys.bucket_count, distribution, measurements, labels, clean, header);
+		log_statistics(filename + "_statistics.dat", "buckets distribution", row, measurements, labels, clean, header);
+		log_samples(filename + "_samples.dat", "buckets distribution", row, measurements, labels, clean, header);
+		log_imbalance(filename + "_imbalance.dat", "buckets distribution", row, measurements, labels, clean, header);
 	}
+	deallocate(buckets, keys.bucket_count);
+	return SUCCESS;
+}
 
-	cerr << "freeing array!" << endl;
-    free(array);
+/** runs the probe kernels (all of one instruction set) on the workers of the
+ * pool with the keys (of one hit rate) on the table for every core count in
+ * options and appends their row to
+ * ./data/gather/<label>_<core count>_cores_probe.dat, _counters.dat,
+ * _statistics.dat, _samples.dat and _imbalance.dat, clean starts these files over.
+ * the bucketised kernels are skipped on tables in the linear layout.
+ */
+template <class ResultT>
+int run_multi_threaded_probes(
+	thread_pool& pool,
+	const vector<probe_kernel<ResultT>>& probes,
+	const benchmark_data<ResultT>& data,
+	const hash_table<ResultT>& table,
+	const probe_keys<ResultT>& keys,
+	bool avx512,
+	bool bits64,
+	const run_options& options,
+	bool clean
+) {
+	const bool multi_threaded = true;
+	const string layout = table_layout_name(table.layout);
+	const string header = options_header(options) + data_header(data) + probe_header(options, keys);
+	const string base = "./data/gather/" + make_label(options.data_size_log2, multi_threaded, avx512, bits64);
+	const string row = probe_row(table, keys);
+
+	for ( size_t core_cnt : options.core_counts ) {
+		// the keys are read in parts, every worker reads all of the table
+		place_partitions(pool, options, core_cnt, keys.keys, keys.number);
+		const partitioning parts = partition_all_values(keys.number, core_cnt);
+
+		vector<struct measures> measurements;
+		vector<string> labels;
+		for (const probe_kernel<ResultT>& probe : probes) {
+			measures measurement = skipped_measures();
+			if (probe.bucketised && table.layout != LAYOUT_BUCKETS) {
+				cout << probe.label << " skipped, the " << layout << " table has no buckets" << endl;
+			} else {
+				const bool success = benchmark_probe(pool, options, parts, &measurement, table, keys.keys, keys.expected, probe.function);
+				if (success) {
+					cout << probe.label << " done (" << table.slots() << " slots, " << layout << ", hit rate " << keys.hit_rate << ", " << core_cnt << " cores)" << outlier_note(measurement) << endl;
+				} else {
+					cout << probe.label << " failed (" << table.slots() << " slots, " << layout << ", hit rate " << keys.hit_rate << ", " << core_cnt << " cores)" << endl;
+				}
+				record_point(probe_point(multi_threaded, avx512, bits64, probe.label, core_cnt, layout, table.slots(), keys.hit_rate, keys.number), options, data.pages, measurement, success);
+			}
+			measurements.push_back(measurement);
+			labels.push_back(probe.label);
+		}
 
+		const string filename = base + "_" + to_string(core_cnt) + "_cores_probe";
+		log_probe_results(filename + ".dat", row, measurements, labels, clean, header);
+		log_probe_counters(filename + "_counters.dat", row, measurements, labels, clean, header);
+		log_statistics(filename + "_statistics.dat", "slots layout hit_rate", row, measurements, labels, clean, header);
+		log_samples(filename + "_samples.dat", "slots layout hit_rate", row, measurements, labels, clean, header);
+		log_imbalance(filename + "_imbalance.dat", "slots layout hit_rate", row, measurements, labels, clean, header);
+	}
 	return SUCCESS;
 }
 
+/** runs the pointer chases (all of one instruction set) on the workers of
+ * the pool through the cycle (of one working set, placed as options say)
+ * for every core count in options and appends their row to
+ * ./data/gather/<label>_<core count>_cores_latency.dat, _counters.dat,
+ * _statistics.dat, _samples.dat and _imbalance.dat (and _background.dat),
+ * under background like run_multi_threaded, clean starts these files over.
+ */
+template <class ResultT>
+int run_multi_threaded_chases(
+	thread_pool& pool,
+	const vector<chase_kernel<ResultT>>& chases,
+	const chase_cycle<ResultT>& cycle,
+	bool avx512,
+	bool bits64,
+	const run_options& options,
+	bool clean,
+	const background_load& background = background_load()
+) {
+	const bool multi_threaded = true;
+	const string header = options_header(options) + latency_header(options) + background_header(background);
+	const string base = "./data/gather/" + make_label(options.data_size_log2, multi_threaded, avx512, bits64) + background_suffix(background);
+	const string row = latency_row(cycle, options.data_placement);
+
+	for ( size_t core_cnt : options.core_counts ) {
+		vector<struct measures> measurements;
+		vector<string> labels;
+		for (const chase_kernel<ResultT>& chase : chases) {
+			measures measurement = skipped_measures();
+			const vector<ResultT> starts = chase_starts(cycle, core_cnt * chase.lanes);
+			const bool success = benchmark_chase(pool, options, core_cnt, &measurement, cycle, starts.data(), chase.lanes,
+				chase_expected(cycle, 0, core_cnt * chase.lanes, core_cnt * chase.lanes, options.hops), chase.function, background);
+			if (success) {
+				cout << chase.label << " done (" << cycle.bytes << " bytes, " << core_cnt << " cores, " << ns_per_hop(measurement, options.hops) << " ns per hop)" << background_note(measurement) << outlier_note(measurement) << endl;
+			} else {
+				cout << chase.label << " failed (" << cycle.bytes << " bytes, " << core_cnt << " cores)" << endl;
+			}
+			record_point(under_background(chase_point(multi_threaded, avx512, bits64, chase.label, core_cnt, cycle.bytes, options.hops), background), options, cycle.pages, measurement, success);
+			measurements.push_back(measurement);
+			labels.push_back(chase.label);
+		}
+
+		const string filename = base + "_" + to_string(core_cnt) + "_cores_latency";
+		log_latency_results(filename + ".dat", row, options.hops, measurements, labels, clean, header);
+		log_latency_counters(filename + "_counters.dat", row, measurements, labels, clean, header);
+		log_statistics(filename + "_statistics.dat", "working_set placement", row, measurements, labels, clean, header);
+		log_samples(filename + "_samples.dat", "working_set placement", row, measurements, labels, clean, header);
+		log_imbalance(filename + "_imbalance.dat", "working_set placement", row, measurements, labels, clean, header);
+		if (!background.label.empty()) log_background(filename + "_background.dat", "working_set placement", row, measurements, labels, clean, header);
+	}
+	return SUCCESS;
+}
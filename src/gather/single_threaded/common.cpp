@@ -3,16 +3,14 @@
 #include<iostream>
 #include<random>
 #include<chrono>
-#include "immintrin.h"
 #include<fstream>
 #include <string.h>
 #include <math.h>
 #include <functional>
 
-#include "gather/simd_variants/avx/agg_avx_64BitVariants.h"
 #include "error_codes.h"
 
-// ITERATIONS and MAX_CORES
+// ITERATIONS and MAX_CORES (defaults of the options)
 #include "parameters.h"
 
 using namespace std;
@@ -21,58 +19,37 @@ using namespace std;
 #include "aggregation_type.h"
 #include "measures.h"
 #include "make_label.cpp"
-
-#include "generate_random_values.cpp"
+#include "options.cpp"
+#include "benchmark_data.cpp"
+#include "log_lookup_results.cpp"
+#include "log_groupby_results.cpp"
+#include "log_probe_results.cpp"
+#include "log_latency_results.cpp"
+#include "prefetch_tuning.cpp"
+#include "log_statistics.cpp"
+#include "baseline_comparison.cpp"
 // template <ResultT> bool benchmark(...)
 #include "benchmark_single_threaded.cpp"
 
+/** runs the aggregators (all of one instruction set) single threaded
+ * over data for every stride in options and writes the results to
+ * ./data/gather/<label>_results.dat and _counters.dat, the statistics of
+ * the execution durations to _statistics.dat and the durations themselves
+ * to _samples.dat (and the prefetch distances to _prefetch.dat).
+ */
 template <class ResultT>
-int main_single_threaded(
-	const vector<aggregator_t<ResultT>> aggregators,
-	uint64_t data_size_log2,
-	bool multi_threaded,
+int run_single_threaded(
+	const vector<aggregator_t<ResultT>>& aggregators,
+	const benchmark_data<ResultT>& data,
 	bool avx512,
-	bool bits64
+	bool bits64,
+	const run_options& options
 ) {
-    // define number of values
-    // 27 --> 134 million integers --> 8GB
-    // 26 --> 67 million integers --> 4GB
-    uint64_t number_of_values = pow(2, data_size_log2);
-	cerr << "number_of_values: " << number_of_values << endl;
-
-
-    // define max stride size (power of 2)
-    size_t max_stride = 15;
-	cerr << "max_stride: " << max_stride << ", 2**max_stride: " << (1 << max_stride) << endl;
-
-	if (max_stride + 1 < data_size_log2) {
-		/* this stride is fine */
-	} else {
-		cerr
-			<< "Data Size is 2**" << data_size_log2 << " == " << (1<<data_size_log2)
-			<< " which does not allow the hardcoded maximum stride of "
-			<< "2**" << max_stride << " == " << (1<<max_stride) << "!"
-		<< endl;
-		return DATA_SIZE_TOO_LOW;
-	}
-
-    //compute GB for number of values
-    double GB = (((double)number_of_values*sizeof(ResultT)/(double)1024)/(double)1024)/(double)1024;
-
-
-    /**
-     * allocate memory and fill with random numbers
-     */
-    ResultT* array = allocate<ResultT>(number_of_values);
-    if (array != NULL) {
-        cout << "Memory allocated - " << number_of_values << " values" << endl;
-    } else {
-        cout << "Memory not allocated" << endl;
-		exit(NO_MEMORY);
-    }
-    generate_random_values(array, number_of_values);
-    uint64_t correct = aggregate_scalar(array, number_of_values);
-    cout <<"Generation done."<<endl;
+	const bool multi_threaded = false;
+	const uint64_t number_of_values = data.number_of_values;
+	ResultT* array = data.array;
+	ResultT* scatter_array = data.scatter_array;
+	const uint64_t correct = data.correct;
 
     /**
      * run several benchmarks on generated data
@@ -83,7 +60,7 @@ int main_single_threaded(
 	measurements.assign(aggregators.size(), {0, 0, 0, 0});
 
     // open files to store runtime measurements
-	string label = make_label(data_size_log2, multi_threaded, avx512, bits64);
+	string label = make_label(options.data_size_log2, multi_threaded, avx512, bits64);
 	string result_filename = "./data/gather/" + label + "_results.dat";
 	ofstream result_file;
 	result_file.open(result_filename);
@@ -94,58 +71,329 @@ int main_single_threaded(
 		cerr << "writing data to '" << result_filename << "' failed!" << endl;
 		return RESULT_FILE_NOT_OPENED;
 	}
+	cout << options_header(options) << data_header(data);
+	result_file << options_header(options) << data_header(data);
+
+	string counters_filename = "./data/gather/" + label + "_counters.dat";
+	ofstream counters_file;
+	counters_file.open(counters_filename);
+	counters_file << options_header(options) << data_header(data) << "# columns: stride stride*8";
+	for (const aggregator_t<ResultT>& aggregator : aggregators) {
+		counters_file << " " << perf_counter_columns(aggregator.label);
+	}
+	counters_file << endl;
+
+	vector<string> labels;
+	vector<bool> prefetching;
+	for (const aggregator_t<ResultT>& aggregator : aggregators) {
+		labels.push_back(aggregator.label);
+		prefetching.push_back(aggregator.prefetching);
+	}
+	const string prefetch_filename = "./data/gather/" + label + "_prefetch.dat";
+	const string statistics_filename = "./data/gather/" + label + "_statistics.dat";
+	const string samples_filename = "./data/gather/" + label + "_samples.dat";
 
 
 	// note: the stride is the outer loop for the benefit of the output file,
-	// non-strided aggregation methods will still run only once.
-    bool first_run = true;
-	const int min_stride_pow = 1;
-	for (int stride_pow = min_stride_pow; stride_pow <= max_stride; stride_pow++) {
-		uint64_t stride_size = pow(2, stride_pow);
+	// non-strided aggregation methods will still run only once (at the first stride).
+	for (size_t s = 0; s < options.strides.size(); s++) {
+		uint64_t stride_size = options.strides[s];
+
+		// the kernels measured at this stride, for the samples
+		vector<struct measures> measured;
+		vector<string> measured_labels;
 
 		result_file
 			<< stride_size << " "
 			<< stride_size * 8;
+		counters_file
+			<< stride_size << " "
+			<< stride_size * 8;
 
 		for (int a = 0; a < aggregators.size(); a++) {
 			const aggregation_function_t<ResultT>& function = aggregators[a].function;
+			const scatter_function_t<ResultT>& scatter = aggregators[a].scatter;
 			const string& label = aggregators[a].label;
 			const bool& strided = aggregators[a].strided;
 
 			measures& measurement = measurements[a];
 
-			if (!strided) {
-				if (stride_pow == 1) {
-					if (benchmark(&measurement, correct, array, number_of_values, 0, GB, function)) {
-						cout << label << " done" << endl;
-					} else {
-						cout << label << " failed" << endl;
-					}
-				}
+			if (!strided && s != 0) {
+				/* already measured, non-strided functions only run once */
 			} else {
-				if (benchmark(&measurement, correct, array, number_of_values, stride_size, GB, function)) {
-					cout << label << " done" << endl;
+				const uint32_t stride = strided ? stride_size : 0;
+				// only whole blocks of the stride are processed,
+				// except by the kernels that handle any number of values
+				const partitioning parts = aggregators[a].any_count
+					? partition_all_values(number_of_values, 1)
+					: partition_values(number_of_values, 1, stride);
+				bool success;
+				if (parts.processed() == 0) {
+					measurement = skipped_measures();
+				} else if (scatter) {
+					success = benchmark_scatter(options, &measurement, scatter_array, parts.count, stride, scatter);
+				} else {
+					const uint64_t expected = expected_sum(array, number_of_values, correct, parts, aggregators[a].wide);
+					success = measure_prefetch_distances(aggregators[a].prefetching, options.prefetch_distances, &measurement,
+						[&] (measures* res) { return benchmark(options, res, expected, array, parts.count, stride, function, aggregators[a].wide); });
+				}
+				if (parts.processed() == 0) {
+					cout << label << " skipped, stride " << stride << " does not fit into the data" << endl;
+				} else if (success && aggregators[a].prefetching) {
+					cout << label << " done, prefetch distance " << measurement.prefetch_distance << outlier_note(measurement) << endl;
+				} else if (success) {
+					cout << label << " done" << outlier_note(measurement) << endl;
 				} else {
 					cout << label << " failed" << endl;
 				}
+				if (parts.processed() != 0) {
+					record_point(strided_point(multi_threaded, avx512, bits64, label, 1, stride), options, data.pages, measurement, success);
+				}
+				measured.push_back(measurement);
+				measured_labels.push_back(label);
 			}
 
 			result_file
 				<< " " << measurement.mis
 				<< " " << measurement.throughput;
+			print_perf_counts(counters_file, measurement.counters);
 		}
 
 		result_file << endl;
+		counters_file << endl;
+		log_prefetch_distances(
+			prefetch_filename,
+			"stride stride*8",
+			to_string(stride_size) + " " + to_string(stride_size * 8),
+			measurements,
+			labels,
+			prefetching,
+			s == 0,
+			options_header(options) + data_header(data)
+		);
+		log_statistics(
+			statistics_filename,
+			"stride stride*8",
+			to_string(stride_size) + " " + to_string(stride_size * 8),
+			measurements,
+			labels,
+			s == 0,
+			options_header(options) + data_header(data)
+		);
+		log_samples(
+			samples_filename,
+			"stride stride*8",
+			to_string(stride_size) + " " + to_string(stride_size * 8),
+			measured,
+			measured_labels,
+			s == 0,
+			options_header(options) + data_header(data)
+		);
+	}
+    result_file.close();
+    counters_file.close();
+
+	return SUCCESS;
+}
 
-		if (first_run) {
-			first_run = false;
+/** runs the lookup kernels (all of one instruction set) single threaded
+ * over data at the positions in indices and appends their row to
+ * ./data/gather/<label>_lookups.dat, _lookups_counters.dat, _lookups_statistics.dat,
+ * _lookups_samples.dat and _lookups_prefetch.dat, clean starts these files over.
+ */
+template <class ResultT>
+int run_single_threaded_lookups(
+	const vector<lookup_kernel<ResultT>>& lookups,
+	const benchmark_data<ResultT>& data,
+	const lookup_indices& indices,
+	bool avx512,
+	bool bits64,
+	const run_options& options,
+	bool clean
+) {
+	const bool multi_threaded = false;
+	// the kernels process whole vectors
+	const partitioning parts = partition_values(indices.number, 1, 0);
+
+	vector<struct measures> measurements;
+	vector<string> labels;
+	vector<bool> prefetching;
+	for (const lookup_kernel<ResultT>& lookup : lookups) {
+		const string distribution = index_distribution_name(indices.distribution);
+		measures measurement = skipped_measures();
+		if (parts.count == 0) {
+			cout << lookup.label << " skipped, too few lookups" << endl;
+		} else if (lookup.index32 && indices.index32 == NULL) {
+			cout << lookup.label << " skipped, 32 bit offsets cannot address all values" << endl;
+		} else {
+			const bool success = measure_prefetch_distances(lookup.prefetching, options.prefetch_distances, &measurement,
+				[&] (measures* res) {
+					return lookup.index32
+						? benchmark_lookup(options, res, data.array, data.number_of_values, indices.index32, parts.count, lookup.index32)
+						: benchmark_lookup(options, res, data.array, data.number_of_values, indices.index64, parts.count, lookup.index64);
+				});
+			if (success && lookup.prefetching) {
+				cout << lookup.label << " done (" << distribution << "), prefetch distance " << measurement.prefetch_distance << outlier_note(measurement) << endl;
+			} else if (success) {
+				cout << lookup.label << " done (" << distribution << ")" << outlier_note(measurement) << endl;
+			} else {
+				cout << lookup.label << " failed (" << distribution << ")" << endl;
+			}
+			record_point(lookup_point(multi_threaded, avx512, bits64, lookup.label, 1, distribution, parts.count), options, data.pages, measurement, success);
 		}
+		measurements.push_back(measurement);
+		labels.push_back(lookup.label);
+		prefetching.push_back(lookup.prefetching);
 	}
-    result_file.close();
 
-	cerr << "freeing array!" << endl;
-    free(array);
+	const string header = options_header(options) + data_header(data) + lookup_header(options, indices);
+	const string base = "./data/gather/" + make_label(options.data_size_log2, multi_threaded, avx512, bits64) + "_lookups";
+	log_lookup_results(base + ".dat", index_distribution_name(indices.distribution), measurements, labels, clean, header);
+	log_lookup_counters(base + "_counters.dat", index_distribution_name(indices.distribution), measurements, labels, clean, header);
+	log_prefetch_distances(base + "_prefetch.dat", "distribution", index_distribution_name(indices.distribution), measurements, labels, prefetching, clean, header);
+	log_statistics(base + "_statistics.dat", "distribution", index_distribution_name(indices.distribution), measurements, labels, clean, header);
+	log_samples(base + "_samples.dat", "distribution", index_distribution_name(indices.distribution), measurements, labels, clean, header);
+	return SUCCESS;
+}
+
+/** runs the group-by kernels (all of one instruction set) single threaded
+ * over data with the keys (of one bucket count and distribution) and appends
+ * their row to ./data/gather/<label>_groupby.dat, _groupby_counters.dat,
+ * _groupby_statistics.dat and _groupby_samples.dat, clean starts these files over.
+ */
+template <class ResultT>
+int run_single_threaded_groupbys(
+	const vector<groupby_kernel<ResultT>>& groupbys,
+	const benchmark_data<ResultT>& data,
+	const groupby_keys<ResultT>& keys,
+	bool avx512,
+	bool bits64,
+	const run_options& options,
+	bool clean
+) {
+	const bool multi_threaded = false;
+	const string distribution = index_distribution_name(keys.distribution);
+	ResultT* buckets = allocate<ResultT>(keys.bucket_count, options.data_placement);
+	if (buckets == NULL) {
+		cout << "Memory for the buckets not allocated" << endl;
+		return NO_MEMORY;
+	}
+
+	vector<struct measures> measurements;
+	vector<string> labels;
+	for (const groupby_kernel<ResultT>& groupby : groupbys) {
+		measures measurement = skipped_measures();
+		const bool success = benchmark_groupby(options, &measurement, data.array, keys.keys, keys.number, buckets, keys.bucket_count,
+			groupby.histogram ? keys.counts : keys.sums, groupby.histogram ? keys.number : data.correct, groupby.histogram, groupby.function);
+		if (success) {
+			cout << groupby.label << " done (" << keys.bucket_count << " buckets, " << distribution << ")" << outlier_note(measurement) << endl;
+		} else {
+			cout << groupby.label << " failed (" << keys.bucket_count << " buckets, " << distribution << ")" << endl;
+		}
+		record_point(groupby_point(multi_threaded, avx512, bits64, groupby.label, 1, distribution, keys.number, keys.bucket_count), options, data.pages, measurement, success);
+		measurements.push_back(measurement);
+		labels.push_back(groupby.label);
+	}
+	deallocate(buckets, keys.bucket_count);
+
+	const string header = options_header(options) + data_header(data) + groupby_header(options, keys);
+	const string base = "./data/gather/" + make_label(options.data_size_log2, multi_threaded, avx512, bits64) + "_groupby";
+	const string row = to_string(keys.bucket_count) + " " + distribution;
+	log_groupby_results(base + ".dat", keys.bucket_count, distribution, measurements, labels, clean, header);
+	log_groupby_counters(base + "_counters.dat", keys.bucket_count, distribution, measurements, labels, clean, header);
+	log_statistics(base + "_statistics.dat", "buckets distribution", row, measurements, labels, clean, header);
+	log_samples(base + "_samples.dat", "buckets distribution", row, measurements, labels, clean, header);
+	return SUCCESS;
+}
+
+/** runs the probe kernels (all of one instruction set) single threaded with
+ * the keys (of one hit rate) on the table and appends their row to
+ * ./data/gather/<label>_probe.dat, _probe_counters.dat, _probe_statistics.dat
+ * and _probe_samples.dat, clean starts these files over.
+ * the bucketised kernels are skipped on tables in the linear layout.
+ */
+template <class ResultT>
+int run_single_threaded_probes(
+	const vector<probe_kernel<ResultT>>& probes,
+	const benchmark_data<ResultT>& data,
+	const hash_table<ResultT>& table,
+	const probe_keys<ResultT>& keys,
+	bool avx512,
+	bool bits64,
+	const run_options& options,
+	bool clean
+) {
+	const bool multi_threaded = false;
+	const string layout = table_layout_name(table.layout);
+	const string row = probe_row(table, keys);
 
+	vector<struct measures> measurements;
+	vector<string> labels;
+	for (const probe_kernel<ResultT>& probe : probes) {
+		measures measurement = skipped_measures();
+		if (probe.bucketised && table.layout != LAYOUT_BUCKETS) {
+			cout << probe.label << " skipped, the " << layout << " table has no buckets" << endl;
+		} else {
+			const bool success = benchmark_probe(options, &measurement, table, keys.keys, keys.number, keys.expected, probe.function);
+			if (success) {
+				cout << probe.label << " done (" << table.slots() << " slots, " << layout << ", hit rate " << keys.hit_rate << ")" << outlier_note(measurement) << endl;
+			} else {
+				cout << probe.label << " failed (" << table.slots() << " slots, " << layout << ", hit rate " << keys.hit_rate << ")" << endl;
+			}
+			record_point(probe_point(multi_threaded, avx512, bits64, probe.label, 1, layout, table.slots(), keys.hit_rate, keys.number), options, data.pages, measurement, success);
+		}
+		measurements.push_back(measurement);
+		labels.push_back(probe.label);
+	}
+
+	const string header = options_header(options) + data_header(data) + probe_header(options, keys);
+	const string base = "./data/gather/" + make_label(options.data_size_log2, multi_threaded, avx512, bits64) + "_probe";
+	log_probe_results(base + ".dat", row, measurements, labels, clean, header);
+	log_probe_counters(base + "_counters.dat", row, measurements, labels, clean, header);
+	log_statistics(base + "_statistics.dat", "slots layout hit_rate", row, measurements, labels, clean, header);
+	log_samples(base + "_samples.dat", "slots layout hit_rate", row, measurements, labels, clean, header);
 	return SUCCESS;
 }
 
+/** runs the pointer chases (all of one instruction set) single threaded
+ * through the cycle (of one working set, placed as options say) and appends
+ * their row to ./data/gather/<label>_latency.dat, _latency_counters.dat,
+ * _latency_statistics.dat and _latency_samples.dat, clean starts these files over.
+ */
+template <class ResultT>
+int run_single_threaded_chases(
+	const vector<chase_kernel<ResultT>>& chases,
+	const chase_cycle<ResultT>& cycle,
+	bool avx512,
+	bool bits64,
+	const run_options& options,
+	bool clean
+) {
+	const bool multi_threaded = false;
+	const string row = latency_row(cycle, options.data_placement);
+
+	vector<struct measures> measurements;
+	vector<string> labels;
+	for (const chase_kernel<ResultT>& chase : chases) {
+		measures measurement = skipped_measures();
+		const vector<ResultT> starts = chase_starts(cycle, chase.lanes);
+		const bool success = benchmark_chase(options, &measurement, cycle, starts.data(), chase.lanes,
+			chase_expected(cycle, 0, chase.lanes, chase.lanes, options.hops), chase.function);
+		if (success) {
+			cout << chase.label << " done (" << cycle.bytes << " bytes, " << ns_per_hop(measurement, options.hops) << " ns per hop)" << outlier_note(measurement) << endl;
+		} else {
+			cout << chase.label << " failed (" << cycle.bytes << " bytes)" << endl;
+		}
+		record_point(chase_point(multi_threaded, avx512, bits64, chase.label, 1, cycle.bytes, options.hops), options, cycle.pages, measurement, success);
+		measurements.push_back(measurement);
+		labels.push_back(chase.label);
+	}
+
+	const string header = options_header(options) + latency_header(options);
+	const string base = "./data/gather/" + make_label(options.data_size_log2, multi_threaded, avx512, bits64) + "_latency";
+	log_latency_results(base + ".dat", row, options.hops, measurements, labels, clean, header);
+	log_latency_counters(base + "_counters.dat", row, measurements, labels, clean, header);
+	log_statistics(base + "_statistics.dat", "working_set placement", row, measurements, labels, clean, header);
+	log_samples(base + "_samples.dat", "working_set placement", row, measurements, labels, clean, header);
+	return SUCCESS;
+}